@@ -0,0 +1,62 @@
+#include "../src/ecs/components.h"
+#include "../src/ecs/registry.h"
+#include "../src/ecs/systems.h"
+#include <benchmark/benchmark.h>
+
+using namespace plaxel;
+
+constexpr int ENTITY_COUNT = 100000;
+
+void populate(Registry &registry) {
+  for (int i = 0; i < ENTITY_COUNT; ++i) {
+    const Entity entity = registry.create();
+    registry.add<Position>(entity);
+    registry.add<Velocity>(entity, {glm::vec3(1.f, 2.f, 3.f)});
+  }
+}
+
+void BM_IntegrateVelocities(benchmark::State &state) {
+  Registry registry;
+  populate(registry);
+  JobSystem jobs(static_cast<unsigned>(state.range(0)));
+
+  for (auto _ : state) {
+    integrateVelocities(registry, jobs, 1.0f / 60);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * ENTITY_COUNT);
+}
+// 0 worker threads runs everything on the calling thread
+BENCHMARK(BM_IntegrateVelocities)->Arg(0)->Arg(1)->Arg(3)->Arg(7)->UseRealTime();
+
+void BM_IntegrateVelocitiesUnaligned(benchmark::State &state) {
+  Registry registry;
+  // Interleave destructions so that the velocity pool ends up in a different order than positions
+  std::vector<Entity> spares;
+  for (int i = 0; i < ENTITY_COUNT; ++i) {
+    const Entity entity = registry.create();
+    registry.add<Velocity>(entity, {glm::vec3(1.f, 2.f, 3.f)});
+    spares.push_back(entity);
+  }
+  for (size_t i = 0; i < spares.size(); i += 2) {
+    registry.remove<Velocity>(spares[i]);
+  }
+  for (const auto &entity : spares) {
+    registry.add<Position>(entity);
+    if (!registry.has<Velocity>(entity)) {
+      registry.add<Velocity>(entity, {glm::vec3(1.f, 2.f, 3.f)});
+    }
+  }
+  JobSystem jobs(0);
+  const bool aligned = state.range(0) != 0;
+  if (aligned) {
+    registry.align<Velocity, Position>();
+  }
+
+  for (auto _ : state) {
+    integrateVelocities(registry, jobs, 1.0f / 60);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * ENTITY_COUNT);
+}
+BENCHMARK(BM_IntegrateVelocitiesUnaligned)->Arg(0)->Arg(1);
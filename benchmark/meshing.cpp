@@ -0,0 +1,52 @@
+#include "../src/world/chunk_mesher.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+using namespace plaxel;
+
+constexpr BlockId STONE = 1;
+constexpr BlockId GRASS = 2;
+// Chunks meshed per iteration, along x and z
+constexpr int HILLS_SIZE_IN_CHUNKS = 4;
+
+/**
+ * Rolling hills of stone covered with grass, mostly flat at the block scale like real terrain
+ */
+void buildHills(World &world) {
+  constexpr int SIZE = HILLS_SIZE_IN_CHUNKS * CHUNK_SIZE;
+  for (int x = 0; x < SIZE; ++x) {
+    for (int z = 0; z < SIZE; ++z) {
+      const auto height = static_cast<int>(
+          8 + 4 * std::sin(static_cast<float>(x) * .1f) * std::cos(static_cast<float>(z) * .13f));
+      for (int y = 0; y < height; ++y) {
+        world.setBlock({x, y, z}, y == height - 1 ? GRASS : STONE);
+      }
+    }
+  }
+}
+
+void BM_MeshChunks(benchmark::State &state) {
+  World world;
+  buildHills(world);
+  const LightEngine lighting(world);
+  const ChunkMesher mesher(world, lighting);
+  const auto mode = static_cast<MeshingMode>(state.range(0));
+
+  size_t triangles = 0;
+  for (auto _ : state) {
+    triangles = 0;
+    for (int x = 0; x < HILLS_SIZE_IN_CHUNKS; ++x) {
+      for (int z = 0; z < HILLS_SIZE_IN_CHUNKS; ++z) {
+        const ChunkMesh mesh = mesher.mesh({x, 0, z}, mode);
+        triangles += mesh.indices.size() / 3;
+        benchmark::DoNotOptimize(mesh.vertices.data());
+      }
+    }
+  }
+  state.counters["triangles"] = static_cast<double>(triangles);
+  state.SetItemsProcessed(state.iterations() * HILLS_SIZE_IN_CHUNKS * HILLS_SIZE_IN_CHUNKS);
+}
+// 0 is the naive mesher and 1 the greedy one
+BENCHMARK(BM_MeshChunks)
+    ->Arg(static_cast<int>(MeshingMode::Naive))
+    ->Arg(static_cast<int>(MeshingMode::Greedy));
@@ -0,0 +1,28 @@
+#version 450
+
+// Pushed by BaseRenderer::pushCamera, mirrors CameraPushConstants
+layout(push_constant) uniform Camera {
+    mat4 viewProjection;
+    // Origin of the mesh in world space
+    vec4 offset;
+    vec4 right;
+    vec4 up;
+} camera;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+// Per instance attributes, a mat4 takes the 4 locations from 2 to 5
+layout(location = 2) in mat4 inTransform;
+layout(location = 6) in uint inSprite;
+
+layout(location = 0) out vec2 fragTexCoord;
+
+// Sprites are tiles of the bound texture, laid out row by row
+const uint ATLAS_COLUMNS = 1;
+const uint ATLAS_ROWS = 1;
+
+void main() {
+    gl_Position = camera.viewProjection * inTransform * vec4(inPosition, 1.0);
+    vec2 tile = vec2(inSprite % ATLAS_COLUMNS, inSprite / ATLAS_COLUMNS);
+    fragTexCoord = (tile + inTexCoord) / vec2(ATLAS_COLUMNS, ATLAS_ROWS);
+}
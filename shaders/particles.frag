@@ -0,0 +1,14 @@
+#version 450
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragCorner;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // Round particles without needing blending
+    if (dot(fragCorner, fragCorner) > 1.0) {
+        discard;
+    }
+    outColor = fragColor;
+}
@@ -0,0 +1,43 @@
+#version 450
+
+// Pushed by BaseRenderer::pushCamera, mirrors CameraPushConstants
+layout(push_constant) uniform Camera {
+    mat4 viewProjection;
+    // Origin of the mesh in world space
+    vec4 offset;
+    vec4 right;
+    vec4 up;
+} camera;
+
+struct Particle {
+    vec4 positionLife;
+    vec4 velocitySize;
+    vec4 color;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Particles {
+    Particle particles[];
+};
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragCorner;
+
+// Two triangles, in the same order as the sprite quad
+const vec2 CORNERS[6] = vec2[](
+    vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+    vec2(1.0, 1.0), vec2(-1.0, 1.0), vec2(-1.0, -1.0)
+);
+
+void main() {
+    // firstInstance selects the live half of the particle buffer
+    Particle particle = particles[gl_InstanceIndex];
+    vec2 corner = CORNERS[gl_VertexIndex];
+
+    float halfSize = particle.velocitySize.w * 0.5;
+    vec3 position = particle.positionLife.xyz +
+                    (camera.right.xyz * corner.x + camera.up.xyz * corner.y) * halfSize;
+
+    gl_Position = camera.viewProjection * vec4(position, 1.0);
+    fragColor = particle.color;
+    fragCorner = corner;
+}
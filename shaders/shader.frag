@@ -1,11 +1,12 @@
 #version 450
 
-layout(binding = 1) uniform sampler2D texSampler;
+// Block texture array, these meshes use its first layer
+layout(binding = 0) uniform sampler2DArray texSampler;
 
 layout(location = 0) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    outColor = texture(texSampler, vec3(fragTexCoord, 0.0));
 }
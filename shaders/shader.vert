@@ -1,10 +1,13 @@
 #version 450
 
-layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
-} ubo;
+// Pushed by BaseRenderer::pushCamera, mirrors CameraPushConstants
+layout(push_constant) uniform Camera {
+    mat4 viewProjection;
+    // Origin of the mesh in world space
+    vec4 offset;
+    vec4 right;
+    vec4 up;
+} camera;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
@@ -12,6 +15,6 @@ layout(location = 1) in vec2 inTexCoord;
 layout(location = 0) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = camera.viewProjection * vec4(inPosition + camera.offset.xyz, 1.0);
     fragTexCoord = inTexCoord;
 }
@@ -0,0 +1,14 @@
+#version 450
+
+layout(binding = 0) uniform sampler2DArray texSampler;
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) in float fragLight;
+layout(location = 2) flat in uint fragTexture;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec4 color = texture(texSampler, vec3(fragTexCoord, float(fragTexture)));
+    outColor = vec4(color.rgb * fragLight, color.a);
+}
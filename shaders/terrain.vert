@@ -0,0 +1,39 @@
+#version 450
+
+// Pushed by BaseRenderer::pushCamera, mirrors CameraPushConstants
+layout(push_constant) uniform Camera {
+    mat4 viewProjection;
+    // Origin of the mesh in world space
+    vec4 offset;
+    vec4 right;
+    vec4 up;
+} camera;
+
+layout(location = 0) in vec3 inPosition;
+// Bit layout packed by packTerrainVertexData in chunk_mesher.h
+layout(location = 1) in uint inData;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out float fragLight;
+layout(location = 2) flat out uint fragTexture;
+
+const uint MAX_LIGHT = 15u;
+// Each light level is this much dimmer than the next one
+const float LIGHT_FALLOFF = 0.8;
+const float MIN_LIGHT = 0.05;
+const uint MAX_AMBIENT_OCCLUSION = 3u;
+// Light lost per occluding neighbour of a corner
+const float OCCLUSION_STRENGTH = 0.2;
+
+void main() {
+    gl_Position = camera.viewProjection * vec4(inPosition + camera.offset.xyz, 1.0);
+
+    fragTexCoord = vec2(inData & 31u, (inData >> 5) & 31u);
+    uint blockLight = (inData >> 10) & 15u;
+    uint skyLight = (inData >> 14) & 15u;
+    uint level = max(blockLight, skyLight);
+    uint ambientOcclusion = (inData >> 18) & 3u;
+    fragTexture = inData >> 20;
+    fragLight = max(pow(LIGHT_FALLOFF, float(MAX_LIGHT - level)), MIN_LIGHT) *
+                (1.0 - float(MAX_AMBIENT_OCCLUSION - ambientOcclusion) * OCCLUSION_STRENGTH);
+}
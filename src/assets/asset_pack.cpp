@@ -0,0 +1,212 @@
+#include "asset_pack.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace plaxel {
+
+namespace {
+constexpr std::array<char, 8> MAGIC = {'P', 'L', 'X', 'L', 'P', 'A', 'C', 'K'};
+constexpr size_t HEADER_SIZE = MAGIC.size() + 2 * 4;
+constexpr size_t INDEX_ENTRY_SIZE = 2 * 4 + 2 * 8;
+
+void put32(std::vector<uint8_t> &out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void put64(std::vector<uint8_t> &out, uint64_t value) {
+  put32(out, static_cast<uint32_t>(value));
+  put32(out, static_cast<uint32_t>(value >> 32));
+}
+
+uint32_t get32(std::span<const char> pack, size_t offset) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; --i) {
+    value = value << 8 | static_cast<uint8_t>(pack[offset + i]);
+  }
+  return value;
+}
+
+uint64_t get64(std::span<const char> pack, size_t offset) {
+  return get32(pack, offset) | static_cast<uint64_t>(get32(pack, offset + 4)) << 32;
+}
+
+size_t alignUp(size_t offset) {
+  return (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+} // namespace
+
+AssetPack::AssetPack(const std::filesystem::path &path) {
+  const auto fileSize = static_cast<size_t>(std::filesystem::file_size(path));
+  if (fileSize < HEADER_SIZE) {
+    throw AssetPackError("asset pack too small: " + path.string());
+  }
+#ifdef _WIN32
+  const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw AssetPackError("failed to open asset pack: " + path.string());
+  }
+  mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  const void *data =
+      mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, fileSize) : nullptr;
+  if (!data) {
+    unmap();
+    throw AssetPackError("failed to map asset pack: " + path.string());
+  }
+#else
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw AssetPackError("failed to open asset pack: " + path.string());
+  }
+  const void *data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+  // The mapping keeps its own reference to the file
+  close(file);
+  if (data == MAP_FAILED) {
+    throw AssetPackError("failed to map asset pack: " + path.string());
+  }
+#endif
+  mapping = {static_cast<const char *>(data), fileSize};
+
+  if (!std::equal(MAGIC.begin(), MAGIC.end(), mapping.begin())) {
+    unmap();
+    throw AssetPackError("not an asset pack: " + path.string());
+  }
+  if (const uint32_t version = get32(mapping, MAGIC.size()); version != ASSET_PACK_VERSION) {
+    unmap();
+    throw AssetPackError("unsupported asset pack version " + std::to_string(version) + ": " +
+                         path.string());
+  }
+  assetCount = get32(mapping, MAGIC.size() + 4);
+  if (HEADER_SIZE + static_cast<uint64_t>(assetCount) * INDEX_ENTRY_SIZE > mapping.size()) {
+    unmap();
+    throw AssetPackError("truncated asset pack: " + path.string());
+  }
+}
+
+AssetPack::~AssetPack() { unmap(); }
+
+AssetPack::AssetPack(AssetPack &&other) noexcept
+    : mapping(std::exchange(other.mapping, {})),
+#ifdef _WIN32
+      mappingHandle(std::exchange(other.mappingHandle, nullptr)),
+#endif
+      assetCount(std::exchange(other.assetCount, 0)) {
+}
+
+AssetPack &AssetPack::operator=(AssetPack &&other) noexcept {
+  if (this != &other) {
+    unmap();
+    mapping = std::exchange(other.mapping, {});
+#ifdef _WIN32
+    mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    assetCount = std::exchange(other.assetCount, 0);
+  }
+  return *this;
+}
+
+void AssetPack::unmap() {
+#ifdef _WIN32
+  if (!mapping.empty()) {
+    UnmapViewOfFile(mapping.data());
+  }
+  if (mappingHandle) {
+    CloseHandle(mappingHandle);
+    mappingHandle = nullptr;
+  }
+#else
+  if (!mapping.empty()) {
+    munmap(const_cast<char *>(mapping.data()), mapping.size());
+  }
+#endif
+  mapping = {};
+}
+
+size_t AssetPack::size() const { return assetCount; }
+
+std::string_view AssetPack::nameAt(uint32_t index) const {
+  const size_t entry = HEADER_SIZE + static_cast<size_t>(index) * INDEX_ENTRY_SIZE;
+  const uint32_t offset = get32(mapping, entry);
+  const uint32_t length = get32(mapping, entry + 4);
+  if (static_cast<uint64_t>(offset) + length > mapping.size()) {
+    throw AssetPackError("asset name out of the pack");
+  }
+  return {mapping.data() + offset, length};
+}
+
+std::optional<std::span<const char>> AssetPack::find(std::string_view name) const {
+  uint32_t low = 0;
+  uint32_t high = assetCount;
+  while (low < high) {
+    const uint32_t middle = low + (high - low) / 2;
+    if (nameAt(middle) < name) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (low == assetCount || nameAt(low) != name) {
+    return std::nullopt;
+  }
+
+  const size_t entry = HEADER_SIZE + static_cast<size_t>(low) * INDEX_ENTRY_SIZE;
+  const uint64_t offset = get64(mapping, entry + 8);
+  const uint64_t length = get64(mapping, entry + 16);
+  if (offset > mapping.size() || length > mapping.size() - offset) {
+    throw AssetPackError("asset content out of the pack");
+  }
+  return mapping.subspan(offset, length);
+}
+
+std::vector<uint8_t> writeAssetPack(std::vector<AssetPackEntry> entries) {
+  std::ranges::sort(entries, {}, &AssetPackEntry::name);
+  if (std::ranges::adjacent_find(entries, {}, &AssetPackEntry::name) != entries.end()) {
+    throw AssetPackError("duplicate asset in pack");
+  }
+
+  size_t namesSize = 0;
+  for (const auto &entry : entries) {
+    namesSize += entry.name.size();
+  }
+  const size_t namesOffset = HEADER_SIZE + entries.size() * INDEX_ENTRY_SIZE;
+  size_t contentOffset = alignUp(namesOffset + namesSize);
+
+  std::vector<uint8_t> pack(MAGIC.begin(), MAGIC.end());
+  put32(pack, ASSET_PACK_VERSION);
+  put32(pack, static_cast<uint32_t>(entries.size()));
+  size_t nameOffset = namesOffset;
+  for (const auto &entry : entries) {
+    put32(pack, static_cast<uint32_t>(nameOffset));
+    put32(pack, static_cast<uint32_t>(entry.name.size()));
+    put64(pack, contentOffset);
+    put64(pack, entry.content.size());
+    nameOffset += entry.name.size();
+    contentOffset = alignUp(contentOffset + entry.content.size());
+  }
+  for (const auto &entry : entries) {
+    pack.insert(pack.end(), entry.name.begin(), entry.name.end());
+  }
+  for (const auto &entry : entries) {
+    pack.resize(alignUp(pack.size()));
+    pack.insert(pack.end(), entry.content.begin(), entry.content.end());
+  }
+  return pack;
+}
+
+} // namespace plaxel
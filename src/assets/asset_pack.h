@@ -0,0 +1,73 @@
+#ifndef PLAXEL_ASSET_PACK_H
+#define PLAXEL_ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace plaxel {
+
+// Bumped whenever the layout below changes, packs of other versions are rejected
+constexpr uint32_t ASSET_PACK_VERSION = 1;
+// Blobs start on this boundary so that they can be used in place, whatever they hold
+constexpr size_t ASSET_PACK_ALIGNMENT = 16;
+
+class AssetPackError final : public std::runtime_error {
+public:
+  using runtime_error::runtime_error;
+};
+
+struct AssetPackEntry {
+  std::string name;
+  std::vector<uint8_t> content;
+};
+
+/**
+ * Read only mapping of a pack file. The file starts with a header and an index of its assets sorted
+ * by name, followed by their names and their aligned contents:
+ * - header: magic, version, asset count
+ * - index entry: name offset and length, content offset and length
+ *
+ * Opening a pack only checks its header, finding an asset is a binary search through the index and
+ * returns a view into the mapping, so the pages of an asset are only read once it is used.
+ */
+class AssetPack {
+public:
+  explicit AssetPack(const std::filesystem::path &path);
+  ~AssetPack();
+  AssetPack(const AssetPack &) = delete;
+  AssetPack &operator=(const AssetPack &) = delete;
+  AssetPack(AssetPack &&other) noexcept;
+  AssetPack &operator=(AssetPack &&other) noexcept;
+
+  /**
+   * Content of the asset, valid as long as the pack is open
+   */
+  [[nodiscard]] std::optional<std::span<const char>> find(std::string_view name) const;
+  [[nodiscard]] size_t size() const;
+
+private:
+  std::span<const char> mapping;
+#ifdef _WIN32
+  void *mappingHandle = nullptr;
+#endif
+  uint32_t assetCount = 0;
+
+  [[nodiscard]] std::string_view nameAt(uint32_t index) const;
+  void unmap();
+};
+
+/**
+ * Serialize assets into a pack, in any order
+ */
+[[nodiscard]] std::vector<uint8_t> writeAssetPack(std::vector<AssetPackEntry> entries);
+
+} // namespace plaxel
+
+#endif // PLAXEL_ASSET_PACK_H
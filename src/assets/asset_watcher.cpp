@@ -0,0 +1,76 @@
+#include "asset_watcher.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <thread>
+#endif
+
+namespace plaxel {
+
+#ifdef __linux__
+AssetWatcher::AssetWatcher() : inotify(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+  if (inotify < 0) {
+    throw std::runtime_error("failed to initialize inotify");
+  }
+}
+
+AssetWatcher::~AssetWatcher() { close(inotify); }
+
+void AssetWatcher::watch(const std::filesystem::path &directory) {
+  // Editors either write files in place or move a temporary file over them
+  const int descriptor =
+      inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+  if (descriptor < 0) {
+    throw std::runtime_error("failed to watch " + directory.string());
+  }
+  directories[descriptor] = directory;
+}
+
+std::vector<std::filesystem::path>
+AssetWatcher::waitForChanges(std::chrono::milliseconds timeout) {
+  std::vector<std::filesystem::path> changes;
+  pollfd descriptor{inotify, POLLIN, 0};
+  if (poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0) {
+    return changes;
+  }
+
+  alignas(inotify_event) std::array<char, 4096> buffer{};
+  ssize_t length;
+  while ((length = read(inotify, buffer.data(), buffer.size())) > 0) {
+    for (ssize_t offset = 0; offset < length;) {
+      const auto *event = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+      const auto directory = directories.find(event->wd);
+      if (event->len == 0 || directory == directories.end()) {
+        continue;
+      }
+      std::filesystem::path path = directory->second / event->name;
+      if (std::ranges::find(changes, path) == changes.end()) {
+        changes.push_back(std::move(path));
+      }
+    }
+  }
+  return changes;
+}
+#else
+AssetWatcher::AssetWatcher() = default;
+
+AssetWatcher::~AssetWatcher() = default;
+
+void AssetWatcher::watch(const std::filesystem::path &) {}
+
+std::vector<std::filesystem::path>
+AssetWatcher::waitForChanges(std::chrono::milliseconds timeout) {
+  std::this_thread::sleep_for(timeout);
+  return {};
+}
+#endif
+
+} // namespace plaxel
@@ -0,0 +1,37 @@
+#ifndef PLAXEL_ASSET_WATCHER_H
+#define PLAXEL_ASSET_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+namespace plaxel {
+
+/**
+ * Reports the files written or moved into a set of directories, not recursively. Relies on
+ * inotify, on other platforms no change is ever reported.
+ */
+class AssetWatcher {
+public:
+  AssetWatcher();
+  ~AssetWatcher();
+  AssetWatcher(const AssetWatcher &) = delete;
+  AssetWatcher &operator=(const AssetWatcher &) = delete;
+
+  void watch(const std::filesystem::path &directory);
+  /**
+   * Wait up to the timeout for changes, and return the files changed since the last call, each
+   * once
+   */
+  [[nodiscard]] std::vector<std::filesystem::path>
+  waitForChanges(std::chrono::milliseconds timeout);
+
+private:
+  int inotify = -1;
+  std::unordered_map<int, std::filesystem::path> directories;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_ASSET_WATCHER_H
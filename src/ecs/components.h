@@ -0,0 +1,26 @@
+#ifndef PLAXEL_COMPONENTS_H
+#define PLAXEL_COMPONENTS_H
+
+#include "../renderer/instance_batch.h"
+
+#include <glm/vec3.hpp>
+
+namespace plaxel {
+
+struct Position {
+  glm::vec3 value{0.f};
+};
+
+struct Velocity {
+  glm::vec3 value{0.f};
+};
+
+struct Renderable {
+  MeshType mesh = MeshType::Sprite;
+  uint32_t sprite = 0;
+  float scale = 1.f;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_COMPONENTS_H
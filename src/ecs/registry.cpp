@@ -0,0 +1,44 @@
+#include "registry.h"
+
+namespace plaxel {
+
+Entity Registry::create() {
+  if (!freeIndices.empty()) {
+    const uint32_t index = freeIndices.back();
+    freeIndices.pop_back();
+    alive[index] = true;
+    return {index, generations[index]};
+  }
+
+  const auto index = static_cast<uint32_t>(generations.size());
+  generations.push_back(0);
+  alive.push_back(true);
+  return {index, 0};
+}
+
+void Registry::destroy(Entity entity) {
+  checkAlive(entity);
+  for (const auto &componentPool : pools) {
+    if (componentPool) {
+      componentPool->remove(entity.index);
+    }
+  }
+  alive[entity.index] = false;
+  generations[entity.index]++;
+  freeIndices.push_back(entity.index);
+}
+
+bool Registry::isAlive(Entity entity) const {
+  return entity.index < generations.size() && alive[entity.index] &&
+         generations[entity.index] == entity.generation;
+}
+
+size_t Registry::aliveCount() const { return generations.size() - freeIndices.size(); }
+
+void Registry::checkAlive(Entity entity) const {
+  if (!isAlive(entity)) {
+    throw RegistryError("invalid or destroyed entity handle");
+  }
+}
+
+} // namespace plaxel
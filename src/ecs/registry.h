@@ -0,0 +1,233 @@
+#ifndef PLAXEL_REGISTRY_H
+#define PLAXEL_REGISTRY_H
+
+#include "../jobs/job_system.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace plaxel {
+
+/**
+ * Stable handle to an entity. The generation is bumped whenever an index is recycled, so a handle
+ * to a destroyed entity never aliases the entity that reuses its slot.
+ */
+struct Entity {
+  static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = INVALID_INDEX;
+  uint32_t generation = 0;
+
+  bool operator==(const Entity &) const = default;
+};
+
+class RegistryError final : public std::runtime_error {
+public:
+  using runtime_error::runtime_error;
+};
+
+/**
+ * Sparse set: components live contiguously in a dense array, and a sparse array maps entity
+ * indices to their dense slot. Iteration walks the dense array and never chases pointers.
+ */
+class ComponentPoolBase {
+public:
+  virtual ~ComponentPoolBase() = default;
+
+  virtual void remove(uint32_t entityIndex) = 0;
+
+  [[nodiscard]] bool contains(uint32_t entityIndex) const {
+    return entityIndex < sparse.size() && sparse[entityIndex] != NO_SLOT;
+  }
+  [[nodiscard]] size_t size() const { return entities.size(); }
+  [[nodiscard]] uint32_t entityAt(size_t slot) const { return entities[slot]; }
+
+protected:
+  static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+  std::vector<uint32_t> sparse;
+  std::vector<uint32_t> entities;
+};
+
+template <typename C> class ComponentPool final : public ComponentPoolBase {
+public:
+  C &emplace(uint32_t entityIndex, C value) {
+    if (contains(entityIndex)) {
+      return components[sparse[entityIndex]] = std::move(value);
+    }
+    if (entityIndex >= sparse.size()) {
+      sparse.resize(entityIndex + 1, NO_SLOT);
+    }
+    sparse[entityIndex] = static_cast<uint32_t>(entities.size());
+    entities.push_back(entityIndex);
+    return components.emplace_back(std::move(value));
+  }
+
+  void remove(uint32_t entityIndex) override {
+    if (!contains(entityIndex)) {
+      return;
+    }
+    const uint32_t slot = sparse[entityIndex];
+    const uint32_t lastSlot = static_cast<uint32_t>(entities.size() - 1);
+    if (slot != lastSlot) {
+      swapSlots(slot, lastSlot);
+    }
+    entities.pop_back();
+    components.pop_back();
+    sparse[entityIndex] = NO_SLOT;
+  }
+
+  [[nodiscard]] C &get(uint32_t entityIndex) { return components[sparse[entityIndex]]; }
+  [[nodiscard]] const C &get(uint32_t entityIndex) const {
+    return components[sparse[entityIndex]];
+  }
+  [[nodiscard]] C &atSlot(size_t slot) { return components[slot]; }
+
+  /**
+   * Reorder the dense arrays so that the entities shared with lead come first, in lead's order.
+   * Iterating a view led by lead then reads this pool sequentially too.
+   */
+  void alignWith(const ComponentPoolBase &lead) {
+    uint32_t next = 0;
+    for (size_t leadSlot = 0; leadSlot < lead.size(); ++leadSlot) {
+      const uint32_t entityIndex = lead.entityAt(leadSlot);
+      if (!contains(entityIndex)) {
+        continue;
+      }
+      if (sparse[entityIndex] != next) {
+        swapSlots(sparse[entityIndex], next);
+      }
+      next++;
+    }
+  }
+
+private:
+  std::vector<C> components;
+
+  void swapSlots(uint32_t a, uint32_t b) {
+    std::swap(components[a], components[b]);
+    std::swap(entities[a], entities[b]);
+    sparse[entities[a]] = a;
+    sparse[entities[b]] = b;
+  }
+};
+
+/**
+ * Iterates every entity owning all the requested components. The first component type leads the
+ * iteration: its dense array is walked in order and split into batches for parallel iteration,
+ * so it should be the rarest of the requested components.
+ */
+template <typename Lead, typename... Others> class View {
+public:
+  View(ComponentPool<Lead> &leadPool, ComponentPool<Others> &...otherPools)
+      : lead(leadPool), others(&otherPools...) {}
+
+  template <typename F> void each(F &&f) { eachInRange(0, lead.size(), f); }
+
+  /**
+   * Same as each, with batches dispatched on the job system. f runs concurrently on different
+   * entities, so it must not add or remove entities and components.
+   */
+  template <typename F> void parallelEach(JobSystem &jobs, F &&f, size_t batchSize = 4096) {
+    jobs.parallelFor(lead.size(), batchSize,
+                     [this, &f](size_t begin, size_t end) { eachInRange(begin, end, f); });
+  }
+
+private:
+  ComponentPool<Lead> &lead;
+  std::tuple<ComponentPool<Others> *...> others;
+
+  template <typename F> void eachInRange(size_t begin, size_t end, F &f) {
+    for (size_t slot = begin; slot < end; ++slot) {
+      const uint32_t entityIndex = lead.entityAt(slot);
+      if ((std::get<ComponentPool<Others> *>(others)->contains(entityIndex) && ...)) {
+        f(lead.atSlot(slot), std::get<ComponentPool<Others> *>(others)->get(entityIndex)...);
+      }
+    }
+  }
+};
+
+namespace detail {
+// Component types may be used for the first time from different job threads
+inline std::atomic<size_t> nextComponentTypeId{0};
+
+template <typename C> size_t componentTypeId() {
+  static const size_t id = nextComponentTypeId.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+} // namespace detail
+
+class Registry {
+public:
+  Entity create();
+  void destroy(Entity entity);
+  [[nodiscard]] bool isAlive(Entity entity) const;
+  [[nodiscard]] size_t aliveCount() const;
+
+  template <typename C> C &add(Entity entity, C value = {}) {
+    checkAlive(entity);
+    return pool<C>().emplace(entity.index, std::move(value));
+  }
+
+  template <typename C> void remove(Entity entity) {
+    checkAlive(entity);
+    pool<C>().remove(entity.index);
+  }
+
+  template <typename C> [[nodiscard]] bool has(Entity entity) const {
+    const ComponentPool<C> *componentPool = findPool<C>();
+    return isAlive(entity) && componentPool && componentPool->contains(entity.index);
+  }
+
+  template <typename C> [[nodiscard]] C &get(Entity entity) {
+    if (!has<C>(entity)) {
+      throw RegistryError("entity does not have the requested component");
+    }
+    return pool<C>().get(entity.index);
+  }
+
+  template <typename Lead, typename... Others> [[nodiscard]] View<Lead, Others...> view() {
+    return View<Lead, Others...>(pool<Lead>(), pool<Others>()...);
+  }
+
+  /**
+   * Pack Other's components in Lead's iteration order, see ComponentPool::alignWith
+   */
+  template <typename Lead, typename Other> void align() { pool<Other>().alignWith(pool<Lead>()); }
+
+private:
+  std::vector<uint32_t> generations;
+  std::vector<bool> alive;
+  std::vector<uint32_t> freeIndices;
+  std::vector<std::unique_ptr<ComponentPoolBase>> pools;
+
+  void checkAlive(Entity entity) const;
+
+  template <typename C> ComponentPool<C> &pool() {
+    const size_t id = detail::componentTypeId<C>();
+    if (id >= pools.size()) {
+      pools.resize(id + 1);
+    }
+    if (!pools[id]) {
+      pools[id] = std::make_unique<ComponentPool<C>>();
+    }
+    return static_cast<ComponentPool<C> &>(*pools[id]);
+  }
+
+  template <typename C> const ComponentPool<C> *findPool() const {
+    const size_t id = detail::componentTypeId<C>();
+    if (id >= pools.size()) {
+      return nullptr;
+    }
+    return static_cast<const ComponentPool<C> *>(pools[id].get());
+  }
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_REGISTRY_H
@@ -0,0 +1,24 @@
+#include "systems.h"
+#include "components.h"
+
+#include <glm/ext/matrix_transform.hpp>
+
+namespace plaxel {
+
+void integrateVelocities(Registry &registry, JobSystem &jobs, float dt) {
+  registry.view<Velocity, Position>().parallelEach(
+      jobs, [dt](const Velocity &velocity, Position &position) {
+        position.value += velocity.value * dt;
+      });
+}
+
+void collectRenderables(Registry &registry, InstanceBatch &batch) {
+  registry.view<Renderable, Position>().each(
+      [&batch](const Renderable &renderable, const Position &position) {
+        const glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.f), position.value),
+                                               glm::vec3(renderable.scale));
+        batch.add(renderable.mesh, transform, renderable.sprite);
+      });
+}
+
+} // namespace plaxel
@@ -0,0 +1,15 @@
+#ifndef PLAXEL_SYSTEMS_H
+#define PLAXEL_SYSTEMS_H
+
+#include "../jobs/job_system.h"
+#include "../renderer/instance_batch.h"
+#include "registry.h"
+
+namespace plaxel {
+
+void integrateVelocities(Registry &registry, JobSystem &jobs, float dt);
+void collectRenderables(Registry &registry, InstanceBatch &batch);
+
+} // namespace plaxel
+
+#endif // PLAXEL_SYSTEMS_H
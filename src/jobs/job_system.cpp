@@ -0,0 +1,121 @@
+#include "job_system.h"
+#include "../profiling/tracer.h"
+
+#include <string>
+#include <utility>
+
+namespace plaxel {
+
+JobSystem::JobSystem(unsigned threadCount) {
+  for (unsigned i = 0; i < threadCount; ++i) {
+    workers.emplace_back([this, i] {
+      Tracer::get().setThreadName("job worker " + std::to_string(i));
+      workerLoop();
+    });
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    const std::scoped_lock lock(jobsMutex);
+    stopping = true;
+  }
+  jobAvailable.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+unsigned JobSystem::defaultThreadCount() {
+  // Keep one core for the main thread, which also runs jobs while it waits on them
+  const unsigned hardwareThreads = std::thread::hardware_concurrency();
+  return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+size_t JobSystem::getThreadCount() const { return workers.size(); }
+
+void JobSystem::submit(std::function<void()> job, JobCounter *counter) {
+  if (counter) {
+    counter->pending.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (workers.empty()) {
+    Job inlineJob{std::move(job), counter};
+    run(inlineJob);
+    return;
+  }
+  {
+    const std::scoped_lock lock(jobsMutex);
+    jobs.push_back({std::move(job), counter});
+  }
+  jobAvailable.notify_one();
+}
+
+void JobSystem::wait(JobCounter &counter) {
+  while (!counter.done()) {
+    if (!tryRunOne()) {
+      std::this_thread::yield();
+    }
+  }
+  std::exception_ptr error;
+  {
+    const std::scoped_lock lock(counter.errorMutex);
+    error = std::exchange(counter.error, nullptr);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void JobSystem::workerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock lock(jobsMutex);
+      jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+    run(job);
+  }
+}
+
+bool JobSystem::tryRunOne() {
+  Job job;
+  {
+    const std::scoped_lock lock(jobsMutex);
+    if (jobs.empty()) {
+      return false;
+    }
+    job = std::move(jobs.front());
+    jobs.pop_front();
+  }
+  run(job);
+  return true;
+}
+
+void JobSystem::run(Job &job) noexcept {
+  {
+    PLAXEL_TRACE_SCOPE("job");
+    try {
+      job.function();
+    } catch (...) {
+      if (!job.counter) {
+        // Nobody waits on the job to receive it, like a throwing thread
+        std::terminate();
+      }
+      const std::scoped_lock lock(job.counter->errorMutex);
+      if (!job.counter->error) {
+        job.counter->error = std::current_exception();
+      }
+    }
+  }
+  // Done even when it threw, so that waiting on its counter never hangs
+  if (job.counter) {
+    job.counter->pending.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+} // namespace plaxel
@@ -0,0 +1,95 @@
+#ifndef PLAXEL_JOB_SYSTEM_H
+#define PLAXEL_JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace plaxel {
+
+/**
+ * Counts the jobs of a batch still running, so that their submitter can wait for all of them
+ */
+struct JobCounter {
+  std::atomic<size_t> pending{0};
+  // First exception thrown by one of the jobs, rethrown by the wait once all of them are done
+  std::mutex errorMutex;
+  std::exception_ptr error;
+
+  [[nodiscard]] bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+/**
+ * Fixed pool of worker threads sharing a single queue of jobs
+ */
+class JobSystem {
+public:
+  explicit JobSystem(unsigned threadCount = defaultThreadCount());
+  ~JobSystem();
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  /**
+   * Exceptions of a job are handed to its counter, a job without one must not throw
+   */
+  void submit(std::function<void()> job, JobCounter *counter = nullptr);
+  /**
+   * Block until every job tracked by the counter is done, then rethrow the first exception one of
+   * them threw. The calling thread runs queued jobs meanwhile, so it is safe to wait from inside a
+   * job.
+   */
+  void wait(JobCounter &counter);
+
+  /**
+   * Run f(begin, end) over [0, count) split into batches of batchSize, and wait for completion.
+   * Every batch still runs when one throws, since they reference f, and the first exception is
+   * rethrown afterwards.
+   */
+  template <typename F> void parallelFor(size_t count, size_t batchSize, F &&f) {
+    if (count == 0) {
+      return;
+    }
+    batchSize = std::max<size_t>(batchSize, 1);
+    if (count <= batchSize || workers.empty()) {
+      f(size_t{0}, count);
+      return;
+    }
+
+    JobCounter counter;
+    for (size_t begin = 0; begin < count; begin += batchSize) {
+      const size_t end = std::min(begin + batchSize, count);
+      submit([&f, begin, end] { f(begin, end); }, &counter);
+    }
+    wait(counter);
+  }
+
+  [[nodiscard]] size_t getThreadCount() const;
+
+  static unsigned defaultThreadCount();
+
+private:
+  struct Job {
+    std::function<void()> function;
+    JobCounter *counter = nullptr;
+  };
+
+  std::vector<std::thread> workers;
+  std::deque<Job> jobs;
+  std::mutex jobsMutex;
+  std::condition_variable jobAvailable;
+  bool stopping = false;
+
+  void workerLoop();
+  bool tryRunOne();
+  static void run(Job &job) noexcept;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_JOB_SYSTEM_H
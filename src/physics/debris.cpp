@@ -0,0 +1,365 @@
+#include "debris.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+
+namespace plaxel {
+
+namespace {
+constexpr float CONTACT_EPSILON = 1e-3f;
+
+const std::array<glm::ivec3, 6> NEIGHBOURS = {glm::ivec3{1, 0, 0},  glm::ivec3{-1, 0, 0},
+                                              glm::ivec3{0, 1, 0},  glm::ivec3{0, -1, 0},
+                                              glm::ivec3{0, 0, 1},  glm::ivec3{0, 0, -1}};
+
+/**
+ * Call f on every integer cell overlapped by the unit cube whose minimum corner is min, stopping
+ * as soon as it returns true. Touching faces don't count as overlap.
+ */
+template <typename F> bool anyOverlappedCell(const glm::vec3 &min, F f) {
+  const glm::ivec3 first{static_cast<int>(std::floor(min.x + CONTACT_EPSILON)),
+                         static_cast<int>(std::floor(min.y + CONTACT_EPSILON)),
+                         static_cast<int>(std::floor(min.z + CONTACT_EPSILON))};
+  const glm::ivec3 last{static_cast<int>(std::floor(min.x + 1.f - CONTACT_EPSILON)),
+                        static_cast<int>(std::floor(min.y + 1.f - CONTACT_EPSILON)),
+                        static_cast<int>(std::floor(min.z + 1.f - CONTACT_EPSILON))};
+  for (int x = first.x; x <= last.x; ++x) {
+    for (int y = first.y; y <= last.y; ++y) {
+      for (int z = first.z; z <= last.z; ++z) {
+        if (f(glm::ivec3{x, y, z})) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+} // namespace
+
+glm::vec3 RigidBody::aabbMin() const { return position + glm::vec3(boundsMin); }
+
+glm::vec3 RigidBody::aabbMax() const { return position + glm::vec3(boundsMax); }
+
+DebrisSystem::DebrisSystem(World &targetWorld) : world(targetWorld) {
+  world.addEditListener([this](const BlockEdit &edit) { onEdit(edit); });
+}
+
+void DebrisSystem::step(float dt) {
+  // Built first so that removed blocks find the bodies around them, new bodies insert themselves
+  rebuildBroadphase();
+  detectIslands();
+
+  for (uint32_t i = 0; i < bodies.size(); ++i) {
+    if (!bodies[i].sleeping) {
+      integrate(i, dt);
+    }
+  }
+
+  settleBodies();
+}
+
+const std::vector<RigidBody> &DebrisSystem::getBodies() const { return bodies; }
+
+size_t DebrisSystem::awakeBodyCount() const {
+  return std::count_if(bodies.begin(), bodies.end(),
+                       [](const RigidBody &body) { return !body.sleeping; });
+}
+
+bool DebrisSystem::isApplyingOwnEdits() const { return applyingOwnEdits; }
+
+void DebrisSystem::onEdit(const BlockEdit &edit) {
+  if (applyingOwnEdits) {
+    return;
+  }
+  // Only removing a block can disconnect the structure around it, islands are detected on the
+  // next step so that edits made in the same frame are handled together
+  if (edit.previous != AIR && edit.current == AIR) {
+    pendingRemovals.push_back(edit.pos);
+  }
+}
+
+void DebrisSystem::detectIslands() {
+  if (pendingRemovals.empty()) {
+    return;
+  }
+
+  std::unordered_set<glm::ivec3, IVec3Hash> anchored;
+  std::vector<glm::ivec3> island;
+  for (const auto &removed : pendingRemovals) {
+    wakeBodiesNear(removed);
+
+    for (const auto &direction : NEIGHBOURS) {
+      const glm::ivec3 start = removed + direction;
+      if (!world.isSolid(start) || anchored.contains(start)) {
+        continue;
+      }
+      if (floodFill(start, anchored, island)) {
+        spawnBody(island);
+      }
+    }
+  }
+  pendingRemovals.clear();
+}
+
+/**
+ * Breadth-first search of the solid voxels connected to start. Returns true when they form a
+ * floating island, which is then stored in island. The search stops early as soon as it reaches
+ * something known to be anchored, and everything it visited is then remembered as anchored too.
+ */
+bool DebrisSystem::floodFill(const glm::ivec3 &start,
+                             std::unordered_set<glm::ivec3, IVec3Hash> &anchored,
+                             std::vector<glm::ivec3> &island) const {
+  island.clear();
+  island.push_back(start);
+  std::unordered_set<glm::ivec3, IVec3Hash> visited{start};
+
+  // The island vector doubles as the BFS queue
+  for (size_t head = 0; head < island.size(); ++head) {
+    const glm::ivec3 current = island[head];
+    if (current.y <= WORLD_FLOOR_Y || island.size() > MAX_ISLAND_VOXELS) {
+      anchored.insert(island.begin(), island.end());
+      return false;
+    }
+
+    for (const auto &direction : NEIGHBOURS) {
+      const glm::ivec3 next = current + direction;
+      if (visited.contains(next) || !world.isSolid(next)) {
+        continue;
+      }
+      if (anchored.contains(next)) {
+        anchored.insert(island.begin(), island.end());
+        return false;
+      }
+      visited.insert(next);
+      island.push_back(next);
+    }
+  }
+  return true;
+}
+
+void DebrisSystem::spawnBody(const std::vector<glm::ivec3> &island) {
+  glm::ivec3 origin = island[0];
+  for (const auto &pos : island) {
+    origin = glm::min(origin, pos);
+  }
+
+  RigidBody body;
+  body.position = glm::vec3(origin);
+  body.voxels.reserve(island.size());
+  for (const auto &pos : island) {
+    const glm::ivec3 offset = pos - origin;
+    body.voxels.push_back({offset, world.getBlock(pos)});
+    body.occupancy.insert(offset);
+    body.boundsMax = glm::max(body.boundsMax, offset + 1);
+  }
+  for (const auto &voxel : body.voxels) {
+    for (const auto &direction : NEIGHBOURS) {
+      if (!body.occupancy.contains(voxel.offset + direction)) {
+        body.hull.push_back(voxel.offset);
+        break;
+      }
+    }
+  }
+
+  applyingOwnEdits = true;
+  for (const auto &pos : island) {
+    world.setBlock(pos, AIR);
+  }
+  applyingOwnEdits = false;
+
+  broadphase.insert(static_cast<uint32_t>(bodies.size()), body.aabbMin(), body.aabbMax());
+  bodies.push_back(std::move(body));
+}
+
+void DebrisSystem::wakeBodiesNear(const glm::ivec3 &pos) {
+  const glm::vec3 cellMin(pos);
+  const glm::vec3 cellMax = cellMin + 1.f;
+  candidates.clear();
+  broadphase.query(cellMin - 1.f, cellMax + 1.f, candidates);
+  for (const uint32_t candidate : candidates) {
+    RigidBody &body = bodies[candidate];
+    const glm::vec3 min = body.aabbMin() - 1.f;
+    const glm::vec3 max = body.aabbMax() + 1.f;
+    if (cellMax.x > min.x && cellMin.x < max.x && cellMax.y > min.y && cellMin.y < max.y &&
+        cellMax.z > min.z && cellMin.z < max.z) {
+      body.sleeping = false;
+      body.restSteps = 0;
+    }
+  }
+}
+
+void DebrisSystem::rebuildBroadphase() {
+  broadphase.clear();
+  for (uint32_t i = 0; i < bodies.size(); ++i) {
+    broadphase.insert(i, bodies[i].aabbMin(), bodies[i].aabbMax());
+  }
+}
+
+void DebrisSystem::integrate(uint32_t bodyIndex, float dt) {
+  RigidBody &body = bodies[bodyIndex];
+  body.velocity.y = std::max(body.velocity.y - GRAVITY * dt, -TERMINAL_VELOCITY);
+
+  // Bodies move less than one voxel per step, so a one voxel margin covers everything this body
+  // can reach even though the broadphase was built at the start of the step
+  candidates.clear();
+  broadphase.query(body.aabbMin() - 1.f, body.aabbMax() + 1.f, candidates);
+  std::erase(candidates, bodyIndex);
+
+  const glm::vec3 start = body.position;
+  // Resolve the vertical axis first so that resting bodies get their friction before sliding
+  for (const int axis : {1, 0, 2}) {
+    const float delta = body.velocity[axis] * dt;
+    if (delta == 0.f) {
+      continue;
+    }
+
+    glm::vec3 target = body.position;
+    target[axis] += delta;
+    const std::optional<uint32_t> contact = findContact(bodyIndex, target);
+    if (!contact) {
+      body.position = target;
+      continue;
+    }
+
+    // Move flush against the obstacle, which always lies on the voxel grid
+    target[axis] = delta < 0 ? std::floor(body.position[axis] + CONTACT_EPSILON)
+                             : std::ceil(body.position[axis] - CONTACT_EPSILON);
+    if (!findContact(bodyIndex, target)) {
+      body.position = target;
+    }
+
+    if (*contact != WORLD_CONTACT && bodies[*contact].sleeping &&
+        std::abs(body.velocity[axis]) > WAKE_IMPACT_SPEED) {
+      bodies[*contact].sleeping = false;
+      bodies[*contact].restSteps = 0;
+    }
+    if (axis == 1) {
+      body.velocity.x *= GROUND_FRICTION;
+      body.velocity.z *= GROUND_FRICTION;
+    }
+    body.velocity[axis] = 0.f;
+  }
+
+  if (glm::length(body.position - start) < SLEEP_SPEED * dt &&
+      glm::length(body.velocity) < SLEEP_SPEED) {
+    body.restSteps++;
+    body.sleeping = body.restSteps >= STEPS_BEFORE_SLEEP;
+  } else {
+    body.restSteps = 0;
+  }
+}
+
+/**
+ * Find what the body would overlap if it was moved to the given position: nothing, the world
+ * (WORLD_CONTACT) or the index of another body.
+ */
+std::optional<uint32_t> DebrisSystem::findContact(uint32_t bodyIndex,
+                                                  const glm::vec3 &position) const {
+  const RigidBody &body = bodies[bodyIndex];
+  for (const auto &offset : body.hull) {
+    if (anyOverlappedCell(position + glm::vec3(offset),
+                          [this](const glm::ivec3 &cell) { return world.isSolid(cell); })) {
+      return WORLD_CONTACT;
+    }
+  }
+
+  const glm::vec3 min = position + glm::vec3(body.boundsMin);
+  const glm::vec3 max = position + glm::vec3(body.boundsMax);
+  for (const uint32_t other : candidates) {
+    const RigidBody &otherBody = bodies[other];
+    const glm::vec3 otherMin = otherBody.aabbMin();
+    const glm::vec3 otherMax = otherBody.aabbMax();
+    if (max.x <= otherMin.x || min.x >= otherMax.x || max.y <= otherMin.y ||
+        min.y >= otherMax.y || max.z <= otherMin.z || min.z >= otherMax.z) {
+      continue;
+    }
+
+    // Check our hull voxels against the other body's voxels, in the other body's local space
+    const glm::vec3 relative = position - otherBody.position;
+    for (const auto &offset : body.hull) {
+      if (anyOverlappedCell(relative + glm::vec3(offset), [&otherBody](const glm::ivec3 &cell) {
+            return otherBody.occupancy.contains(cell);
+          })) {
+        return other;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+/**
+ * Bodies that have been asleep long enough are written back into the world, so that a settled pile
+ * of debris costs nothing to simulate anymore. A body that can't be written whole where it rests
+ * is woken up instead, and tries again once it has found another resting place.
+ */
+void DebrisSystem::settleBodies() {
+  // Placements are searched with the broadphase of this step, so nothing is removed before the end
+  std::vector<uint32_t> settled;
+  for (uint32_t i = 0; i < bodies.size(); ++i) {
+    RigidBody &body = bodies[i];
+    if (!body.sleeping) {
+      continue;
+    }
+    body.restSteps++;
+    if (body.restSteps < STEPS_BEFORE_SETTLE) {
+      continue;
+    }
+
+    const std::optional<glm::ivec3> origin = findSettlePlacement(i);
+    if (!origin) {
+      body.sleeping = false;
+      body.restSteps = 0;
+      continue;
+    }
+    body.position = glm::vec3(*origin);
+    revoxelize(body, *origin);
+    settled.push_back(i);
+  }
+
+  for (auto it = settled.rbegin(); it != settled.rend(); ++it) {
+    std::swap(bodies[*it], bodies.back());
+    bodies.pop_back();
+  }
+}
+
+/**
+ * Find a grid position where every voxel of the body is free, starting from where it rests and
+ * moving up. Bodies resting off the grid have nothing exact under them and fall the rest of the way
+ * instead.
+ */
+std::optional<glm::ivec3> DebrisSystem::findSettlePlacement(uint32_t bodyIndex) {
+  const RigidBody &body = bodies[bodyIndex];
+  const glm::vec3 snapped = glm::round(body.position);
+  if (glm::length(body.position - snapped) > CONTACT_EPSILON) {
+    return std::nullopt;
+  }
+
+  candidates.clear();
+  broadphase.query(body.aabbMin() - 1.f,
+                   body.aabbMax() + glm::vec3(1.f, 1.f + MAX_SETTLE_LIFT, 1.f), candidates);
+  std::erase(candidates, bodyIndex);
+
+  glm::ivec3 origin(snapped);
+  for (int lift = 0; lift <= MAX_SETTLE_LIFT; ++lift, ++origin.y) {
+    // Bodies already settled this step are part of the world by now
+    const bool free = std::none_of(body.voxels.begin(), body.voxels.end(),
+                                   [this, &origin](const DebrisVoxel &voxel) {
+                                     return world.isSolid(origin + voxel.offset);
+                                   });
+    if (free && !findContact(bodyIndex, glm::vec3(origin))) {
+      return origin;
+    }
+  }
+  return std::nullopt;
+}
+
+void DebrisSystem::revoxelize(const RigidBody &body, const glm::ivec3 &origin) {
+  applyingOwnEdits = true;
+  for (const auto &voxel : body.voxels) {
+    world.setBlock(origin + voxel.offset, voxel.block);
+  }
+  applyingOwnEdits = false;
+}
+
+} // namespace plaxel
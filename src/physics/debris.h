@@ -0,0 +1,92 @@
+#ifndef PLAXEL_DEBRIS_H
+#define PLAXEL_DEBRIS_H
+
+#include "../world/world.h"
+#include "spatial_hash.h"
+
+#include <glm/vec3.hpp>
+#include <limits>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace plaxel {
+
+struct DebrisVoxel {
+  glm::ivec3 offset;
+  BlockId block;
+};
+
+/**
+ * A cluster of voxels detached from the world. Bodies only translate: they stay aligned on the
+ * voxel grid, which keeps collisions exact and lets them be written back into the world as-is.
+ */
+struct RigidBody {
+  glm::vec3 position{0.f};
+  glm::vec3 velocity{0.f};
+  std::vector<DebrisVoxel> voxels;
+  // Voxels with at least one free side, only those can touch anything
+  std::vector<glm::ivec3> hull;
+  std::unordered_set<glm::ivec3, IVec3Hash> occupancy;
+  glm::ivec3 boundsMin{0};
+  glm::ivec3 boundsMax{0};
+  bool sleeping = false;
+  int restSteps = 0;
+
+  [[nodiscard]] glm::vec3 aabbMin() const;
+  [[nodiscard]] glm::vec3 aabbMax() const;
+};
+
+constexpr float GRAVITY = 20.f;
+// Must stay under one voxel per step at 60Hz so falling bodies can't tunnel through a floor
+constexpr float TERMINAL_VELOCITY = 40.f;
+constexpr float GROUND_FRICTION = 0.8f;
+constexpr float SLEEP_SPEED = 0.05f;
+constexpr float WAKE_IMPACT_SPEED = 4.f;
+constexpr int STEPS_BEFORE_SLEEP = 10;
+constexpr int STEPS_BEFORE_SETTLE = 30;
+// How far up a settling body may be moved when its grid cells were filled while it slept
+constexpr int MAX_SETTLE_LIFT = 2;
+// Islands bigger than this are considered part of the terrain, to bound the cost of an edit
+constexpr size_t MAX_ISLAND_VOXELS = 4096;
+constexpr float BROADPHASE_CELL_SIZE = 4.f;
+
+class DebrisSystem {
+public:
+  explicit DebrisSystem(World &targetWorld);
+
+  void step(float dt);
+
+  [[nodiscard]] const std::vector<RigidBody> &getBodies() const;
+  [[nodiscard]] size_t awakeBodyCount() const;
+  // True while the system moves blocks between the world and its bodies, for other edit listeners
+  [[nodiscard]] bool isApplyingOwnEdits() const;
+
+private:
+  static constexpr uint32_t WORLD_CONTACT = std::numeric_limits<uint32_t>::max();
+
+  World &world;
+  std::vector<RigidBody> bodies;
+  SpatialHash broadphase{BROADPHASE_CELL_SIZE};
+  std::vector<uint32_t> candidates;
+  std::vector<glm::ivec3> pendingRemovals;
+  bool applyingOwnEdits = false;
+
+  void onEdit(const BlockEdit &edit);
+  void detectIslands();
+  bool floodFill(const glm::ivec3 &start, std::unordered_set<glm::ivec3, IVec3Hash> &anchored,
+                 std::vector<glm::ivec3> &island) const;
+  void spawnBody(const std::vector<glm::ivec3> &island);
+  void wakeBodiesNear(const glm::ivec3 &pos);
+  void rebuildBroadphase();
+  void integrate(uint32_t bodyIndex, float dt);
+  [[nodiscard]] std::optional<uint32_t> findContact(uint32_t bodyIndex,
+                                                    const glm::vec3 &position) const;
+  void settleBodies();
+  [[nodiscard]] std::optional<glm::ivec3> findSettlePlacement(uint32_t bodyIndex);
+  void revoxelize(const RigidBody &body, const glm::ivec3 &origin);
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_DEBRIS_H
@@ -0,0 +1,60 @@
+#include "spatial_hash.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace plaxel {
+
+SpatialHash::SpatialHash(float size) : cellSize(size) {}
+
+void SpatialHash::clear() {
+  // Keep the buckets that were used last time so their storage is reused, and drop the others so
+  // the map doesn't keep growing as objects travel across the world
+  for (auto it = cells.begin(); it != cells.end();) {
+    if (it->second.empty()) {
+      it = cells.erase(it);
+    } else {
+      it->second.clear();
+      ++it;
+    }
+  }
+}
+
+void SpatialHash::insert(uint32_t id, const glm::vec3 &min, const glm::vec3 &max) {
+  const glm::ivec3 minCell = toCell(min);
+  const glm::ivec3 maxCell = toCell(max);
+  for (int x = minCell.x; x <= maxCell.x; ++x) {
+    for (int y = minCell.y; y <= maxCell.y; ++y) {
+      for (int z = minCell.z; z <= maxCell.z; ++z) {
+        cells[{x, y, z}].push_back(id);
+      }
+    }
+  }
+}
+
+void SpatialHash::query(const glm::vec3 &min, const glm::vec3 &max,
+                        std::vector<uint32_t> &result) const {
+  const auto firstResult = static_cast<std::ptrdiff_t>(result.size());
+  const glm::ivec3 minCell = toCell(min);
+  const glm::ivec3 maxCell = toCell(max);
+  for (int x = minCell.x; x <= maxCell.x; ++x) {
+    for (int y = minCell.y; y <= maxCell.y; ++y) {
+      for (int z = minCell.z; z <= maxCell.z; ++z) {
+        if (const auto it = cells.find({x, y, z}); it != cells.end()) {
+          result.insert(result.end(), it->second.begin(), it->second.end());
+        }
+      }
+    }
+  }
+
+  std::sort(result.begin() + firstResult, result.end());
+  result.erase(std::unique(result.begin() + firstResult, result.end()), result.end());
+}
+
+glm::ivec3 SpatialHash::toCell(const glm::vec3 &pos) const {
+  return {static_cast<int>(std::floor(pos.x / cellSize)),
+          static_cast<int>(std::floor(pos.y / cellSize)),
+          static_cast<int>(std::floor(pos.z / cellSize))};
+}
+
+} // namespace plaxel
@@ -0,0 +1,36 @@
+#ifndef PLAXEL_SPATIAL_HASH_H
+#define PLAXEL_SPATIAL_HASH_H
+
+#include "../world/world.h"
+
+#include <glm/vec3.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace plaxel {
+
+/**
+ * Uniform grid broadphase: objects are registered in every cell their AABB overlaps, so a query
+ * only has to look at the few cells around the queried box instead of every object.
+ */
+class SpatialHash {
+public:
+  explicit SpatialHash(float size);
+
+  void clear();
+  void insert(uint32_t id, const glm::vec3 &min, const glm::vec3 &max);
+  /**
+   * Append every id whose cells overlap the given box to result, without duplicates
+   */
+  void query(const glm::vec3 &min, const glm::vec3 &max, std::vector<uint32_t> &result) const;
+
+private:
+  [[nodiscard]] glm::ivec3 toCell(const glm::vec3 &pos) const;
+
+  float cellSize;
+  std::unordered_map<glm::ivec3, std::vector<uint32_t>, IVec3Hash> cells;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_SPATIAL_HASH_H
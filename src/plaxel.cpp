@@ -1,14 +1,113 @@
 #include "plaxel.h"
+#include "ecs/registry.h"
+#include "ecs/systems.h"
+#include "jobs/job_system.h"
+#include "physics/debris.h"
+#include "renderer/file_utils.h"
 #include "renderer/renderer.h"
+#include "world/terrain.h"
+#include "world/world.h"
+
+#include <chrono>
+#include <filesystem>
+#include <glm/ext/matrix_transform.hpp>
 using namespace plaxel;
 
+namespace {
+constexpr uint32_t BLOCK_DUST_PARTICLES = 24;
+// Assets found in this pack of the working directory override the built-in ones
+constexpr const char *ASSET_PACK = "assets.pack";
+
+ParticleEmitter blockDust(const glm::ivec3 &pos) {
+  ParticleEmitter emitter;
+  emitter.position = glm::vec4(glm::vec3(pos) + .5f, .5f);
+  emitter.velocity = glm::vec4(0.f, 3.f, 0.f, 3.f);
+  emitter.color = glm::vec4(.55f, .5f, .45f, 1.f);
+  emitter.count = BLOCK_DUST_PARTICLES;
+  emitter.lifetime = 1.5f;
+  emitter.size = .1f;
+  emitter.seed = static_cast<uint32_t>(IVec3Hash{}(pos));
+  return emitter;
+}
+
+// Bodies are out of the world until they settle, their voxels with a free side are drawn as cubes
+void addDebrisInstances(const DebrisSystem &debris, InstanceBatch &batch) {
+  for (const RigidBody &body : debris.getBodies()) {
+    for (const glm::ivec3 &offset : body.hull) {
+      // The cube mesh is centered on its origin
+      const glm::vec3 center = body.position + glm::vec3(offset) + .5f;
+      batch.add(MeshType::Cube, glm::translate(glm::mat4(1.f), center), 0);
+    }
+  }
+}
+} // namespace
+
 void Plaxel::start() {
+  if (std::filesystem::exists(ASSET_PACK)) {
+    files::mountAssetPack(ASSET_PACK);
+  }
+  JobSystem jobs;
+  World world;
+  DebrisSystem debris(world);
+  Registry registry;
+
+  Terrain terrain(world, jobs);
+  JobCounter terrainUpdate;
+
   Renderer renderer;
   renderer.showWindow();
+  renderer.setRenderOnDemand(true);
+  // Heavy simulation scenes should cost sharpness rather than frame rate
+  renderer.enableDynamicResolution({});
+#ifdef PLAXEL_HOT_RELOAD
+  renderer.enableHotReload(
+      {PLAXEL_SOURCE_DIR, PLAXEL_HOT_RELOAD_DIR, PLAXEL_GLSL_VALIDATOR, PLAXEL_TEXTURE_COMPILER});
+#endif
+  renderer.setWorld(world);
+  // Side scroller along x, the camera looking down the z axis
+  renderer.setPlayfield(PlayfieldLayout{});
+  // Islands torn out by the debris system fall as bodies, only the broken block turns to dust
+  world.addEditListener([&renderer, &debris](const BlockEdit &edit) {
+    if (edit.current == AIR && !debris.isApplyingOwnEdits()) {
+      renderer.emitParticles(blockDust(edit.pos));
+    }
+  });
 
+  auto previousTime = std::chrono::steady_clock::now();
+  float simulationLag = 0;
   while (!renderer.shouldClose()) {
+    // The world is only edited while no terrain update reads it
+    jobs.wait(terrainUpdate);
+    renderer.updateTerrain(terrain.takeMeshes());
+
+    const auto currentTime = std::chrono::steady_clock::now();
+    simulationLag += std::chrono::duration<float>(currentTime - previousTime).count();
+    previousTime = currentTime;
+
+    int steps = 0;
+    while (simulationLag >= SIMULATION_STEP_S && steps < MAX_SIMULATION_STEPS_PER_FRAME) {
+      debris.step(SIMULATION_STEP_S);
+      integrateVelocities(registry, jobs, SIMULATION_STEP_S);
+      simulationLag -= SIMULATION_STEP_S;
+      steps++;
+    }
+    if (steps == MAX_SIMULATION_STEPS_PER_FRAME) {
+      simulationLag = 0;
+    }
+    // Keep stepping at the frame rate while bodies move, even when they do not edit the world
+    if (debris.awakeBodyCount() > 0) {
+      renderer.requestRedraw();
+    }
+    jobs.submit([&terrain] { terrain.update(); }, &terrainUpdate);
+
+    InstanceBatch &instanceBatch = renderer.getInstanceBatch();
+    instanceBatch.clear();
+    collectRenderables(registry, instanceBatch);
+    addDebrisInstances(debris, instanceBatch);
+
     renderer.draw();
   }
 
+  jobs.wait(terrainUpdate);
   renderer.closeWindow();
 }
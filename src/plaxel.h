@@ -3,6 +3,10 @@
 
 namespace plaxel {
 
+constexpr float SIMULATION_STEP_S = 1.0f / 60;
+// Beyond this many steps in one frame we drop the remaining time instead of trying to catch up
+constexpr int MAX_SIMULATION_STEPS_PER_FRAME = 4;
+
 class Plaxel {
 public:
   static void start();
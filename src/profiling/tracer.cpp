@@ -0,0 +1,145 @@
+#include "tracer.h"
+
+#include <fstream>
+#include <iomanip>
+#include <string_view>
+
+namespace plaxel {
+
+namespace {
+
+// Track of the GPU ranges, the CPU threads are numbered from 1
+constexpr uint32_t GPU_THREAD_ID = 0;
+
+void writeJsonString(std::ostream &out, std::string_view text) {
+  out << '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out << '\\';
+    }
+    out << c;
+  }
+  out << '"';
+}
+
+void writeThreadName(std::ostream &out, uint32_t threadId, const std::string &name, bool &first) {
+  out << (first ? "\n" : ",\n");
+  first = false;
+  out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << threadId << R"(,"args":{"name":)";
+  writeJsonString(out, name);
+  out << "}}";
+}
+
+} // namespace
+
+Tracer &Tracer::get() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer() {
+  gpuBuffer.threadId = GPU_THREAD_ID;
+  gpuBuffer.name = "GPU";
+}
+
+void Tracer::start() {
+  windowStart = Clock::now();
+  window.fetch_add(1, std::memory_order_release);
+  capturing.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop() { capturing.store(false, std::memory_order_relaxed); }
+
+void Tracer::setThreadName(std::string name) {
+  ThreadBuffer &buffer = currentThreadBuffer();
+  const std::scoped_lock lock(buffersMutex);
+  buffer.name = std::move(name);
+}
+
+void Tracer::recordCpu(const char *name, Clock::time_point start, Clock::time_point end) {
+  append(currentThreadBuffer(), {name, start, end - start});
+}
+
+void Tracer::recordGpu(const char *name, Clock::time_point start, Clock::time_point end) {
+  append(gpuBuffer, {name, start, end - start});
+}
+
+Tracer::ThreadBuffer &Tracer::currentThreadBuffer() {
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (!buffer) {
+    const std::scoped_lock lock(buffersMutex);
+    buffer = buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+    buffer->threadId = static_cast<uint32_t>(buffers.size());
+    buffer->name = "thread " + std::to_string(buffer->threadId);
+  }
+  return *buffer;
+}
+
+void Tracer::append(ThreadBuffer &buffer, const TraceEvent &event) const {
+  const uint64_t current = window.load(std::memory_order_acquire);
+  if (buffer.window.load(std::memory_order_relaxed) != current) {
+    // Reset before publishing the window, so that the export never sees stale events in it
+    buffer.count.store(0, std::memory_order_relaxed);
+    buffer.window.store(current, std::memory_order_release);
+  }
+  const size_t index = buffer.count.load(std::memory_order_relaxed);
+  if (index == MAX_EVENTS_PER_THREAD) {
+    return;
+  }
+  if (!buffer.events) {
+    // Threads that never record during a window don't pay for a buffer
+    buffer.events = std::make_unique<TraceEvent[]>(MAX_EVENTS_PER_THREAD);
+  }
+  buffer.events[index] = event;
+  buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::writeEvents(std::ostream &out, const ThreadBuffer &buffer, bool &first) const {
+  writeThreadName(out, buffer.threadId, buffer.name, first);
+  if (buffer.window.load(std::memory_order_acquire) != window.load(std::memory_order_relaxed)) {
+    return;
+  }
+  const size_t count = buffer.count.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i) {
+    const TraceEvent &event = buffer.events[i];
+    // GPU ranges of frames submitted before the window opened
+    if (event.start < windowStart) {
+      continue;
+    }
+    const std::chrono::duration<double, std::micro> start = event.start - windowStart;
+    const std::chrono::duration<double, std::micro> duration = event.duration;
+    out << ",\n{\"name\":";
+    writeJsonString(out, event.name);
+    out << R"(,"ph":"X","pid":1,"tid":)" << buffer.threadId << R"(,"ts":)" << start.count()
+        << R"(,"dur":)" << duration.count() << '}';
+  }
+}
+
+void Tracer::writeChromeTrace(std::ostream &out) const {
+  const std::ios::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+  // Timestamps are in microseconds, keep nanosecond resolution
+  out << std::fixed << std::setprecision(3);
+
+  out << R"({"displayTimeUnit":"ms","traceEvents":[)";
+  bool first = true;
+  writeEvents(out, gpuBuffer, first);
+  {
+    const std::scoped_lock lock(buffersMutex);
+    for (const auto &buffer : buffers) {
+      writeEvents(out, *buffer, first);
+    }
+  }
+  out << "\n]}\n";
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+bool Tracer::saveChromeTrace(const std::filesystem::path &path) const {
+  std::ofstream file(path);
+  writeChromeTrace(file);
+  return static_cast<bool>(file);
+}
+
+} // namespace plaxel
@@ -0,0 +1,109 @@
+#ifndef PLAXEL_TRACER_H
+#define PLAXEL_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace plaxel {
+
+struct TraceEvent {
+  // String literal, so that recording an event never allocates
+  const char *name;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::duration duration;
+};
+
+/**
+ * Records timed ranges of every thread during a capture window, then exports them as Chrome trace
+ * JSON, which chrome://tracing and Perfetto open. Each thread appends to its own buffer without
+ * locking; the buffers are only read by the export, once the window is stopped.
+ */
+class Tracer {
+public:
+  using Clock = std::chrono::steady_clock;
+  // Events past this count are dropped until the next window
+  static constexpr size_t MAX_EVENTS_PER_THREAD = 1 << 16;
+
+  static Tracer &get();
+
+  /**
+   * Open a new capture window, discarding the events of the previous one
+   */
+  void start();
+  void stop();
+  [[nodiscard]] bool isCapturing() const { return capturing.load(std::memory_order_relaxed); }
+
+  /**
+   * Name shown for the calling thread in the exported timeline
+   */
+  void setThreadName(std::string name);
+  void recordCpu(const char *name, Clock::time_point start, Clock::time_point end);
+  /**
+   * Range measured on the GPU, already converted to the CPU clock. Only one thread may record them.
+   */
+  void recordGpu(const char *name, Clock::time_point start, Clock::time_point end);
+
+  void writeChromeTrace(std::ostream &out) const;
+  bool saveChromeTrace(const std::filesystem::path &path) const;
+
+private:
+  struct ThreadBuffer {
+    uint32_t threadId = 0;
+    std::string name;
+    std::unique_ptr<TraceEvent[]> events;
+    // Window the events belong to, so that only the owning thread ever resets its buffer
+    std::atomic<uint64_t> window{0};
+    std::atomic<size_t> count{0};
+  };
+
+  Tracer();
+  ThreadBuffer &currentThreadBuffer();
+  void append(ThreadBuffer &buffer, const TraceEvent &event) const;
+  void writeEvents(std::ostream &out, const ThreadBuffer &buffer, bool &first) const;
+
+  std::atomic<bool> capturing{false};
+  std::atomic<uint64_t> window{0};
+  Clock::time_point windowStart;
+  // Only locked when a thread records for the first time, and by the export
+  mutable std::mutex buffersMutex;
+  // Never shrinks, since threads keep pointers to their buffer
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  ThreadBuffer gpuBuffer;
+};
+
+/**
+ * Times the enclosing scope while a capture window is open
+ */
+class TraceScope {
+public:
+  explicit TraceScope(const char *scopeName)
+      : name(Tracer::get().isCapturing() ? scopeName : nullptr),
+        start(name ? Tracer::Clock::now() : Tracer::Clock::time_point{}) {}
+  ~TraceScope() {
+    if (name) {
+      Tracer::get().recordCpu(name, start, Tracer::Clock::now());
+    }
+  }
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *name;
+  Tracer::Clock::time_point start;
+};
+
+} // namespace plaxel
+
+#define PLAXEL_TRACE_CONCAT_INNER(a, b) a##b
+#define PLAXEL_TRACE_CONCAT(a, b) PLAXEL_TRACE_CONCAT_INNER(a, b)
+#define PLAXEL_TRACE_SCOPE(name)                                                                   \
+  const ::plaxel::TraceScope PLAXEL_TRACE_CONCAT(plaxelTraceScope, __LINE__)(name)
+
+#endif // PLAXEL_TRACER_H
@@ -4,19 +4,27 @@ namespace plaxel {
 
 Buffer::Buffer(const vk::raii::Device &device, const vk::raii::PhysicalDevice &physicalDevice,
                const vk::DeviceSize size, const vk::BufferUsageFlags usage,
-               const vk::MemoryPropertyFlags properties)
-    : buffer(initBuffer(device, size, usage)),
+               const vk::MemoryPropertyFlags properties,
+               const std::span<const uint32_t> queueFamilies)
+    : buffer(initBuffer(device, size, usage, queueFamilies)),
       bufferMemory(initBufferMemory(device, physicalDevice, properties)), bufferSize(size) {
 
   buffer.bindMemory(*bufferMemory, 0);
 }
 
 vk::raii::Buffer Buffer::initBuffer(const vk::raii::Device &device, unsigned long size,
-                                    const vk::BufferUsageFlags &usage) {
+                                    const vk::BufferUsageFlags &usage,
+                                    const std::span<const uint32_t> queueFamilies) {
   vk::BufferCreateInfo bufferInfo;
   bufferInfo.size = size;
   bufferInfo.usage = usage;
-  bufferInfo.sharingMode = vk::SharingMode::eExclusive;
+  if (queueFamilies.size() > 1) {
+    bufferInfo.sharingMode = vk::SharingMode::eConcurrent;
+    bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+    bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+  } else {
+    bufferInfo.sharingMode = vk::SharingMode::eExclusive;
+  }
 
   return {device, bufferInfo};
 }
@@ -65,10 +73,21 @@ vk::WriteDescriptorSet &Buffer::getDescriptorWriteForCompute(vk::DescriptorSet c
   return descriptorWrite;
 }
 
-void Buffer::copyToMemory(const void *src) {
+void Buffer::copyToMemory(const void *src) { copyToMemory(src, bufferSize, 0); }
+
+void Buffer::copyToMemory(const void *src, vk::DeviceSize size, vk::DeviceSize offset) {
+  if (!mappedMemory) {
+    mappedMemory = bufferMemory.mapMemory(0, bufferSize);
+  }
+  memcpy(static_cast<char *>(mappedMemory) + offset, src, size);
+}
+
+void Buffer::copyFromMemory(void *dst, vk::DeviceSize size, vk::DeviceSize offset) {
   if (!mappedMemory) {
     mappedMemory = bufferMemory.mapMemory(0, bufferSize);
   }
-  memcpy(mappedMemory, src, bufferSize);
+  memcpy(dst, static_cast<const char *>(mappedMemory) + offset, size);
 }
+
+vk::DeviceSize Buffer::getSize() const { return bufferSize; }
 } // namespace plaxel
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef PLAXEL_BUFFER_H
 #define PLAXEL_BUFFER_H
 
+#include <span>
 #include <vulkan/vulkan_raii.hpp>
 namespace plaxel {
 
@@ -11,12 +12,20 @@ public:
 
 class Buffer {
 public:
+  /**
+   * The buffer is shared concurrently when several queue families are given, otherwise it is owned
+   * by one family at a time
+   */
   Buffer(const vk::raii::Device &device, const vk::raii::PhysicalDevice &physicalDevice,
-         vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties);
+         vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties,
+         std::span<const uint32_t> queueFamilies = {});
   [[nodiscard]] vk::Buffer getBuffer() const;
   vk::WriteDescriptorSet &getDescriptorWriteForCompute(vk::DescriptorSet computeDescriptorSet,
                                                        int dstBinding);
   void copyToMemory(const void *src);
+  void copyToMemory(const void *src, vk::DeviceSize size, vk::DeviceSize offset);
+  void copyFromMemory(void *dst, vk::DeviceSize size, vk::DeviceSize offset = 0);
+  [[nodiscard]] vk::DeviceSize getSize() const;
 
   [[nodiscard]] static uint32_t findMemoryType(uint32_t typeFilter,
                                                vk::MemoryPropertyFlags properties,
@@ -32,7 +41,8 @@ private:
   vk::DescriptorBufferInfo storageBufferInfoCurrentFrame{};
 
   static vk::raii::Buffer initBuffer(const vk::raii::Device &device, unsigned long size,
-                                     const vk::BufferUsageFlags &usage);
+                                     const vk::BufferUsageFlags &usage,
+                                     std::span<const uint32_t> queueFamilies);
   [[nodiscard]] vk::raii::DeviceMemory initBufferMemory(const vk::raii::Device &device,
                                           const vk::raii::PhysicalDevice &physicalDevice,
                                           const vk::MemoryPropertyFlags &properties) const;
@@ -1,11 +1,16 @@
 #include "base_renderer.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <limits>
 #include <random>
 #include <set>
+#include <sstream>
 #include <thread>
+#include <tuple>
+#include <utility>
 
 using namespace plaxel;
 
@@ -13,12 +18,16 @@ using namespace plaxel;
  * Setup the bare minimum to open a new window
  */
 void BaseRenderer::showWindow() {
+  Tracer::get().setThreadName("main");
   createWindow();
   initVulkan();
 }
 
 void BaseRenderer::closeWindow() const {
   device.waitIdle();
+  if (Tracer::get().isCapturing()) {
+    stopTrace("trace.json");
+  }
 
   glfwDestroyWindow(window);
   glfwTerminate();
@@ -40,6 +49,7 @@ void BaseRenderer::createWindow() {
   glfwSetCursorPosCallback(window, mouseMoveHandler);
   glfwSetKeyCallback(window, keyboardHandler);
   glfwSetMouseButtonCallback(window, mouseHandler);
+  glfwSetWindowRefreshCallback(window, windowRefreshHandler);
   if (!window) {
     throw VulkanInitializationError("Could not create window");
   }
@@ -49,6 +59,11 @@ void BaseRenderer::framebufferResizeCallback(GLFWwindow *window, [[maybe_unused]
                                              [[maybe_unused]] int height) {
   const auto pRenderer = static_cast<BaseRenderer *>(glfwGetWindowUserPointer(window));
   pRenderer->framebufferResized = true;
+  pRenderer->requestRedraw();
+}
+
+void BaseRenderer::windowRefreshHandler(GLFWwindow *window) {
+  static_cast<BaseRenderer *>(glfwGetWindowUserPointer(window))->requestRedraw();
 }
 
 bool BaseRenderer::shouldClose() const { return glfwWindowShouldClose(window); }
@@ -60,8 +75,7 @@ void BaseRenderer::initVulkan() {
   pickPhysicalDevice();
   createLogicalDevice();
   createSwapChain();
-  createImageViews();
-  createRenderPass();
+  depthFormat = findDepthFormat();
 
   initCustomDescriptorSetLayout();
 
@@ -69,18 +83,32 @@ void BaseRenderer::initVulkan() {
   createComputePipeline();
   createCommandPool();
   createDepthResources();
-  createFramebuffers();
-  createUniformBuffers();
+  createSceneResources();
   createDescriptorPool();
-  createCommandBuffers();
   createComputeCommandBuffers();
   createSyncObjects();
+  createFrameResources();
 }
 
 void BaseRenderer::initCustomDescriptorSetLayout() {
   // Overridden for additional descriptor set layout
 }
 
+void BaseRenderer::initCustomFrameResources() {
+  // Overridden for additional per frame resources
+}
+
+uint32_t BaseRenderer::getFramesInFlight() const { return latencyConfig.framesInFlight; }
+
+void BaseRenderer::prepareFrame(uint32_t) {
+  // Overridden to update per frame resources
+}
+
+bool BaseRenderer::isAnimating() const {
+  // Overridden for content changing on its own
+  return false;
+}
+
 void BaseRenderer::createInstance() {
   if (enableValidationLayers && !checkValidationLayerSupport()) {
     throw VulkanInitializationError("validation layers requested, but not available!");
@@ -91,7 +119,8 @@ void BaseRenderer::createInstance() {
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "PlaxelEngine";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-  appInfo.apiVersion = VK_API_VERSION_1_0;
+  // Required by the extensions of dynamic rendering
+  appInfo.apiVersion = VK_API_VERSION_1_1;
 
   vk::InstanceCreateInfo createInfo{};
   createInfo.pApplicationInfo = &appInfo;
@@ -206,35 +235,30 @@ bool BaseRenderer::isDeviceSuitable(vk::PhysicalDevice physicalDeviceCandidate)
     swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
   }
 
-  return indices.isComplete() && extensionsSupported && swapChainAdequate;
+  bool dynamicRenderingSupported = false;
+  if (extensionsSupported &&
+      physicalDeviceCandidate.getProperties().apiVersion >= VK_API_VERSION_1_1) {
+    const auto features =
+        physicalDeviceCandidate.getFeatures2<vk::PhysicalDeviceFeatures2,
+                                             vk::PhysicalDeviceDynamicRenderingFeaturesKHR>();
+    dynamicRenderingSupported =
+        features.get<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>().dynamicRendering;
+  }
+
+  // Each mesh type draws its own range of the instance buffer
+  const bool firstInstanceSupported =
+      physicalDeviceCandidate.getFeatures().drawIndirectFirstInstance == vk::True;
+
+  return indices.isComplete() && extensionsSupported && swapChainAdequate &&
+         dynamicRenderingSupported && firstInstanceSupported;
 }
 
 QueueFamilyIndices
 BaseRenderer::findQueueFamilies(vk::PhysicalDevice physicalDeviceCandidate) const {
-  QueueFamilyIndices indices;
-
-  const std::vector<vk::QueueFamilyProperties> queueFamilies =
-      physicalDeviceCandidate.getQueueFamilyProperties();
-
-  int i = 0;
-  for (const auto &queueFamily : queueFamilies) {
-    if ((queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) &&
-        (queueFamily.queueFlags & vk::QueueFlagBits::eCompute)) {
-      indices.graphicsAndComputeFamily = i;
-    }
-
-    if (physicalDeviceCandidate.getSurfaceSupportKHR(i, *surface)) {
-      indices.presentFamily = i;
-    }
-
-    if (indices.isComplete()) {
-      break;
-    }
-
-    i++;
-  }
-
-  return indices;
+  const auto supportsPresent = [this, physicalDeviceCandidate](uint32_t index) {
+    return physicalDeviceCandidate.getSurfaceSupportKHR(index, *surface) == vk::True;
+  };
+  return selectQueueFamilies(physicalDeviceCandidate.getQueueFamilyProperties(), supportsPresent);
 }
 
 bool BaseRenderer::checkDeviceExtensionSupport(vk::PhysicalDevice physicalDevice) {
@@ -263,11 +287,13 @@ BaseRenderer::querySwapChainSupport(vk::PhysicalDevice physicalDeviceCandidate)
 }
 
 void BaseRenderer::createLogicalDevice() {
-  QueueFamilyIndices indices = findQueueFamilies(*physicalDevice);
+  queueFamilies = findQueueFamilies(*physicalDevice);
+  const QueueFamilyIndices &indices = queueFamilies;
 
   std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
-  std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsAndComputeFamily.value(),
-                                            indices.presentFamily.value()};
+  std::set<uint32_t> uniqueQueueFamilies = {
+      indices.graphicsAndComputeFamily.value(), indices.presentFamily.value(),
+      indices.computeFamily.value(), indices.transferFamily.value()};
 
   float queuePriority = 1.0f;
   for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -280,6 +306,8 @@ void BaseRenderer::createLogicalDevice() {
 
   vk::PhysicalDeviceFeatures deviceFeatures{};
   deviceFeatures.samplerAnisotropy = vk::True;
+  // Instanced draws of each mesh type start at their own offset of the instance buffer
+  deviceFeatures.drawIndirectFirstInstance = vk::True;
 
   vk::DeviceCreateInfo createInfo{};
   createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
@@ -287,6 +315,11 @@ void BaseRenderer::createLogicalDevice() {
 
   createInfo.pEnabledFeatures = &deviceFeatures;
 
+  // The scene is recorded without render pass nor framebuffer objects
+  vk::PhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures;
+  dynamicRenderingFeatures.dynamicRendering = vk::True;
+  createInfo.pNext = &dynamicRenderingFeatures;
+
   createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
   createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
@@ -299,22 +332,27 @@ void BaseRenderer::createLogicalDevice() {
 
   device = vk::raii::Device(physicalDevice, createInfo);
 
+  // Without dedicated families, the compute and transfer queues are the graphics one
   graphicsQueue = device.getQueue(indices.graphicsAndComputeFamily.value(), 0);
-  computeQueue = device.getQueue(indices.graphicsAndComputeFamily.value(), 0);
+  computeQueue = device.getQueue(indices.computeFamily.value(), 0);
+  transferQueue = device.getQueue(indices.transferFamily.value(), 0);
   presentQueue = device.getQueue(indices.presentFamily.value(), 0);
 }
 
-void BaseRenderer::createSwapChain() {
+void BaseRenderer::createSwapChain(const vk::SwapchainKHR oldSwapChain) {
   const SwapChainSupportDetails swapChainSupport = querySwapChainSupport(*physicalDevice);
 
   const vk::SurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-  const vk::PresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+  const vk::PresentModeKHR presentMode =
+      chooseSwapPresentMode(swapChainSupport.presentModes, latencyConfig.presentMode);
   const vk::Extent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
-  uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-  if (swapChainSupport.capabilities.maxImageCount > 0 &&
-      imageCount > swapChainSupport.capabilities.maxImageCount) {
-    imageCount = swapChainSupport.capabilities.maxImageCount;
+  const vk::SurfaceCapabilitiesKHR &capabilities = swapChainSupport.capabilities;
+  uint32_t imageCount = latencyConfig.swapChainImageCount > 0 ? latencyConfig.swapChainImageCount
+                                                              : capabilities.minImageCount + 1;
+  imageCount = std::max(imageCount, capabilities.minImageCount);
+  if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount) {
+    imageCount = capabilities.maxImageCount;
   }
 
   vk::SwapchainCreateInfoKHR createInfo{};
@@ -325,8 +363,13 @@ void BaseRenderer::createSwapChain() {
   createInfo.imageColorSpace = surfaceFormat.colorSpace;
   createInfo.imageExtent = extent;
   createInfo.imageArrayLayers = 1;
-  createInfo.imageUsage =
-      vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc;
+  // Only a scaled scene is drawn offscreen then copied, otherwise the images are drawn to directly.
+  // Either way they stay a source for captures.
+  drawToSwapChain = !resolutionScaler ||
+                    !(capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst);
+  createInfo.imageUsage = (drawToSwapChain ? vk::ImageUsageFlagBits::eColorAttachment
+                                           : vk::ImageUsageFlagBits::eTransferDst) |
+                          vk::ImageUsageFlagBits::eTransferSrc;
 
   const QueueFamilyIndices indices = findQueueFamilies(*physicalDevice);
   const std::vector<uint32_t> queueFamilyIndices = {indices.graphicsAndComputeFamily.value(),
@@ -344,6 +387,7 @@ void BaseRenderer::createSwapChain() {
   createInfo.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
   createInfo.presentMode = presentMode;
   createInfo.clipped = VK_TRUE;
+  createInfo.oldSwapchain = oldSwapChain;
 
   swapChain = vk::raii::SwapchainKHR(device, createInfo);
 
@@ -351,6 +395,15 @@ void BaseRenderer::createSwapChain() {
 
   swapChainImageFormat = surfaceFormat.format;
   swapChainExtent = extent;
+  lastImageIndex = 0;
+
+  swapChainImageViews.clear();
+  if (drawToSwapChain) {
+    for (const vk::Image image : swapChainImages) {
+      swapChainImageViews.push_back(
+          createImageView(image, swapChainImageFormat, vk::ImageAspectFlagBits::eColor));
+    }
+  }
 }
 
 vk::SurfaceFormatKHR
@@ -366,9 +419,26 @@ BaseRenderer::chooseSwapSurfaceFormat(const std::vector<vk::SurfaceFormatKHR> &a
 }
 
 vk::PresentModeKHR
-BaseRenderer::chooseSwapPresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes) {
+BaseRenderer::chooseSwapPresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes,
+                                    PresentMode preferredMode) {
+  vk::PresentModeKHR preferredPresentMode = vk::PresentModeKHR::eFifo;
+  switch (preferredMode) {
+  case PresentMode::Immediate:
+    preferredPresentMode = vk::PresentModeKHR::eImmediate;
+    break;
+  case PresentMode::Mailbox:
+    preferredPresentMode = vk::PresentModeKHR::eMailbox;
+    break;
+  case PresentMode::Fifo:
+    preferredPresentMode = vk::PresentModeKHR::eFifo;
+    break;
+  case PresentMode::FifoRelaxed:
+    preferredPresentMode = vk::PresentModeKHR::eFifoRelaxed;
+    break;
+  }
+
   for (const auto &availablePresentMode : availablePresentModes) {
-    if (availablePresentMode == vk::PresentModeKHR::eMailbox) {
+    if (availablePresentMode == preferredPresentMode) {
       return availablePresentMode;
     }
   }
@@ -395,74 +465,28 @@ vk::Extent2D BaseRenderer::chooseSwapExtent(const vk::SurfaceCapabilitiesKHR &ca
   }
 }
 
-void BaseRenderer::createImageViews() {
-  for (const auto swapChainImage : swapChainImages) {
-    vk::ImageViewCreateInfo createInfo;
-    createInfo.image = swapChainImage;
-    createInfo.viewType = vk::ImageViewType::e2D;
-    createInfo.format = swapChainImageFormat;
-    createInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-    createInfo.subresourceRange.baseMipLevel = 0;
-    createInfo.subresourceRange.levelCount = 1;
-    createInfo.subresourceRange.baseArrayLayer = 0;
-    createInfo.subresourceRange.layerCount = 1;
-    swapChainImageViews.emplace_back(device, createInfo);
-  }
-}
+void BaseRenderer::createGraphicsPipeline() {
+  vk::PipelineLayoutCreateInfo pipelineLayoutInfo = getPipelineLayoutInfo();
 
-void BaseRenderer::createRenderPass() {
-  vk::AttachmentDescription colorAttachment;
-  colorAttachment.format = swapChainImageFormat;
-  colorAttachment.loadOp = vk::AttachmentLoadOp::eClear;
-  colorAttachment.storeOp = vk::AttachmentStoreOp::eStore;
-  colorAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
-  colorAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-  colorAttachment.finalLayout = vk::ImageLayout::ePresentSrcKHR;
+  pipelineLayout = vk::raii::PipelineLayout(device, pipelineLayoutInfo);
 
-  vk::AttachmentDescription depthAttachment;
-  depthAttachment.format = findDepthFormat();
-  depthAttachment.loadOp = vk::AttachmentLoadOp::eClear;
-  depthAttachment.storeOp = vk::AttachmentStoreOp::eDontCare;
-  depthAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
-  depthAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-  depthAttachment.finalLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
-
-  vk::AttachmentReference colorAttachmentRef;
-  colorAttachmentRef.attachment = 0;
-  colorAttachmentRef.layout = vk::ImageLayout::eColorAttachmentOptimal;
-
-  vk::AttachmentReference depthAttachmentRef;
-  depthAttachmentRef.attachment = 1;
-  depthAttachmentRef.layout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
-
-  vk::SubpassDescription subpass;
-  subpass.colorAttachmentCount = 1;
-  subpass.pColorAttachments = &colorAttachmentRef;
-  subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-  vk::SubpassDependency dependency;
-  dependency.srcSubpass = vk::SubpassExternal;
-  dependency.dstSubpass = 0;
-  dependency.srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-  dependency.srcAccessMask = vk::AccessFlagBits::eNone;
-  dependency.dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-  dependency.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
-
-  const std::array attachments = {colorAttachment, depthAttachment};
-  vk::RenderPassCreateInfo renderPassInfo;
-  renderPassInfo.attachmentCount = attachments.size();
-  renderPassInfo.pAttachments = attachments.data();
-  renderPassInfo.subpassCount = 1;
-  renderPassInfo.pSubpasses = &subpass;
-  renderPassInfo.dependencyCount = 1;
-  renderPassInfo.pDependencies = &dependency;
-
-  renderPass = vk::raii::RenderPass(device, renderPassInfo);
+  GraphicsPipelineDescription description;
+  description.vertexShader = "shaders/shader.vert.spv";
+  description.fragmentShader = "shaders/shader.frag.spv";
+  description.bindings = {getVertexBindingDescription()};
+  description.attributes = getVertexAttributeDescription();
+
+  graphicsPipeline = createGraphicsPipeline(description);
 }
 
-void BaseRenderer::createGraphicsPipeline() {
-  auto vertShaderCode = files::readFile("shaders/shader.vert.spv");
-  auto fragShaderCode = files::readFile("shaders/shader.frag.spv");
+/**
+ * Create a pipeline for the main render pass, using pipelineLayout unless the description has its
+ * own layout
+ */
+vk::raii::Pipeline
+BaseRenderer::createGraphicsPipeline(const GraphicsPipelineDescription &description) const {
+  auto vertShaderCode = files::readFile(description.vertexShader);
+  auto fragShaderCode = files::readFile(description.fragmentShader);
 
   vk::raii::ShaderModule vertShaderModule = createShaderModule(vertShaderCode);
   vk::raii::ShaderModule fragShaderModule = createShaderModule(fragShaderCode);
@@ -482,14 +506,12 @@ void BaseRenderer::createGraphicsPipeline() {
 
   vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
 
-  auto bindingDescription = getVertexBindingDescription();
-  auto attributeDescriptions = getVertexAttributeDescription();
-
-  vertexInputInfo.vertexBindingDescriptionCount = 1;
+  vertexInputInfo.vertexBindingDescriptionCount =
+      static_cast<uint32_t>(description.bindings.size());
   vertexInputInfo.vertexAttributeDescriptionCount =
-      static_cast<uint32_t>(attributeDescriptions.size());
-  vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-  vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+      static_cast<uint32_t>(description.attributes.size());
+  vertexInputInfo.pVertexBindingDescriptions = description.bindings.data();
+  vertexInputInfo.pVertexAttributeDescriptions = description.attributes.data();
 
   vk::PipelineInputAssemblyStateCreateInfo inputAssembly;
   inputAssembly.topology = vk::PrimitiveTopology::eTriangleList;
@@ -537,10 +559,6 @@ void BaseRenderer::createGraphicsPipeline() {
   dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
   dynamicState.pDynamicStates = dynamicStates.data();
 
-  vk::PipelineLayoutCreateInfo pipelineLayoutInfo = getPipelineLayoutInfo();
-
-  pipelineLayout = vk::raii::PipelineLayout(device, pipelineLayoutInfo);
-
   vk::GraphicsPipelineCreateInfo pipelineInfo;
   pipelineInfo.stageCount = 2;
   pipelineInfo.pStages = shaderStages.data();
@@ -552,18 +570,24 @@ void BaseRenderer::createGraphicsPipeline() {
   pipelineInfo.pDepthStencilState = &depthStencil;
   pipelineInfo.pColorBlendState = &colorBlending;
   pipelineInfo.pDynamicState = &dynamicState;
-  pipelineInfo.layout = *pipelineLayout;
-  pipelineInfo.renderPass = *renderPass;
-  pipelineInfo.subpass = 0;
+  pipelineInfo.layout = description.layout ? description.layout : *pipelineLayout;
   pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-  graphicsPipeline = vk::raii::Pipeline(device, nullptr, pipelineInfo);
+  vk::PipelineRenderingCreateInfoKHR renderingInfo;
+  renderingInfo.colorAttachmentCount = 1;
+  renderingInfo.pColorAttachmentFormats = &swapChainImageFormat;
+  renderingInfo.depthAttachmentFormat = depthFormat;
+  pipelineInfo.pNext = &renderingInfo;
+
+  return vk::raii::Pipeline(device, nullptr, pipelineInfo);
 }
 
 vk::PipelineLayoutCreateInfo BaseRenderer::getPipelineLayoutInfo() const {
   vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
   pipelineLayoutInfo.setLayoutCount = 0;
   pipelineLayoutInfo.pSetLayouts = nullptr;
+  pipelineLayoutInfo.pushConstantRangeCount = 1;
+  pipelineLayoutInfo.pPushConstantRanges = &CAMERA_PUSH_CONSTANT_RANGE;
   return pipelineLayoutInfo;
 }
 
@@ -574,10 +598,10 @@ vk::PipelineLayoutCreateInfo BaseRenderer::getComputePipelineLayoutInfo() const
   return pipelineLayoutInfo;
 }
 
-vk::raii::ShaderModule BaseRenderer::createShaderModule(const cmrc::file &code) {
+vk::raii::ShaderModule BaseRenderer::createShaderModule(std::span<const char> code) const {
   vk::ShaderModuleCreateInfo createInfo;
   createInfo.codeSize = code.size();
-  createInfo.pCode = reinterpret_cast<const uint32_t *>(code.begin());
+  createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
 
   return {device, createInfo};
 }
@@ -603,20 +627,22 @@ void BaseRenderer::createComputePipeline() {
   computePipeline = vk::raii::Pipeline(device, nullptr, pipelineInfo);
 }
 
-void BaseRenderer::createFramebuffers() {
-
-  for (const auto &swapChainImageView : swapChainImageViews) {
-    std::vector<vk::ImageView> attachments = {*swapChainImageView, *depthImageView};
-
-    vk::FramebufferCreateInfo framebufferInfo;
-    framebufferInfo.renderPass = *renderPass;
-    framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-    framebufferInfo.pAttachments = attachments.data();
-    framebufferInfo.width = swapChainExtent.width;
-    framebufferInfo.height = swapChainExtent.height;
-    framebufferInfo.layers = 1;
-    swapChainFramebuffers.emplace_back(device, framebufferInfo);
+void BaseRenderer::createSceneResources() {
+  if (drawToSwapChain) {
+    return;
   }
+  createImage(swapChainExtent.width, swapChainExtent.height, swapChainImageFormat,
+              vk::ImageTiling::eOptimal,
+              vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+              vk::MemoryPropertyFlagBits::eDeviceLocal, sceneImage, sceneImageMemory);
+  sceneImageView =
+      createImageView(*sceneImage, swapChainImageFormat, vk::ImageAspectFlagBits::eColor);
+
+  // Without blits, the scene can only be copied at full resolution
+  const vk::FormatFeatureFlags features =
+      physicalDevice.getFormatProperties(swapChainImageFormat).optimalTilingFeatures;
+  sceneBlitSupported = (features & vk::FormatFeatureFlagBits::eBlitSrc) &&
+                       (features & vk::FormatFeatureFlagBits::eBlitDst);
 }
 
 void BaseRenderer::createCommandPool() {
@@ -627,31 +653,73 @@ void BaseRenderer::createCommandPool() {
   poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsAndComputeFamily.value();
 
   commandPool = vk::raii::CommandPool(device, poolInfo);
+
+  poolInfo.queueFamilyIndex = queueFamilyIndices.computeFamily.value();
+  computeCommandPool = vk::raii::CommandPool(device, poolInfo);
+
+  if (queueFamilyIndices.hasDedicatedTransfer()) {
+    poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.transferFamily.value();
+    transferCommandPool = vk::raii::CommandPool(device, poolInfo);
+  }
 }
 
-void BaseRenderer::copyBuffer(vk::Buffer srcBuffer, vk::Buffer dstBuffer,
-                              vk::DeviceSize size) const {
-  const vk::raii::CommandBuffer commandBuffer = beginSingleTimeCommands();
+void BaseRenderer::copyBuffer(Buffer stagingBuffer, vk::Buffer dstBuffer,
+                              bool sharedBetweenQueues) {
+  const bool dedicatedTransfer = queueFamilies.hasDedicatedTransfer();
+  vk::CommandBufferAllocateInfo allocInfo;
+  allocInfo.commandPool = dedicatedTransfer ? *transferCommandPool : *commandPool;
+  allocInfo.commandBufferCount = 1;
+  vk::raii::CommandBuffer copyCommandBuffer(
+      std::move(vk::raii::CommandBuffers(device, allocInfo)[0]));
 
+  vk::CommandBufferBeginInfo beginInfo;
+  beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+  copyCommandBuffer.begin(beginInfo);
   vk::BufferCopy copyRegion;
-  copyRegion.size = size;
-  commandBuffer.copyBuffer(srcBuffer, dstBuffer, copyRegion);
+  copyRegion.size = stagingBuffer.getSize();
+  copyCommandBuffer.copyBuffer(stagingBuffer.getBuffer(), dstBuffer, copyRegion);
+
+  if (dedicatedTransfer && !sharedBetweenQueues) {
+    // Released by the transfer queue, then acquired by the graphics queue in the next frame
+    vk::BufferMemoryBarrier ownershipTransfer;
+    ownershipTransfer.srcQueueFamilyIndex = queueFamilies.transferFamily.value();
+    ownershipTransfer.dstQueueFamilyIndex = queueFamilies.graphicsAndComputeFamily.value();
+    ownershipTransfer.buffer = dstBuffer;
+    ownershipTransfer.offset = 0;
+    ownershipTransfer.size = copyRegion.size;
+
+    ownershipTransfer.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    copyCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                      vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr,
+                                      ownershipTransfer, nullptr);
+    ownershipTransfer.srcAccessMask = {};
+    ownershipTransfer.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+    unsignalledAcquires.push_back(ownershipTransfer);
+  }
+  copyCommandBuffer.end();
 
-  endSingleTimeCommands(*commandBuffer);
+  vk::raii::Fence fence(device, vk::FenceCreateInfo{});
+  vk::SubmitInfo submitInfo;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &*copyCommandBuffer;
+  getUploadQueue().submit(submitInfo, *fence);
+
+  pendingUploads.push_back(
+      {std::move(stagingBuffer), std::move(copyCommandBuffer), std::move(fence)});
+  uploadsUnsignalled = true;
 }
 
 void BaseRenderer::createDescriptorPool() {
-  std::array<vk::DescriptorPoolSize, 2> poolSizes;
-  poolSizes[0].type = vk::DescriptorType::eUniformBuffer;
-  poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-
-  poolSizes[1].type = vk::DescriptorType::eCombinedImageSampler;
-  poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+  // A single set holding the textures, the camera is pushed and does not change between frames
+  std::array<vk::DescriptorPoolSize, 1> poolSizes;
+  poolSizes[0].type = vk::DescriptorType::eCombinedImageSampler;
+  poolSizes[0].descriptorCount = 1;
 
   vk::DescriptorPoolCreateInfo poolInfo;
   poolInfo.poolSizeCount = poolSizes.size();
   poolInfo.pPoolSizes = poolSizes.data();
-  poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+  poolInfo.maxSets = 1;
   poolInfo.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
 
   descriptorPool = vk::raii::DescriptorPool(device, poolInfo);
@@ -660,14 +728,42 @@ void BaseRenderer::createDescriptorPool() {
 void BaseRenderer::createCommandBuffers() {
   vk::CommandBufferAllocateInfo allocInfo;
   allocInfo.commandPool = *commandPool;
-  allocInfo.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
+  allocInfo.commandBufferCount = latencyConfig.framesInFlight;
 
   mainCommandBuffers = vk::raii::CommandBuffers(device, allocInfo);
 }
 
+void BaseRenderer::createRecordingStreams() {
+  // The main thread records a stream too while it waits on the workers
+  if (!recordingJobs) {
+    recordingStreamCount = std::min(JobSystem::defaultThreadCount() + 1, MAX_RECORDING_STREAMS);
+    recordingJobs.emplace(recordingStreamCount - 1);
+  }
+
+  const QueueFamilyIndices queueFamilyIndices = findQueueFamilies(*physicalDevice);
+  vk::CommandPoolCreateInfo poolInfo;
+  // Reset as a whole before recording, once the frame using it is done
+  poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+  poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsAndComputeFamily.value();
+
+  const uint32_t streamCount = latencyConfig.framesInFlight * recordingStreamCount;
+  recordingStreams.clear();
+  recordingStreams.reserve(streamCount);
+  for (uint32_t i = 0; i < streamCount; ++i) {
+    RecordingStream &stream = recordingStreams.emplace_back();
+    stream.pool = vk::raii::CommandPool(device, poolInfo);
+
+    vk::CommandBufferAllocateInfo allocInfo;
+    allocInfo.commandPool = *stream.pool;
+    allocInfo.level = vk::CommandBufferLevel::eSecondary;
+    allocInfo.commandBufferCount = 1;
+    stream.commandBuffer = std::move(vk::raii::CommandBuffers(device, allocInfo)[0]);
+  }
+}
+
 void BaseRenderer::createComputeCommandBuffers() {
   vk::CommandBufferAllocateInfo allocInfo;
-  allocInfo.commandPool = *commandPool;
+  allocInfo.commandPool = *computeCommandPool;
   allocInfo.commandBufferCount = 1;
 
   auto computeCommandBuffers = vk::raii::CommandBuffers(device, allocInfo);
@@ -680,22 +776,130 @@ void BaseRenderer::createSyncObjects() {
   vk::FenceCreateInfo fenceInfo;
   fenceInfo.flags = vk::FenceCreateFlagBits::eSignaled;
 
-  for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    imageAvailableSemaphores[i] = vk::raii::Semaphore(device, semaphoreInfo);
-    renderFinishedSemaphores[i] = vk::raii::Semaphore(device, semaphoreInfo);
-    inFlightFences[i] = vk::raii::Fence(device, fenceInfo);
-  }
   computeFinishedSemaphore = vk::raii::Semaphore(device, semaphoreInfo);
+  graphicsFinishedSemaphore = vk::raii::Semaphore(device, semaphoreInfo);
+  transferFinishedSemaphore = vk::raii::Semaphore(device, semaphoreInfo);
   computeFence = vk::raii::Fence(device, fenceInfo);
 }
 
+void BaseRenderer::createFrameSyncObjects() {
+  constexpr vk::SemaphoreCreateInfo semaphoreInfo;
+
+  vk::FenceCreateInfo fenceInfo;
+  fenceInfo.flags = vk::FenceCreateFlagBits::eSignaled;
+
+  imageAvailableSemaphores.clear();
+  renderFinishedSemaphores.clear();
+  inFlightFences.clear();
+  for (uint32_t i = 0; i < latencyConfig.framesInFlight; i++) {
+    imageAvailableSemaphores.emplace_back(device, semaphoreInfo);
+    renderFinishedSemaphores.emplace_back(device, semaphoreInfo);
+    inFlightFences.emplace_back(device, fenceInfo);
+  }
+}
+
+void BaseRenderer::createFrameTimestampQueries() {
+  const vk::PhysicalDeviceLimits limits = physicalDevice.getProperties().limits;
+  frameTimestampsWritten.assign(latencyConfig.framesInFlight, false);
+  frameTimestampQueries = nullptr;
+  if (!limits.timestampComputeAndGraphics) {
+    return;
+  }
+  timestampPeriodNs = limits.timestampPeriod;
+
+  vk::QueryPoolCreateInfo queryPoolInfo;
+  queryPoolInfo.queryType = vk::QueryType::eTimestamp;
+  queryPoolInfo.queryCount = 2 * latencyConfig.framesInFlight;
+  frameTimestampQueries = vk::raii::QueryPool(device, queryPoolInfo);
+}
+
+void BaseRenderer::createFrameResources() {
+  createCommandBuffers();
+  createRecordingStreams();
+  createFrameSyncObjects();
+  createFrameTimestampQueries();
+  captureSlots.clear();
+  captureSlots.resize(latencyConfig.framesInFlight);
+  initCustomFrameResources();
+}
+
 void BaseRenderer::draw() {
+  if (latencyConfig.lateInputSampling) {
+    manageFps();
+  }
   glfwPollEvents();
+  if (hotReloader) {
+    if (const ReloadedAssets reloaded = hotReloader->takeReloaded(); !reloaded.empty()) {
+      device.waitIdle();
+      reloadAssets(reloaded);
+      requestRedraw();
+    }
+  }
+  if (isMinimized()) {
+    // Nothing is visible, and the swap chain cannot be sized to an empty window
+    glfwWaitEventsTimeout(IDLE_EVENT_TIMEOUT_S);
+    return;
+  }
+  if (renderOnDemand && !redrawRequested && !camera.isMoving() && !isAnimating()) {
+    // The previous frame stays on screen, neither compute nor graphics work is submitted
+    glfwWaitEventsTimeout(IDLE_EVENT_TIMEOUT_S);
+    return;
+  }
+  redrawRequested = false;
   drawFrame();
-  manageFps();
+  if (!latencyConfig.lateInputSampling) {
+    manageFps();
+  }
   printFps();
 }
 
+void BaseRenderer::enableHotReload(HotReloadConfig config) {
+  hotReloader = std::make_unique<HotReloader>(std::move(config));
+}
+
+void BaseRenderer::setRenderOnDemand(bool enabled) {
+  renderOnDemand = enabled;
+  redrawRequested = true;
+}
+
+void BaseRenderer::requestRedraw() { redrawRequested = true; }
+
+void BaseRenderer::setLatencyConfig(const LatencyConfig &config) {
+  const uint32_t previousFramesInFlight = latencyConfig.framesInFlight;
+  latencyConfig = config;
+  latencyConfig.framesInFlight =
+      std::clamp<uint32_t>(config.framesInFlight, 1, MAX_FRAMES_IN_FLIGHT);
+  if (*device) {
+    device.waitIdle();
+    if (latencyConfig.framesInFlight != previousFramesInFlight) {
+      collectAllCaptures();
+      createFrameResources();
+    }
+    currentFrame = 0;
+    recreateSwapChain();
+    // Frames are counted per frame in flight, which were just reset
+    retiredSwapChains.clear();
+  }
+}
+
+void BaseRenderer::enableDynamicResolution(const ResolutionScalingConfig &config) {
+  resolutionScaler.emplace(config);
+  if (*device && drawToSwapChain) {
+    // The scene now needs its own target to be drawn at a lower resolution
+    recreateSwapChain();
+  }
+  requestRedraw();
+}
+
+void BaseRenderer::reloadAssets(const ReloadedAssets &assets) {
+  if (assets.hasShader("shaders/shader.vert.spv") || assets.hasShader("shaders/shader.frag.spv")) {
+    createGraphicsPipeline();
+  }
+  if (assets.hasShader("shaders/shader.comp.spv")) {
+    createComputePipeline();
+  }
+}
+
 void BaseRenderer::manageFps() {
   static double frameStartTime = 0;
 
@@ -716,6 +920,19 @@ void BaseRenderer::printFps() {
   fpsCount++;
   if (currentTime - lastFpsCountTime >= 1.0) {
     std::cout << "FPS: " << fpsCount << std::endl;
+    if (resolutionScaler) {
+      std::cout << "Resolution scale: " << resolutionScaler->getScale() << std::endl;
+    }
+    if (const LatencyReport report = latencyTracker.takeReport();
+        report.inputToSubmit.samples > 0) {
+      const auto print = [](const char *name, const LatencyPercentiles &latency) {
+        std::cout << name << " latency (ms) p50: " << latency.p50Ms << " p95: " << latency.p95Ms
+                  << " p99: " << latency.p99Ms << " over " << latency.samples << " frames"
+                  << std::endl;
+      };
+      print("Input to submit", report.inputToSubmit);
+      print("Input to present", report.inputToPresent);
+    }
 
     lastFpsCountTime = currentTime;
     fpsCount = 0;
@@ -723,9 +940,10 @@ void BaseRenderer::printFps() {
 }
 
 void BaseRenderer::drawFrame() {
+  PLAXEL_TRACE_SCOPE("drawFrame");
   vk::SubmitInfo submitInfo;
 
-  updateUniformBuffer(currentFrame);
+  updateCamera();
 
   // Compute submission
   waitForFence(*computeFence);
@@ -740,13 +958,43 @@ void BaseRenderer::drawFrame() {
   submitInfo.signalSemaphoreCount = 1;
   submitInfo.pSignalSemaphores = &*computeFinishedSemaphore;
 
-  computeQueue.submit(submitInfo, *computeFence);
+  std::vector<vk::Semaphore> computeWaitSemaphores;
+  std::vector<vk::PipelineStageFlags> computeWaitStages;
+  // The pass overwrites buffers read by the previous frame
+  if (graphicsFinishedPending) {
+    computeWaitSemaphores.push_back(*graphicsFinishedSemaphore);
+    computeWaitStages.emplace_back(vk::PipelineStageFlagBits::eTransfer |
+                                   vk::PipelineStageFlagBits::eComputeShader);
+    graphicsFinishedPending = false;
+  }
+  // Both passes read the uploads, the graphics one through its wait on the compute one
+  if (signalUploads()) {
+    computeWaitSemaphores.push_back(*transferFinishedSemaphore);
+    computeWaitStages.emplace_back(vk::PipelineStageFlagBits::eAllCommands);
+  }
+  submitInfo.waitSemaphoreCount = static_cast<uint32_t>(computeWaitSemaphores.size());
+  submitInfo.pWaitSemaphores = computeWaitSemaphores.data();
+  submitInfo.pWaitDstStageMask = computeWaitStages.data();
+
+  {
+    PLAXEL_TRACE_SCOPE("submitCompute");
+    computeQueue.submit(submitInfo, *computeFence);
+  }
 
   // Graphics submission
   waitForFence(*inFlightFences[currentFrame]);
-
-  auto [result, imageIndex] =
-      swapChain.acquireNextImage(FENCE_TIMEOUT, *imageAvailableSemaphores[currentFrame]);
+  releaseRetiredSwapChains();
+  releaseFinishedUploads();
+  collectFrameTimestamps();
+  collectCapture(currentFrame);
+
+  vk::Result result;
+  uint32_t imageIndex;
+  {
+    PLAXEL_TRACE_SCOPE("acquireNextImage");
+    std::tie(result, imageIndex) =
+        swapChain.acquireNextImage(FENCE_TIMEOUT, *imageAvailableSemaphores[currentFrame]);
+  }
   if (result == vk::Result::eErrorOutOfDateKHR) {
     recreateSwapChain();
     return;
@@ -756,13 +1004,23 @@ void BaseRenderer::drawFrame() {
 
   device.resetFences(*inFlightFences[currentFrame]);
 
+  {
+    PLAXEL_TRACE_SCOPE("prepareFrame");
+    prepareFrame(currentFrame);
+  }
+
   mainCommandBuffers[currentFrame].reset();
   recordCommandBuffer(*mainCommandBuffers[currentFrame], imageIndex);
 
   const std::vector waitSemaphores = {*computeFinishedSemaphore,
                                       *imageAvailableSemaphores[currentFrame]};
+  // Compute writes indirect draw arguments, vertices and storage buffers read by vertex shaders.
+  // The swap chain image is only written by the final copy of the scene, or by the scene itself.
   const std::vector<vk::PipelineStageFlags> waitStages = {
-      vk::PipelineStageFlagBits::eVertexInput, vk::PipelineStageFlagBits::eColorAttachmentOutput};
+      vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput |
+          vk::PipelineStageFlagBits::eVertexShader,
+      drawToSwapChain ? vk::PipelineStageFlagBits::eColorAttachmentOutput
+                      : vk::PipelineStageFlagBits::eTransfer};
   submitInfo = vk::SubmitInfo{};
 
   submitInfo.waitSemaphoreCount = static_cast<int32_t>(waitSemaphores.size());
@@ -770,10 +1028,18 @@ void BaseRenderer::drawFrame() {
   submitInfo.pWaitDstStageMask = waitStages.data();
   submitInfo.commandBufferCount = 1;
   submitInfo.pCommandBuffers = &*mainCommandBuffers[currentFrame];
-  submitInfo.signalSemaphoreCount = 1;
-  submitInfo.pSignalSemaphores = &*renderFinishedSemaphores[currentFrame];
-
-  graphicsQueue.submit(submitInfo, *inFlightFences[currentFrame]);
+  const std::array signalSemaphores = {*renderFinishedSemaphores[currentFrame],
+                                       *graphicsFinishedSemaphore};
+  submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+  submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+  {
+    PLAXEL_TRACE_SCOPE("submitGraphics");
+    graphicsQueue.submit(submitInfo, *inFlightFences[currentFrame]);
+  }
+  ++submittedFrameCount;
+  graphicsFinishedPending = true;
+  latencyTracker.frameSubmitted(LatencyTracker::Clock::now());
 
   vk::PresentInfoKHR presentInfo;
 
@@ -786,7 +1052,12 @@ void BaseRenderer::drawFrame() {
 
   presentInfo.pImageIndices = &imageIndex;
 
-  result = presentQueue.presentKHR(presentInfo);
+  {
+    PLAXEL_TRACE_SCOPE("present");
+    result = presentQueue.presentKHR(presentInfo);
+  }
+  // When the image is queued, the display time itself is not exposed by the core API
+  latencyTracker.framePresented(LatencyTracker::Clock::now());
 
   if (result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR ||
       framebufferResized) {
@@ -796,107 +1067,450 @@ void BaseRenderer::drawFrame() {
     throw VulkanDrawingError("failed to present swap chain image!");
   }
 
-  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+  currentFrame = (currentFrame + 1) % latencyConfig.framesInFlight;
 }
 void BaseRenderer::waitForFence(vk::Fence fence) const {
+  PLAXEL_TRACE_SCOPE("waitForFence");
   while (vk::Result::eTimeout == device.waitForFences({fence}, vk::True, FENCE_TIMEOUT))
     ;
 }
 
 void BaseRenderer::recreateSwapChain() {
-  int width = 0;
-  int height = 0;
-  glfwGetFramebufferSize(window, &width, &height);
-  while (width == 0 || height == 0) {
-    glfwGetFramebufferSize(window, &width, &height);
-    glfwWaitEvents();
+  if (isMinimized()) {
+    // Retried once the window is restored
+    framebufferResized = true;
+    return;
   }
 
-  device.waitIdle();
-
-  createSwapChain();
-  swapChainImageViews.clear();
-  createImageViews();
+  RetiredSwapChain &retired = retiredSwapChains.emplace_back();
+  retired.depthImageMemory = std::move(depthImageMemory);
+  retired.depthImage = std::move(depthImage);
+  retired.depthImageView = std::move(depthImageView);
+  retired.sceneImageMemory = std::move(sceneImageMemory);
+  retired.sceneImage = std::move(sceneImage);
+  retired.sceneImageView = std::move(sceneImageView);
+  retired.captureImageMemory = std::move(captureImageMemory);
+  retired.captureImage = std::move(captureImage);
+  retired.swapChainImageViews = std::move(swapChainImageViews);
+  retired.swapChain = std::move(swapChain);
+  retired.retiredAtFrame = submittedFrameCount;
+
+  createSwapChain(*retired.swapChain);
   createDepthResources();
-  swapChainFramebuffers.clear();
-  createFramebuffers();
+  createSceneResources();
+}
+
+void BaseRenderer::releaseRetiredSwapChains() {
+  while (!retiredSwapChains.empty() && areFramesDone(retiredSwapChains.front().retiredAtFrame)) {
+    retiredSwapChains.pop_front();
+  }
+}
+
+const vk::raii::Queue &BaseRenderer::getUploadQueue() const {
+  return queueFamilies.hasDedicatedTransfer() ? transferQueue : graphicsQueue;
+}
+
+bool BaseRenderer::signalUploads() {
+  if (!uploadsUnsignalled) {
+    return false;
+  }
+  // Signalled once every copy submitted before it on the queue is done
+  vk::SubmitInfo submitInfo;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores = &*transferFinishedSemaphore;
+  getUploadQueue().submit(submitInfo);
+  uploadsUnsignalled = false;
+  signalledAcquires.insert(signalledAcquires.end(), unsignalledAcquires.begin(),
+                           unsignalledAcquires.end());
+  unsignalledAcquires.clear();
+  return true;
+}
+
+void BaseRenderer::releaseFinishedUploads() {
+  while (!pendingUploads.empty() &&
+         device.waitForFences({*pendingUploads.front().fence}, vk::True, 0) ==
+             vk::Result::eSuccess) {
+    pendingUploads.pop_front();
+  }
+}
+
+void BaseRenderer::waitForUploads() const {
+  for (const PendingUpload &upload : pendingUploads) {
+    waitForFence(*upload.fence);
+  }
+}
+
+uint64_t BaseRenderer::getSubmittedFrameCount() const { return submittedFrameCount; }
+
+bool BaseRenderer::areFramesDone(const uint64_t frameCount) const {
+  // Waiting on the fence of the frame about to be drawn completes one more frame in flight. Once
+  // each of them did since the given count, every frame submitted before it is done.
+  return submittedFrameCount + 1 >= frameCount + latencyConfig.framesInFlight;
+}
+
+bool BaseRenderer::isMinimized() const {
+  int width = 0;
+  int height = 0;
+  glfwGetFramebufferSize(window, &width, &height);
+  return width == 0 || height == 0;
 }
 
 void BaseRenderer::recordCommandBuffer(const vk::CommandBuffer commandBuffer,
-                                       const uint32_t imageIndex) const {
+                                       const uint32_t imageIndex) {
+  PLAXEL_TRACE_SCOPE("recordCommandBuffer");
   constexpr vk::CommandBufferBeginInfo beginInfo;
 
   commandBuffer.begin(beginInfo);
 
-  vk::RenderPassBeginInfo renderPassInfo;
-  renderPassInfo.renderPass = *renderPass;
-  renderPassInfo.framebuffer = *swapChainFramebuffers[imageIndex];
-  renderPassInfo.renderArea.offset = vk::Offset2D{0, 0};
-  renderPassInfo.renderArea.extent = swapChainExtent;
+  const vk::Extent2D sceneExtent = getSceneExtent();
+  lastSceneExtent = sceneExtent;
+  lastImageIndex = imageIndex;
+  const bool capturing = nextFrameCapture || recording;
+  const bool timed = (resolutionScaler || Tracer::get().isCapturing()) && *frameTimestampQueries;
+  if (timed) {
+    commandBuffer.resetQueryPool(*frameTimestampQueries, 2 * currentFrame, 2);
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *frameTimestampQueries,
+                                 2 * currentFrame);
+  }
+  if (!signalledAcquires.empty()) {
+    // At the stages the submission waits on the compute pass, which itself waited on the copies
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                  vk::PipelineStageFlagBits::eDrawIndirect |
+                                      vk::PipelineStageFlagBits::eVertexInput |
+                                      vk::PipelineStageFlagBits::eVertexShader,
+                                  {}, nullptr, signalledAcquires, nullptr);
+    signalledAcquires.clear();
+  }
 
-  std::array<vk::ClearValue, 2> clearValues{};
-  clearValues[0].color = vk::ClearColorValue{0.0f, 0.0f, 0.0f, 1.0f};
-  clearValues[1].depthStencil = vk::ClearDepthStencilValue{1.0f, 0};
+  using enum vk::ImageLayout;
+  // Both attachments are shared by the frames in flight, the previous frame may still be copying
+  // the scene or testing against the depth. Neither keeps its content from one frame to the next.
+  std::array<vk::ImageMemoryBarrier, 2> attachmentBarriers;
+  for (vk::ImageMemoryBarrier &barrier : attachmentBarriers) {
+    barrier.oldLayout = eUndefined;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+  }
+  attachmentBarriers[0].newLayout = eColorAttachmentOptimal;
+  attachmentBarriers[0].image = drawToSwapChain ? swapChainImages[imageIndex] : *sceneImage;
+  attachmentBarriers[0].subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+  attachmentBarriers[0].srcAccessMask = vk::AccessFlagBits::eNone;
+  attachmentBarriers[0].dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+  attachmentBarriers[1].newLayout = eDepthStencilAttachmentOptimal;
+  attachmentBarriers[1].image = *depthImage;
+  attachmentBarriers[1].subresourceRange.aspectMask =
+      hasStencilComponent(depthFormat)
+          ? vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil
+          : vk::ImageAspectFlagBits::eDepth;
+  attachmentBarriers[1].srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+  attachmentBarriers[1].dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead |
+                                        vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+  // A swap chain image drawn to is acquired at the color output stage
+  commandBuffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eLateFragmentTests |
+          vk::PipelineStageFlagBits::eColorAttachmentOutput,
+      vk::PipelineStageFlagBits::eColorAttachmentOutput |
+          vk::PipelineStageFlagBits::eEarlyFragmentTests,
+      {}, nullptr, nullptr, attachmentBarriers);
+
+  vk::RenderingAttachmentInfoKHR colorAttachment;
+  colorAttachment.imageView =
+      drawToSwapChain ? *swapChainImageViews[imageIndex] : *sceneImageView;
+  colorAttachment.imageLayout = eColorAttachmentOptimal;
+  colorAttachment.loadOp = vk::AttachmentLoadOp::eClear;
+  colorAttachment.storeOp = vk::AttachmentStoreOp::eStore;
+  colorAttachment.clearValue.color = vk::ClearColorValue{0.0f, 0.0f, 0.0f, 1.0f};
 
-  renderPassInfo.clearValueCount = clearValues.size();
-  renderPassInfo.pClearValues = clearValues.data();
+  // Only needed while rendering, so that it never has to leave the tile memory
+  vk::RenderingAttachmentInfoKHR depthAttachment;
+  depthAttachment.imageView = *depthImageView;
+  depthAttachment.imageLayout = eDepthStencilAttachmentOptimal;
+  depthAttachment.loadOp = vk::AttachmentLoadOp::eClear;
+  depthAttachment.storeOp = vk::AttachmentStoreOp::eDontCare;
+  depthAttachment.clearValue.depthStencil = vk::ClearDepthStencilValue{1.0f, 0};
+
+  vk::RenderingInfoKHR renderingInfo;
+  renderingInfo.flags = vk::RenderingFlagBitsKHR::eContentsSecondaryCommandBuffers;
+  renderingInfo.renderArea.offset = vk::Offset2D{0, 0};
+  renderingInfo.renderArea.extent = sceneExtent;
+  renderingInfo.layerCount = 1;
+  renderingInfo.colorAttachmentCount = 1;
+  renderingInfo.pColorAttachments = &colorAttachment;
+  renderingInfo.pDepthAttachment = &depthAttachment;
+
+  commandBuffer.beginRenderingKHR(renderingInfo);
+  commandBuffer.executeCommands(recordDrawStreams(sceneExtent));
+  commandBuffer.endRenderingKHR();
+
+  // A swap chain image drawn to is presented as-is, unless it is read back first
+  const bool presentScene = drawToSwapChain && !capturing;
+  vk::ImageMemoryBarrier sceneBarrier = attachmentBarriers[0];
+  sceneBarrier.oldLayout = eColorAttachmentOptimal;
+  sceneBarrier.newLayout = presentScene ? ePresentSrcKHR : eTransferSrcOptimal;
+  sceneBarrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+  sceneBarrier.dstAccessMask =
+      presentScene ? vk::AccessFlagBits::eNone : vk::AccessFlagBits::eTransferRead;
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                presentScene ? vk::PipelineStageFlagBits::eBottomOfPipe
+                                             : vk::PipelineStageFlagBits::eTransfer,
+                                {}, nullptr, nullptr, sceneBarrier);
+
+  // The upscaling cost does not depend on the scene resolution
+  if (timed) {
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *frameTimestampQueries,
+                                 2 * currentFrame + 1);
+  }
+  frameTimestampsWritten[currentFrame] = timed;
+  if (!drawToSwapChain) {
+    blitSceneToSwapChain(commandBuffer, imageIndex, sceneExtent);
+  }
 
-  commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+  if (capturing) {
+    CaptureSlot &slot = captureSlots[currentFrame];
+    if (!slot.readback || slot.extent != swapChainExtent) {
+      slot.readback.emplace(createCaptureBuffer());
+      slot.extent = swapChainExtent;
+    }
+    recordCapture(commandBuffer, drawToSwapChain ? swapChainImages[imageIndex] : *sceneImage,
+                  *slot.readback);
+    slot.imagePath = std::exchange(nextFrameCapture, std::nullopt);
+    slot.sequence = recording;
+  }
+  if (drawToSwapChain && capturing) {
+    sceneBarrier.oldLayout = eTransferSrcOptimal;
+    sceneBarrier.newLayout = ePresentSrcKHR;
+    sceneBarrier.srcAccessMask = vk::AccessFlagBits::eNone;
+    sceneBarrier.dstAccessMask = vk::AccessFlagBits::eNone;
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, nullptr,
+                                  sceneBarrier);
+  }
+  commandBuffer.end();
+}
 
-  commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *graphicsPipeline);
+void BaseRenderer::blitSceneToSwapChain(vk::CommandBuffer commandBuffer, uint32_t imageIndex,
+                                        const vk::Extent2D &sceneExtent) const {
+  using enum vk::ImageLayout;
+  const vk::Image swapChainImage = swapChainImages[imageIndex];
 
+  vk::ImageMemoryBarrier barrier;
+  barrier.oldLayout = eUndefined;
+  barrier.newLayout = eTransferDstOptimal;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = swapChainImage;
+  barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.layerCount = 1;
+  barrier.srcAccessMask = vk::AccessFlagBits::eNone;
+  barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr,
+                                barrier);
+
+  const vk::ImageSubresourceLayers layers{vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+  if (sceneExtent == swapChainExtent) {
+    // Exact and cheaper than a blit
+    vk::ImageCopy copy;
+    copy.srcSubresource = layers;
+    copy.dstSubresource = layers;
+    copy.extent = vk::Extent3D{swapChainExtent, 1};
+    commandBuffer.copyImage(*sceneImage, eTransferSrcOptimal, swapChainImage,
+                            eTransferDstOptimal, copy);
+  } else {
+    vk::ImageBlit blit;
+    blit.srcSubresource = layers;
+    blit.srcOffsets[1] = vk::Offset3D{static_cast<int32_t>(sceneExtent.width),
+                                      static_cast<int32_t>(sceneExtent.height), 1};
+    blit.dstSubresource = layers;
+    blit.dstOffsets[1] = vk::Offset3D{static_cast<int32_t>(swapChainExtent.width),
+                                      static_cast<int32_t>(swapChainExtent.height), 1};
+    commandBuffer.blitImage(*sceneImage, eTransferSrcOptimal, swapChainImage,
+                            eTransferDstOptimal, blit, vk::Filter::eLinear);
+  }
+
+  barrier.oldLayout = eTransferDstOptimal;
+  barrier.newLayout = ePresentSrcKHR;
+  barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+  barrier.dstAccessMask = vk::AccessFlagBits::eNone;
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, nullptr,
+                                barrier);
+}
+
+void BaseRenderer::collectFrameTimestamps() {
+  if (!frameTimestampsWritten[currentFrame]) {
+    return;
+  }
+  frameTimestampsWritten[currentFrame] = false;
+  const auto [result, timestamps] = frameTimestampQueries.getResults<uint64_t>(
+      2 * currentFrame, 2, 2 * sizeof(uint64_t), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+  if (result != vk::Result::eSuccess) {
+    return;
+  }
+  if (resolutionScaler) {
+    resolutionScaler->frameMeasured(static_cast<double>(timestamps[1] - timestamps[0]) *
+                                    timestampPeriodNs / 1e6);
+  }
+  if (Tracer::get().isCapturing()) {
+    Tracer::get().recordGpu("scene", toCpuTime(timestamps[0]), toCpuTime(timestamps[1]));
+  }
+}
+
+void BaseRenderer::calibrateGpuClock() {
+  vk::QueryPoolCreateInfo queryPoolInfo;
+  queryPoolInfo.queryType = vk::QueryType::eTimestamp;
+  queryPoolInfo.queryCount = 1;
+  const vk::raii::QueryPool queryPool(device, queryPoolInfo);
+
+  const vk::raii::CommandBuffer commandBuffer = beginSingleTimeCommands();
+  commandBuffer.resetQueryPool(*queryPool, 0, 1);
+  commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *queryPool, 0);
+  const auto submitTime = Tracer::Clock::now();
+  endSingleTimeCommands(*commandBuffer);
+  const auto idleTime = Tracer::Clock::now();
+
+  const auto [result, timestamps] = queryPool.getResults<uint64_t>(
+      0, 1, sizeof(uint64_t), sizeof(uint64_t),
+      vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+  // The timestamp is written somewhere between the submission and the queue going idle, which is
+  // close enough to line GPU ranges up with the CPU scopes waiting on them
+  const std::chrono::duration<double, std::nano> sinceOrigin(static_cast<double>(timestamps[0]) *
+                                                             timestampPeriodNs);
+  gpuClockOrigin = submitTime + (idleTime - submitTime) / 2 -
+                   std::chrono::duration_cast<Tracer::Clock::duration>(sinceOrigin);
+}
+
+Tracer::Clock::time_point BaseRenderer::toCpuTime(uint64_t timestamp) const {
+  const std::chrono::duration<double, std::nano> elapsed(static_cast<double>(timestamp) *
+                                                         timestampPeriodNs);
+  return gpuClockOrigin + std::chrono::duration_cast<Tracer::Clock::duration>(elapsed);
+}
+
+vk::Extent2D BaseRenderer::getSceneExtent() const {
+  if (!resolutionScaler || !sceneBlitSupported || drawToSwapChain) {
+    return swapChainExtent;
+  }
+  const auto scaled = [scale = resolutionScaler->getScale()](uint32_t size) {
+    return std::clamp(static_cast<uint32_t>(std::lround(static_cast<float>(size) * scale)), 1u,
+                      size);
+  };
+  return {scaled(swapChainExtent.width), scaled(swapChainExtent.height)};
+}
+
+std::vector<vk::CommandBuffer> BaseRenderer::recordDrawStreams(const vk::Extent2D &sceneExtent) {
+  vk::CommandBufferInheritanceRenderingInfoKHR renderingInfo;
+  renderingInfo.colorAttachmentCount = 1;
+  renderingInfo.pColorAttachmentFormats = &swapChainImageFormat;
+  renderingInfo.depthAttachmentFormat = depthFormat;
+  renderingInfo.rasterizationSamples = vk::SampleCountFlagBits::e1;
+
+  vk::CommandBufferInheritanceInfo inheritanceInfo;
+  inheritanceInfo.pNext = &renderingInfo;
+
+  vk::CommandBufferBeginInfo beginInfo;
+  beginInfo.flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue |
+                    vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+  beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+  // Secondary command buffers inherit none of the state of the primary one
   vk::Viewport viewport;
   viewport.x = 0.0f;
   viewport.y = 0.0f;
-  viewport.width = static_cast<float>(swapChainExtent.width);
-  viewport.height = static_cast<float>(swapChainExtent.height);
+  viewport.width = static_cast<float>(sceneExtent.width);
+  viewport.height = static_cast<float>(sceneExtent.height);
   viewport.minDepth = 0.0f;
   viewport.maxDepth = 1.0f;
-  commandBuffer.setViewport(0, viewport);
 
   vk::Rect2D scissor;
   scissor.offset = vk::Offset2D{0, 0};
-  scissor.extent = swapChainExtent;
-  commandBuffer.setScissor(0, scissor);
+  scissor.extent = sceneExtent;
+
+  std::vector<vk::CommandBuffer> commandBuffers(recordingStreamCount);
+  recordingJobs->parallelFor(recordingStreamCount, 1, [&](size_t begin, size_t end) {
+    for (size_t stream = begin; stream < end; ++stream) {
+      PLAXEL_TRACE_SCOPE("recordDrawStream");
+      const RecordingStream &recording =
+          recordingStreams[currentFrame * recordingStreamCount + stream];
+      recording.pool.reset();
+
+      const vk::CommandBuffer commandBuffer = *recording.commandBuffer;
+      commandBuffer.begin(beginInfo);
+      commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *graphicsPipeline);
+      // Kept by the pipelines sharing the main layout
+      pushCamera(commandBuffer, *pipelineLayout);
+      commandBuffer.setViewport(0, viewport);
+      commandBuffer.setScissor(0, scissor);
+
+      drawCommand(commandBuffer, static_cast<uint32_t>(stream), recordingStreamCount);
+
+      commandBuffer.end();
+      commandBuffers[stream] = commandBuffer;
+    }
+  });
+  return commandBuffers;
+}
 
-  drawCommand(commandBuffer);
+void BaseRenderer::updateCamera() {
+  PLAXEL_TRACE_SCOPE("updateCamera");
+  camera.update();
 
-  commandBuffer.endRenderPass();
-  commandBuffer.end();
+  const glm::mat4 view = camera.getViewMatrix();
+  const glm::mat4 projection = glm::perspective(glm::radians(FIELD_OF_VIEW_Y_DEG),
+                                                static_cast<float>(swapChainExtent.width) /
+                                                    static_cast<float>(swapChainExtent.height),
+                                                0.001f, farPlane);
+  cameraConstants.viewProjection = projection * view;
+  // Rows of the view matrix are the camera axes in world space
+  cameraConstants.right = glm::vec4(view[0][0], view[1][0], view[2][0], 0.f);
+  cameraConstants.up = glm::vec4(view[0][1], view[1][1], view[2][1], 0.f);
 }
 
-void BaseRenderer::createUniformBuffers() {
-  vk::DeviceSize bufferSize = sizeof(UniformBufferObject);
-
-  for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    uniformBuffers.emplace_back(
-        device, physicalDevice, bufferSize, vk::BufferUsageFlagBits::eUniformBuffer,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-  }
+void BaseRenderer::pushCamera(vk::CommandBuffer commandBuffer, vk::PipelineLayout layout,
+                              const glm::vec3 &offset) const {
+  CameraPushConstants constants = cameraConstants;
+  constants.offset = glm::vec4(offset, 0.f);
+  commandBuffer.pushConstants(layout, CAMERA_PUSH_CONSTANT_RANGE.stageFlags, 0, sizeof(constants),
+                              &constants);
 }
 
-void BaseRenderer::updateUniformBuffer(uint32_t currentImage) {
-  camera.update();
+const Camera &BaseRenderer::getCamera() const { return camera; }
 
-  UniformBufferObject ubo{};
-  ubo.model = glm::mat4(1.0f);
+Camera &BaseRenderer::getCamera() { return camera; }
 
-  ubo.view = camera.getViewMatrix();
+float BaseRenderer::getPixelsPerUnitAtUnitDepth() const {
+  return static_cast<float>(swapChainExtent.height) / (2.0f * getTanHalfFieldOfView().y);
+}
 
-  ubo.proj = glm::perspective(glm::radians(45.0f),
-                              static_cast<float>(swapChainExtent.width) /
-                                  static_cast<float>(swapChainExtent.height),
-                              0.001f, 256.0f);
+glm::vec2 BaseRenderer::getTanHalfFieldOfView() const {
+  const float tanHalfY = std::tan(glm::radians(FIELD_OF_VIEW_Y_DEG) / 2.0f);
+  const float aspect =
+      static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height);
+  return {tanHalfY * aspect, tanHalfY};
+}
 
-  uniformBuffers[currentImage].copyToMemory(&ubo);
+void BaseRenderer::setFarPlane(float distance) {
+  farPlane = distance;
+  requestRedraw();
 }
 
 void BaseRenderer::createDepthResources() {
-  const vk::Format depthFormat = findDepthFormat();
-
-  createImage(swapChainExtent.width, swapChainExtent.height, depthFormat, vk::ImageTiling::eOptimal,
-              vk::ImageUsageFlagBits::eDepthStencilAttachment,
-              vk::MemoryPropertyFlagBits::eDeviceLocal, depthImage, depthImageMemory);
+  vk::ImageCreateInfo imageInfo;
+  imageInfo.imageType = vk::ImageType::e2D;
+  imageInfo.extent = vk::Extent3D{swapChainExtent, 1};
+  imageInfo.mipLevels = 1;
+  imageInfo.arrayLayers = 1;
+  imageInfo.format = depthFormat;
+  imageInfo.tiling = vk::ImageTiling::eOptimal;
+  // Never loaded nor stored, tile-based GPUs then only back it with memory when they run out of
+  // tile memory
+  imageInfo.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment |
+                    vk::ImageUsageFlagBits::eTransientAttachment;
+
+  createImage(imageInfo, vk::MemoryPropertyFlagBits::eDeviceLocal, depthImage, depthImageMemory,
+              vk::MemoryPropertyFlagBits::eLazilyAllocated);
   depthImageView = createImageView(*depthImage, depthFormat, vk::ImageAspectFlagBits::eDepth);
 }
 
@@ -907,6 +1521,10 @@ vk::Format BaseRenderer::findDepthFormat() const {
                              vk::FormatFeatureFlagBits::eDepthStencilAttachment);
 }
 
+bool BaseRenderer::hasStencilComponent(vk::Format format) {
+  return format == vk::Format::eD32SfloatS8Uint || format == vk::Format::eD24UnormS8Uint;
+}
+
 vk::Format BaseRenderer::findSupportedFormat(const std::vector<vk::Format> &candidates,
                                              vk::ImageTiling tiling,
                                              vk::FormatFeatureFlags features) const {
@@ -927,14 +1545,15 @@ vk::Format BaseRenderer::findSupportedFormat(const std::vector<vk::Format> &cand
 void BaseRenderer::createImage(uint32_t width, uint32_t height, vk::Format format,
                                vk::ImageTiling tiling, vk::ImageUsageFlags usage,
                                vk::MemoryPropertyFlags properties, vk::raii::Image &image,
-                               vk::raii::DeviceMemory &imageMemory) const {
+                               vk::raii::DeviceMemory &imageMemory, uint32_t arrayLayers,
+                               uint32_t mipLevels) const {
   vk::ImageCreateInfo imageInfo;
   imageInfo.imageType = vk::ImageType::e2D;
   imageInfo.extent.width = width;
   imageInfo.extent.height = height;
   imageInfo.extent.depth = 1;
-  imageInfo.mipLevels = 1;
-  imageInfo.arrayLayers = 1;
+  imageInfo.mipLevels = mipLevels;
+  imageInfo.arrayLayers = arrayLayers;
   imageInfo.format = format;
   imageInfo.tiling = tiling;
   imageInfo.usage = usage;
@@ -944,37 +1563,55 @@ void BaseRenderer::createImage(uint32_t width, uint32_t height, vk::Format forma
 
 void BaseRenderer::createImage(const vk::ImageCreateInfo &imageInfo,
                                const vk::MemoryPropertyFlags &properties, vk::raii::Image &image,
-                               vk::raii::DeviceMemory &imageMemory) const {
+                               vk::raii::DeviceMemory &imageMemory,
+                               const vk::MemoryPropertyFlags &preferredProperties) const {
   image = vk::raii::Image(device, imageInfo);
 
   const vk::MemoryRequirements memRequirements = image.getMemoryRequirements();
 
+  vk::MemoryPropertyFlags allocatedProperties = properties;
+  if (preferredProperties) {
+    const vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice.getMemoryProperties();
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+      const vk::MemoryPropertyFlags typeProperties = memProperties.memoryTypes[i].propertyFlags;
+      if ((memRequirements.memoryTypeBits & (1 << i)) &&
+          (typeProperties & (properties | preferredProperties)) ==
+              (properties | preferredProperties)) {
+        allocatedProperties |= preferredProperties;
+        break;
+      }
+    }
+  }
+
   vk::MemoryAllocateInfo allocInfo;
   allocInfo.allocationSize = memRequirements.size;
   allocInfo.memoryTypeIndex =
-      Buffer::findMemoryType(memRequirements.memoryTypeBits, properties, physicalDevice);
+      Buffer::findMemoryType(memRequirements.memoryTypeBits, allocatedProperties, physicalDevice);
 
   imageMemory = vk::raii::DeviceMemory(device, allocInfo);
   image.bindMemory(*imageMemory, 0);
 }
 
 vk::raii::ImageView BaseRenderer::createImageView(vk::Image image, vk::Format format,
-                                                  vk::ImageAspectFlags aspectFlags) {
+                                                  vk::ImageAspectFlags aspectFlags,
+                                                  vk::ImageViewType viewType,
+                                                  uint32_t layerCount, uint32_t levelCount) {
   vk::ImageViewCreateInfo viewInfo;
   viewInfo.image = image;
-  viewInfo.viewType = vk::ImageViewType::e2D;
+  viewInfo.viewType = viewType;
   viewInfo.format = format;
   viewInfo.subresourceRange.aspectMask = aspectFlags;
   viewInfo.subresourceRange.baseMipLevel = 0;
-  viewInfo.subresourceRange.levelCount = 1;
+  viewInfo.subresourceRange.levelCount = levelCount;
   viewInfo.subresourceRange.baseArrayLayer = 0;
-  viewInfo.subresourceRange.layerCount = 1;
+  viewInfo.subresourceRange.layerCount = layerCount;
 
   return {device, viewInfo};
 }
 
 void BaseRenderer::transitionImageLayout(vk::Image image, vk::ImageLayout oldLayout,
-                                         vk::ImageLayout newLayout) const {
+                                         vk::ImageLayout newLayout, uint32_t layerCount,
+                                         uint32_t levelCount) const {
   const vk::raii::CommandBuffer commandBuffer = beginSingleTimeCommands();
 
   vk::ImageMemoryBarrier barrier;
@@ -985,9 +1622,9 @@ void BaseRenderer::transitionImageLayout(vk::Image image, vk::ImageLayout oldLay
   barrier.image = image;
   barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
   barrier.subresourceRange.baseMipLevel = 0;
-  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.levelCount = levelCount;
   barrier.subresourceRange.baseArrayLayer = 0;
-  barrier.subresourceRange.layerCount = 1;
+  barrier.subresourceRange.layerCount = layerCount;
 
   barrier.srcAccessMask = accessFlagsForLayout(oldLayout);
   barrier.dstAccessMask = accessFlagsForLayout(newLayout);
@@ -1000,6 +1637,57 @@ void BaseRenderer::transitionImageLayout(vk::Image image, vk::ImageLayout oldLay
   endSingleTimeCommands(*commandBuffer);
 }
 
+void BaseRenderer::generateMipmaps(vk::Image image, uint32_t width, uint32_t height,
+                                   uint32_t mipLevels, uint32_t layerCount) const {
+  using enum vk::ImageLayout;
+  const vk::raii::CommandBuffer commandBuffer = beginSingleTimeCommands();
+
+  vk::ImageMemoryBarrier barrier;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = layerCount;
+  const auto transitionLevel = [&](uint32_t level, vk::ImageLayout oldLayout,
+                                   vk::ImageLayout newLayout) {
+    barrier.subresourceRange.baseMipLevel = level;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcAccessMask = accessFlagsForLayout(oldLayout);
+    barrier.dstAccessMask = accessFlagsForLayout(newLayout);
+    commandBuffer.pipelineBarrier(pipelineStageForLayout(oldLayout),
+                                  pipelineStageForLayout(newLayout), {}, nullptr, nullptr, barrier);
+  };
+
+  auto levelWidth = static_cast<int32_t>(width);
+  auto levelHeight = static_cast<int32_t>(height);
+  // Each level is blitted from the previous one, which is then done being written to
+  for (uint32_t level = 1; level < mipLevels; ++level) {
+    transitionLevel(level - 1, eTransferDstOptimal, eTransferSrcOptimal);
+
+    vk::ImageBlit blit;
+    blit.srcOffsets[1] = vk::Offset3D{levelWidth, levelHeight, 1};
+    blit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    blit.srcSubresource.mipLevel = level - 1;
+    blit.srcSubresource.layerCount = layerCount;
+    levelWidth = std::max(levelWidth / 2, 1);
+    levelHeight = std::max(levelHeight / 2, 1);
+    blit.dstOffsets[1] = vk::Offset3D{levelWidth, levelHeight, 1};
+    blit.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    blit.dstSubresource.mipLevel = level;
+    blit.dstSubresource.layerCount = layerCount;
+    commandBuffer.blitImage(image, eTransferSrcOptimal, image, eTransferDstOptimal, blit,
+                            vk::Filter::eLinear);
+
+    transitionLevel(level - 1, eTransferSrcOptimal, eShaderReadOnlyOptimal);
+  }
+  transitionLevel(mipLevels - 1, eTransferDstOptimal, eShaderReadOnlyOptimal);
+
+  endSingleTimeCommands(*commandBuffer);
+}
+
 vk::raii::CommandBuffer BaseRenderer::beginSingleTimeCommands() const {
   vk::CommandBufferAllocateInfo allocInfo;
   allocInfo.level = vk::CommandBufferLevel::ePrimary;
@@ -1024,122 +1712,242 @@ void BaseRenderer::endSingleTimeCommands(vk::CommandBuffer commandBuffer) const
   submitInfo.commandBufferCount = 1;
   submitInfo.pCommandBuffers = &commandBuffer;
 
+  // They may read buffers whose upload is still in flight
+  waitForUploads();
   graphicsQueue.submit(submitInfo);
   graphicsQueue.waitIdle();
 }
 
-void BaseRenderer::saveScreenshot(const char *filename) const {
-  bool supportsBlit = true;
-
-  // Check blit support for source and destination
-
-  // Get format properties for the swapchain color format
-  // Check if the device supports blitting from optimal images (the swapchain images are in optimal
-  // format)
-  vk::FormatProperties formatProps;
-  formatProps = physicalDevice.getFormatProperties(swapChainImageFormat);
-  if (!(formatProps.optimalTilingFeatures & vk::FormatFeatureFlagBits::eBlitSrc)) {
-    supportsBlit = false;
-  }
-
-  // Check if the device supports blitting to linear images
-  formatProps = physicalDevice.getFormatProperties(vk::Format::eR8G8B8A8Unorm);
-  if (!(formatProps.linearTilingFeatures & vk::FormatFeatureFlagBits::eBlitDst)) {
-    supportsBlit = false;
-  }
-
-  // Source for the copy is the last rendered swapchain image
-  // The current frame is not in use yet, so we can use it here
-  auto srcImage = swapChainImages[currentFrame];
-
-  // Create the linear tiled destination image to copy to and to read the memory from
-  vk::ImageCreateInfo imgCreateInfo;
-  imgCreateInfo.imageType = vk::ImageType::e2D;
-  // Note that vkCmdBlitImage (if supported) will also do format conversions if the swapchain color
-  // format would differ
-  imgCreateInfo.format = vk::Format::eR8G8B8A8Unorm;
-  imgCreateInfo.extent.width = windowSize.width;
-  imgCreateInfo.extent.height = windowSize.height;
-  imgCreateInfo.extent.depth = 1;
-  imgCreateInfo.arrayLayers = 1;
-  imgCreateInfo.mipLevels = 1;
-  imgCreateInfo.initialLayout = vk::ImageLayout::eUndefined;
-  imgCreateInfo.tiling = vk::ImageTiling::eLinear;
-  imgCreateInfo.usage = vk::ImageUsageFlagBits::eTransferDst;
-  // Create the image
-  // Memory must be host visible to copy from
-  vk::raii::Image dstImage = nullptr;
-  vk::raii::DeviceMemory dstImageMemory = nullptr;
-  createImage(imgCreateInfo,
-              vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-              dstImage, dstImageMemory);
-
-  // Do the actual blit from the swapchain image to our host visible destination image
-  // Transition destination image to transfer destination layout
-  transitionImageLayout(*dstImage, vk::ImageLayout::eUndefined,
-                        vk::ImageLayout::eTransferDstOptimal);
-  // Transition swapchain image from present to transfer source layout
-  transitionImageLayout(srcImage, vk::ImageLayout::ePresentSrcKHR,
-                        vk::ImageLayout::eTransferSrcOptimal);
-
-  const vk::raii::CommandBuffer &commandBuffer = beginSingleTimeCommands();
-  // If source and destination support blit we'll blit as this also does automatic format conversion
-  // (e.g. from BGR to RGB)
-  if (supportsBlit) {
-    // Define the region to blit (we will blit the whole swapchain image)
-    vk::Offset3D blitSize;
-    blitSize.x = static_cast<int32_t>(windowSize.width);
-    blitSize.y = static_cast<int32_t>(windowSize.height);
-    blitSize.z = 1;
-    vk::ImageBlit imageBlitRegion;
-    imageBlitRegion.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-    imageBlitRegion.srcSubresource.layerCount = 1;
-    imageBlitRegion.srcOffsets[1] = blitSize;
-    imageBlitRegion.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-    imageBlitRegion.dstSubresource.layerCount = 1;
-    imageBlitRegion.dstOffsets[1] = blitSize;
-
-    // Issue the blit command
-    commandBuffer.blitImage(srcImage, vk::ImageLayout::eTransferSrcOptimal, *dstImage,
-                            vk::ImageLayout::eTransferDstOptimal, imageBlitRegion,
-                            vk::Filter::eNearest);
+double BaseRenderer::measureGpuTime(const std::function<void(vk::CommandBuffer)> &record) const {
+  const vk::PhysicalDeviceLimits limits = physicalDevice.getProperties().limits;
+
+  vk::QueryPoolCreateInfo queryPoolInfo;
+  queryPoolInfo.queryType = vk::QueryType::eTimestamp;
+  queryPoolInfo.queryCount = 2;
+  const vk::raii::QueryPool queryPool(device, queryPoolInfo);
+
+  const vk::raii::CommandBuffer commandBuffer = beginSingleTimeCommands();
+  commandBuffer.resetQueryPool(*queryPool, 0, 2);
+  commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *queryPool, 0);
+  record(*commandBuffer);
+  commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *queryPool, 1);
+  const auto submitTime = std::chrono::steady_clock::now();
+  endSingleTimeCommands(*commandBuffer);
+
+  if (!limits.timestampComputeAndGraphics) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - submitTime)
+        .count();
+  }
+  const auto [result, timestamps] = queryPool.getResults<uint64_t>(
+      0, 2, 2 * sizeof(uint64_t), sizeof(uint64_t),
+      vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+  return static_cast<double>(timestamps[1] - timestamps[0]) * limits.timestampPeriod;
+}
+
+std::string BaseRenderer::getDeviceKey() const {
+  const vk::PhysicalDeviceProperties properties = physicalDevice.getProperties();
+  std::ostringstream key;
+  key << std::hex << properties.vendorID << '-' << properties.deviceID << '-'
+      << properties.driverVersion;
+  return key.str();
+}
+
+void BaseRenderer::saveScreenshot(const char *filename) {
+  using enum vk::ImageLayout;
+  // The scene of the last frame stays in its target until the next frame is drawn. Drawn directly
+  // to the swap chain, it is read back from the image that was presented.
+  Buffer readback = createCaptureBuffer();
+  const vk::raii::CommandBuffer commandBuffer = beginSingleTimeCommands();
+  if (drawToSwapChain) {
+    vk::ImageMemoryBarrier barrier;
+    barrier.oldLayout = ePresentSrcKHR;
+    barrier.newLayout = eTransferSrcOptimal;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapChainImages[lastImageIndex];
+    barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                  vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr,
+                                  barrier);
+    recordCapture(*commandBuffer, swapChainImages[lastImageIndex], readback);
+
+    barrier.oldLayout = eTransferSrcOptimal;
+    barrier.newLayout = ePresentSrcKHR;
+    barrier.srcAccessMask = vk::AccessFlagBits::eNone;
+    barrier.dstAccessMask = vk::AccessFlagBits::eNone;
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, nullptr,
+                                  barrier);
   } else {
-    throw NotImplementedError("only blit support should be necessary");
+    recordCapture(*commandBuffer, *sceneImage, readback);
   }
   endSingleTimeCommands(*commandBuffer);
 
-  // Transition destination image to general layout, which is the required layout for mapping the
-  // image memory later on
-  transitionImageLayout(*dstImage, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eGeneral);
-  // Transition back the swap chain image after the blit is done
-  transitionImageLayout(srcImage, vk::ImageLayout::eTransferSrcOptimal,
-                        vk::ImageLayout::ePresentSrcKHR);
+  CapturedFrame frame;
+  frame.width = swapChainExtent.width;
+  frame.height = swapChainExtent.height;
+  frame.pixels.resize(readback.getSize());
+  readback.copyFromMemory(frame.pixels.data(), frame.pixels.size());
+  getCaptureWriter().writeImage(filename, std::move(frame));
+  captureWriter->flush();
 
-  // Get layout of the image (including row pitch)
-  vk::SubresourceLayout subResourceLayout =
-      dstImage.getSubresourceLayout({vk::ImageAspectFlagBits::eColor});
+  std::cout << "Screenshot saved to disk" << std::endl;
+}
 
-  // Map image memory so we can start copying from it
-  auto *data = static_cast<char *>(dstImageMemory.mapMemory(0, vk::WholeSize));
-  data += subResourceLayout.offset;
+void BaseRenderer::captureNextFrame(std::string filename) {
+  nextFrameCapture = std::move(filename);
+  requestRedraw();
+}
 
-  std::ofstream file(filename, std::ios::out | std::ios::binary);
+void BaseRenderer::startRecording(const std::string &filename) {
+  stopRecording();
+  getCaptureWriter().openSequence(filename);
+  recording = true;
+}
 
-  // ppm header
-  file << "P6\n" << windowSize.width << "\n" << windowSize.height << "\n" << 255 << "\n";
+void BaseRenderer::stopRecording() {
+  if (!recording) {
+    return;
+  }
+  recording = false;
+  // The last frames recorded are still in flight
+  device.waitIdle();
+  collectAllCaptures();
+  captureWriter->closeSequence();
+}
 
-  // ppm binary pixel data
-  for (uint32_t y = 0; y < windowSize.height; y++) {
-    auto *row = reinterpret_cast<unsigned int *>(data);
-    for (uint32_t x = 0; x < windowSize.width; x++) {
-      file.write(reinterpret_cast<char *>(row), 3);
-      row++;
+void BaseRenderer::startTrace() {
+  if (*frameTimestampQueries) {
+    calibrateGpuClock();
+  }
+  Tracer::get().start();
+}
+
+void BaseRenderer::stopTrace(const char *filename) const {
+  Tracer::get().stop();
+  if (Tracer::get().saveChromeTrace(filename)) {
+    std::cout << "Trace saved to " << filename << std::endl;
+  } else {
+    std::cerr << "Failed to save trace to " << filename << std::endl;
+  }
+}
+
+void BaseRenderer::recordCapture(vk::CommandBuffer commandBuffer, vk::Image source,
+                                 const Buffer &readback) {
+  using enum vk::ImageLayout;
+  if (!*captureImage) {
+    // Both the source and the capture image are optimally tiled
+    if (!(physicalDevice.getFormatProperties(swapChainImageFormat).optimalTilingFeatures &
+          vk::FormatFeatureFlagBits::eBlitSrc) ||
+        !(physicalDevice.getFormatProperties(vk::Format::eR8G8B8A8Unorm).optimalTilingFeatures &
+          vk::FormatFeatureFlagBits::eBlitDst)) {
+      throw NotImplementedError("only blit support should be necessary");
     }
-    data += subResourceLayout.rowPitch;
+    createImage(swapChainExtent.width, swapChainExtent.height, vk::Format::eR8G8B8A8Unorm,
+                vk::ImageTiling::eOptimal,
+                vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc,
+                vk::MemoryPropertyFlagBits::eDeviceLocal, captureImage, captureImageMemory);
   }
-  file.close();
 
-  std::cout << "Screenshot saved to disk" << std::endl;
+  vk::ImageMemoryBarrier barrier;
+  barrier.oldLayout = eUndefined;
+  barrier.newLayout = eTransferDstOptimal;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = *captureImage;
+  barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.layerCount = 1;
+  barrier.srcAccessMask = vk::AccessFlagBits::eNone;
+  barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr,
+                                barrier);
+
+  // Blits convert from the format of the swap chain, e.g. from BGR to RGB
+  const vk::ImageSubresourceLayers layers{vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+  vk::ImageBlit blit;
+  blit.srcSubresource = layers;
+  blit.srcOffsets[1] = vk::Offset3D{static_cast<int32_t>(lastSceneExtent.width),
+                                    static_cast<int32_t>(lastSceneExtent.height), 1};
+  blit.dstSubresource = layers;
+  blit.dstOffsets[1] = vk::Offset3D{static_cast<int32_t>(swapChainExtent.width),
+                                    static_cast<int32_t>(swapChainExtent.height), 1};
+  commandBuffer.blitImage(source, eTransferSrcOptimal, *captureImage, eTransferDstOptimal, blit,
+                          lastSceneExtent == swapChainExtent ? vk::Filter::eNearest
+                                                             : vk::Filter::eLinear);
+
+  barrier.oldLayout = eTransferDstOptimal;
+  barrier.newLayout = eTransferSrcOptimal;
+  barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+  barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr,
+                                barrier);
+
+  vk::BufferImageCopy region;
+  region.imageSubresource = layers;
+  region.imageExtent = vk::Extent3D{swapChainExtent, 1};
+  commandBuffer.copyImageToBuffer(*captureImage, eTransferSrcOptimal, readback.getBuffer(), region);
+
+  vk::BufferMemoryBarrier hostBarrier;
+  hostBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+  hostBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+  hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  hostBarrier.buffer = readback.getBuffer();
+  hostBarrier.size = vk::WholeSize;
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eHost, {}, nullptr, hostBarrier,
+                                nullptr);
+}
+
+Buffer BaseRenderer::createCaptureBuffer() const {
+  using enum vk::MemoryPropertyFlagBits;
+  // Persistently mapped once read
+  const vk::DeviceSize size = vk::DeviceSize{swapChainExtent.width} * swapChainExtent.height * 4;
+  return {device, physicalDevice, size, vk::BufferUsageFlagBits::eTransferDst,
+          eHostVisible | eHostCoherent};
+}
+
+void BaseRenderer::collectCapture(uint32_t frame) {
+  CaptureSlot &slot = captureSlots[frame];
+  if (!slot.imagePath && !slot.sequence) {
+    return;
+  }
+
+  CapturedFrame captured;
+  captured.width = slot.extent.width;
+  captured.height = slot.extent.height;
+  captured.pixels.resize(slot.readback->getSize());
+  slot.readback->copyFromMemory(captured.pixels.data(), captured.pixels.size());
+  // Only copied when it goes to both
+  if (slot.imagePath) {
+    getCaptureWriter().writeImage(*slot.imagePath,
+                                  slot.sequence ? CapturedFrame(captured) : std::move(captured));
+  }
+  if (slot.sequence) {
+    getCaptureWriter().appendToSequence(std::move(captured));
+  }
+  slot.imagePath.reset();
+  slot.sequence = false;
+}
+
+void BaseRenderer::collectAllCaptures() {
+  for (uint32_t frame = 0; frame < captureSlots.size(); ++frame) {
+    collectCapture(frame);
+  }
+}
+
+CaptureWriter &BaseRenderer::getCaptureWriter() {
+  if (!captureWriter) {
+    captureWriter = std::make_unique<CaptureWriter>();
+  }
+  return *captureWriter;
 }
 
 inline vk::AccessFlags BaseRenderer::accessFlagsForLayout(vk::ImageLayout layout) {
@@ -1199,6 +2007,8 @@ void BaseRenderer::mouseMoved(const glm::vec2 &newPos) {
     }
 
     camera.rotate(deltaPos.x, deltaPos.y);
+    latencyTracker.inputReceived(LatencyTracker::Clock::now());
+    requestRedraw();
   }
 }
 
@@ -1219,11 +2029,30 @@ void BaseRenderer::keyboardHandler(GLFWwindow *window, int key, [[maybe_unused]]
   }
 }
 
-void BaseRenderer::keyPressed(int key) { handleCameraKeys(key, true); }
+void BaseRenderer::keyPressed(int key) {
+  handleCameraKeys(key, true);
+  latencyTracker.inputReceived(LatencyTracker::Clock::now());
+  requestRedraw();
+}
 void BaseRenderer::keyReleased(int key) {
   handleCameraKeys(key, false);
+  latencyTracker.inputReceived(LatencyTracker::Clock::now());
   if (key == GLFW_KEY_P) {
     camera.printDebug();
+  } else if (key == GLFW_KEY_F12) {
+    captureNextFrame("screenshot.png");
+  } else if (key == GLFW_KEY_F9) {
+    if (recording) {
+      stopRecording();
+    } else {
+      startRecording("capture.ppm");
+    }
+  } else if (key == GLFW_KEY_F8) {
+    if (Tracer::get().isCapturing()) {
+      stopTrace("trace.json");
+    } else {
+      startTrace();
+    }
   }
 }
 void BaseRenderer::handleCameraKeys(int key, bool pressed) {
@@ -1260,6 +2089,7 @@ void BaseRenderer::mouseAction(int button, int action, int) {
   if (button == GLFW_MOUSE_BUTTON_LEFT) {
     mouseButtons.left = action == GLFW_PRESS;
   }
+  latencyTracker.inputReceived(LatencyTracker::Clock::now());
 }
 
 VkBool32 BaseRenderer::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
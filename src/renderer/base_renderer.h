@@ -6,15 +6,26 @@
 #include "Buffer.h"
 #include "camera.h"
 #include "file_utils.h"
+#include "frame_capture.h"
+#include "hot_reloader.h"
+#include "latency_tracker.h"
+#include "queue_families.h"
+#include "resolution_scaler.h"
+#include "../jobs/job_system.h"
+#include "../profiling/tracer.h"
 
 #include "cmrc/cmrc.hpp"
 #include <GLFW/glfw3.h>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <glm/detail/type_mat4x4.hpp>
 #include <glm/fwd.hpp>
 #include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <iostream>
+#include <memory>
 #include <optional>
 
 static constexpr int NB_COMPUTE_BUFFERS = 4;
@@ -24,19 +35,29 @@ struct MouseButtons {
   bool left = false;
 };
 
-struct UniformBufferObject {
-  alignas(16) glm::mat4 model;
-  alignas(16) glm::mat4 view;
-  alignas(16) glm::mat4 proj;
+/**
+ * Camera data of the graphics pipelines, pushed rather than read from a buffer since it changes
+ * every frame and is read by every vertex
+ */
+struct CameraPushConstants {
+  alignas(16) glm::mat4 viewProjection;
+  // Added to the vertex positions, so that meshes can be stored relative to their origin
+  alignas(16) glm::vec4 offset{0.f};
+  // Camera axes in world space, for billboards
+  alignas(16) glm::vec4 right;
+  alignas(16) glm::vec4 up;
 };
 
-struct QueueFamilyIndices {
-  std::optional<uint32_t> graphicsAndComputeFamily;
-  std::optional<uint32_t> presentFamily;
+constexpr vk::PushConstantRange CAMERA_PUSH_CONSTANT_RANGE{vk::ShaderStageFlagBits::eVertex, 0,
+                                                           sizeof(CameraPushConstants)};
 
-  [[nodiscard]] bool isComplete() const {
-    return graphicsAndComputeFamily.has_value() && presentFamily.has_value();
-  }
+struct GraphicsPipelineDescription {
+  const char *vertexShader;
+  const char *fragmentShader;
+  std::vector<vk::VertexInputBindingDescription> bindings;
+  std::vector<vk::VertexInputAttributeDescription> attributes;
+  // pipelineLayout is used when not set
+  vk::PipelineLayout layout = nullptr;
 };
 
 struct SwapChainSupportDetails {
@@ -46,13 +67,43 @@ struct SwapChainSupportDetails {
 };
 
 const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
-const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+// Dynamic rendering depends on the other two
+const std::vector<const char *> deviceExtensions = {
+    VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+    VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
 constexpr uint32_t MAX_VERTEX_COUNT = 8192;
 constexpr uint32_t MAX_INDEX_COUNT = 8192;
-constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+// Secondary command buffers recorded in parallel for the draws of a frame
+constexpr uint32_t MAX_RECORDING_STREAMS = 8;
 constexpr uint64_t FENCE_TIMEOUT = 100000000;
 constexpr int TARGET_FPS = 60;
+constexpr float FIELD_OF_VIEW_Y_DEG = 45.0f;
+constexpr float DEFAULT_FAR_PLANE = 256.0f;
 constexpr double FRAME_TIME_S = 1.0 / TARGET_FPS;
+// Longest wait for window events while rendering on demand, so that the caller still gets to
+// update the scene
+constexpr double IDLE_EVENT_TIMEOUT_S = 0.1;
+
+enum class PresentMode { Immediate, Mailbox, Fifo, FifoRelaxed };
+
+/**
+ * Trade-offs between input latency, tearing and smoothness
+ */
+struct LatencyConfig {
+  // Falls back to FIFO, the only mode every device supports
+  PresentMode presentMode = PresentMode::Mailbox;
+  // Wait for the next frame before polling input rather than after presenting, so that each frame
+  // is recorded right after sampling the latest input
+  bool lateInputSampling = false;
+  // Between 1 and MAX_FRAMES_IN_FLIGHT, fewer frames lower latency but overlap less CPU and GPU
+  // work. Benchmarks favor 3, interactive play 1.
+  uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+  // Images requested from the swap chain, clamped to what the surface supports. 0 asks for one
+  // more than the minimum so that acquiring never waits on the presentation engine.
+  uint32_t swapChainImageCount = 0;
+};
 
 class VulkanInitializationError : public std::runtime_error {
 public:
@@ -82,7 +133,53 @@ public:
   void draw();
   void showWindow();
 
-  void saveScreenshot(const char *filename) const;
+  /**
+   * Save the last frame drawn and wait until the file is written. PNG when the file name ends with
+   * .png, binary PPM otherwise.
+   */
+  void saveScreenshot(const char *filename);
+  /**
+   * Save the next frame drawn like saveScreenshot, but without waiting for the GPU nor the disk
+   */
+  void captureNextFrame(std::string filename);
+  /**
+   * Append every frame drawn to a stream of binary PPM images until stopped, without waiting for
+   * the GPU nor the disk
+   */
+  void startRecording(const std::string &filename);
+  void stopRecording();
+  /**
+   * Open a capture window of the CPU scopes of every thread and of the GPU time of the scenes
+   */
+  void startTrace();
+  /**
+   * Close the capture window and save it as Chrome trace JSON
+   */
+  void stopTrace(const char *filename) const;
+  /**
+   * Development mode: recompile shaders and textures whenever their sources change, and swap them
+   * in between two frames
+   */
+  void enableHotReload(HotReloadConfig config);
+  /**
+   * Only draw frames when something changed since the previous one, and otherwise wait for window
+   * events instead of recording and submitting an identical frame
+   */
+  void setRenderOnDemand(bool enabled);
+  /**
+   * Draw the next frame even when rendering on demand, for changes the renderer cannot see
+   */
+  void requestRedraw();
+  /**
+   * Can be changed at any time, the swap chain and the resources of each frame in flight are then
+   * recreated
+   */
+  void setLatencyConfig(const LatencyConfig &config);
+  /**
+   * Render the scene at a lower resolution whenever its GPU time exceeds the budget, then scale it
+   * up to the window. Without timestamp queries, the scene stays at full resolution.
+   */
+  void enableDynamicResolution(const ResolutionScalingConfig &config);
 
 private:
   // These objects needs to be destructed last
@@ -94,19 +191,90 @@ protected:
 
   vk::Extent2D windowSize{1280, 720};
 
-  void copyBuffer(vk::Buffer srcBuffer, vk::Buffer dstBuffer,
-                                   vk::DeviceSize size) const;
+  /**
+   * Copy on the dedicated transfer queue when there is one, without waiting for it. The next frame
+   * waits on the copy, and the destination is handed over to the graphics queue unless it is
+   * shared between the queue families. The staging buffer is kept until the copy is done.
+   */
+  void copyBuffer(Buffer stagingBuffer, vk::Buffer dstBuffer, bool sharedBetweenQueues = false);
   [[nodiscard]] virtual vk::PipelineLayoutCreateInfo getPipelineLayoutInfo() const;
   [[nodiscard]] virtual vk::PipelineLayoutCreateInfo getComputePipelineLayoutInfo() const;
   virtual void initCustomDescriptorSetLayout();
+  /**
+   * Create the resources needed once per frame in flight, called again while the device is idle
+   * whenever their count changes
+   */
+  virtual void initCustomFrameResources();
+  [[nodiscard]] uint32_t getFramesInFlight() const;
+  [[nodiscard]] uint64_t getSubmittedFrameCount() const;
+  /**
+   * Whether the GPU is done with every frame submitted before the given count, valid once the
+   * fence of the current frame was waited on
+   */
+  [[nodiscard]] bool areFramesDone(uint64_t frameCount) const;
+  /**
+   * Called once the resources of the given frame in flight are no longer used by the GPU, right
+   * before its command buffer is recorded
+   */
+  virtual void prepareFrame(uint32_t frame);
+  /**
+   * Rebuild what uses the reloaded assets, called between two frames while the device is idle
+   */
+  virtual void reloadAssets(const ReloadedAssets &assets);
+  /**
+   * Whether the content keeps changing without any event, overridden for animations
+   */
+  [[nodiscard]] virtual bool isAnimating() const;
+  [[nodiscard]] vk::raii::Pipeline
+  createGraphicsPipeline(const GraphicsPipelineDescription &description) const;
+  [[nodiscard]] vk::raii::ShaderModule createShaderModule(std::span<const char> code) const;
   void createImage(uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling,
                    vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties,
-                   vk::raii::Image &image, vk::raii::DeviceMemory &imageMemory) const;
+                   vk::raii::Image &image, vk::raii::DeviceMemory &imageMemory,
+                   uint32_t arrayLayers = 1, uint32_t mipLevels = 1) const;
   vk::raii::ImageView createImageView(vk::Image image, vk::Format format,
-                                      vk::ImageAspectFlags aspectFlags);
+                                      vk::ImageAspectFlags aspectFlags,
+                                      vk::ImageViewType viewType = vk::ImageViewType::e2D,
+                                      uint32_t layerCount = 1, uint32_t levelCount = 1);
   [[nodiscard]] vk::raii::CommandBuffer beginSingleTimeCommands() const;
   void endSingleTimeCommands(vk::CommandBuffer commandBuffer) const;
-  void transitionImageLayout(vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout) const;
+  void transitionImageLayout(vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
+                             uint32_t layerCount = 1, uint32_t levelCount = 1) const;
+  /**
+   * Fill the mip levels of an image from its first one, which must be in the transfer destination
+   * layout. The whole image ends up ready to be sampled.
+   */
+  void generateMipmaps(vk::Image image, uint32_t width, uint32_t height, uint32_t mipLevels,
+                       uint32_t layerCount = 1) const;
+
+  /**
+   * GPU time in nanoseconds of the recorded commands, submitted on their own. Falls back to the
+   * time until the queue is idle when the device has no timestamps.
+   */
+  [[nodiscard]] double measureGpuTime(const std::function<void(vk::CommandBuffer)> &record) const;
+  /**
+   * Identifies the device and driver, for parameters measured once per device
+   */
+  [[nodiscard]] std::string getDeviceKey() const;
+  /**
+   * Push the camera of the frame, with meshes offset to the given origin
+   */
+  void pushCamera(vk::CommandBuffer commandBuffer, vk::PipelineLayout layout,
+                  const glm::vec3 &offset = glm::vec3(0.f)) const;
+  [[nodiscard]] const Camera &getCamera() const;
+  [[nodiscard]] Camera &getCamera();
+  /**
+   * Size in pixels of an object one unit tall seen from one unit away
+   */
+  [[nodiscard]] float getPixelsPerUnitAtUnitDepth() const;
+  /**
+   * Tangent of half the horizontal and vertical fields of view
+   */
+  [[nodiscard]] glm::vec2 getTanHalfFieldOfView() const;
+  /**
+   * Distance from the camera beyond which nothing is drawn
+   */
+  void setFarPlane(float distance);
 
   uint32_t currentFrame = 0;
 
@@ -121,7 +289,8 @@ protected:
   vk::raii::Queue graphicsQueue = nullptr;
   vk::raii::PhysicalDevice physicalDevice = nullptr;
   vk::raii::PipelineLayout pipelineLayout = nullptr;
-  std::vector<plaxel::Buffer> uniformBuffers{};
+  // Selected once the physical device is picked
+  QueueFamilyIndices queueFamilies;
 
 private:
   GLFWwindow *window{};
@@ -136,35 +305,136 @@ private:
 
   vk::raii::Queue computeQueue = nullptr;
   vk::raii::Queue presentQueue = nullptr;
+  vk::raii::Queue transferQueue = nullptr;
+  vk::raii::CommandPool computeCommandPool = nullptr;
+  // Only created with a dedicated transfer family
+  vk::raii::CommandPool transferCommandPool = nullptr;
 
   vk::raii::SwapchainKHR swapChain = nullptr;
   std::vector<vk::Image> swapChainImages;
+  // Unless dynamic resolution is enabled and the swap chain images can be copied to, the scene is
+  // drawn straight into them at full resolution
+  bool drawToSwapChain = false;
+  // Only created when drawing to the swap chain
   std::vector<vk::raii::ImageView> swapChainImageViews;
-  std::vector<vk::raii::Framebuffer> swapChainFramebuffers;
 
   vk::raii::Image depthImage = nullptr;
   vk::raii::DeviceMemory depthImageMemory = nullptr;
   vk::raii::ImageView depthImageView = nullptr;
 
+  // With dynamic resolution, the scene is rendered into the top left corner of its own target,
+  // sized after the window, then copied or scaled up to the acquired swap chain image
+  vk::raii::DeviceMemory sceneImageMemory = nullptr;
+  vk::raii::Image sceneImage = nullptr;
+  vk::raii::ImageView sceneImageView = nullptr;
+  bool sceneBlitSupported = false;
+  // Extent of the scene in the last frame recorded
+  vk::Extent2D lastSceneExtent;
+  // Swap chain image of the last frame recorded, read back by screenshots when drawn to directly
+  uint32_t lastImageIndex = 0;
+
+  // The scene scaled to the window in RGBA, then copied to a host visible buffer. Only created
+  // once a frame is captured.
+  vk::raii::DeviceMemory captureImageMemory = nullptr;
+  vk::raii::Image captureImage = nullptr;
+  // Captures of each frame in flight, read back once its fence was waited on
+  struct CaptureSlot {
+    std::optional<Buffer> readback;
+    vk::Extent2D extent;
+    std::optional<std::string> imagePath;
+    bool sequence = false;
+  };
+  std::vector<CaptureSlot> captureSlots;
+  std::optional<std::string> nextFrameCapture;
+  bool recording = false;
+  std::unique_ptr<CaptureWriter> captureWriter;
+
+  std::optional<ResolutionScaler> resolutionScaler;
+  // Start and end of the scene of each frame in flight, only with timestamp support
+  vk::raii::QueryPool frameTimestampQueries = nullptr;
+  std::vector<bool> frameTimestampsWritten;
+  float timestampPeriodNs = 0;
+  // CPU time at which the GPU timestamps were 0, measured whenever a trace starts
+  Tracer::Clock::time_point gpuClockOrigin;
+
+  // Replaced on resize while frames in flight may still draw to it
+  struct RetiredSwapChain {
+    vk::raii::DeviceMemory depthImageMemory = nullptr;
+    vk::raii::Image depthImage = nullptr;
+    vk::raii::ImageView depthImageView = nullptr;
+    vk::raii::DeviceMemory sceneImageMemory = nullptr;
+    vk::raii::Image sceneImage = nullptr;
+    vk::raii::ImageView sceneImageView = nullptr;
+    vk::raii::DeviceMemory captureImageMemory = nullptr;
+    vk::raii::Image captureImage = nullptr;
+    std::vector<vk::raii::ImageView> swapChainImageViews;
+    vk::raii::SwapchainKHR swapChain = nullptr;
+    // Frames submitted before it was replaced
+    uint64_t retiredAtFrame = 0;
+  };
+  // Oldest first
+  std::deque<RetiredSwapChain> retiredSwapChains;
+  uint64_t submittedFrameCount = 0;
+
   vk::Format swapChainImageFormat = vk::Format::eUndefined;
+  vk::Format depthFormat = vk::Format::eUndefined;
   vk::Extent2D swapChainExtent;
 
-  vk::raii::RenderPass renderPass = nullptr;
   vk::raii::Pipeline graphicsPipeline = nullptr;
 
   vk::raii::CommandBuffers mainCommandBuffers = nullptr;
   vk::raii::CommandBuffer computeCommandBuffer = nullptr;
 
-  std::array<vk::raii::Semaphore, MAX_FRAMES_IN_FLIGHT> imageAvailableSemaphores{nullptr, nullptr};
-  std::array<vk::raii::Semaphore, MAX_FRAMES_IN_FLIGHT> renderFinishedSemaphores{nullptr, nullptr};
+  // Each stream has its own pool per frame in flight, so that streams never share a pool while
+  // they record
+  struct RecordingStream {
+    vk::raii::CommandPool pool = nullptr;
+    vk::raii::CommandBuffer commandBuffer = nullptr;
+  };
+  // Indexed by frame in flight, then stream
+  std::vector<RecordingStream> recordingStreams;
+  uint32_t recordingStreamCount = 1;
+  // Kept apart from the jobs of the application, so that waiting on the streams never runs them
+  std::optional<JobSystem> recordingJobs;
+
+  // Indexed by frame in flight
+  std::vector<vk::raii::Semaphore> imageAvailableSemaphores;
+  std::vector<vk::raii::Semaphore> renderFinishedSemaphores;
   vk::raii::Semaphore computeFinishedSemaphore = nullptr;
-  std::array<vk::raii::Fence, MAX_FRAMES_IN_FLIGHT> inFlightFences{nullptr, nullptr};
+  // Lets the compute pass overwrite buffers read by the previous frame, possibly on another queue
+  vk::raii::Semaphore graphicsFinishedSemaphore = nullptr;
+  bool graphicsFinishedPending = false;
+  vk::raii::Semaphore transferFinishedSemaphore = nullptr;
+  // Signalled once the copies in flight are done
+  struct PendingUpload {
+    Buffer stagingBuffer;
+    vk::raii::CommandBuffer commandBuffer;
+    vk::raii::Fence fence;
+  };
+  // Oldest first
+  std::deque<PendingUpload> pendingUploads;
+  // Uploads submitted since the last compute submission, which waits on them for both passes
+  bool uploadsUnsignalled = false;
+  // Ownership of the uploaded buffers, acquired by the graphics command buffer once the compute
+  // submission waited on their copy
+  std::vector<vk::BufferMemoryBarrier> unsignalledAcquires;
+  std::vector<vk::BufferMemoryBarrier> signalledAcquires;
+  std::vector<vk::raii::Fence> inFlightFences;
   vk::raii::Fence computeFence = nullptr;
 
   bool framebufferResized = false;
+  bool renderOnDemand = false;
+  bool redrawRequested = true;
+
+  LatencyConfig latencyConfig;
+  LatencyTracker latencyTracker;
+
+  std::unique_ptr<HotReloader> hotReloader;
 
   glm::vec2 mousePos{};
   Camera camera;
+  float farPlane = DEFAULT_FAR_PLANE;
+  CameraPushConstants cameraConstants{};
   MouseButtons mouseButtons;
 
   void createWindow();
@@ -174,6 +444,7 @@ private:
   static void keyboardHandler(GLFWwindow *window, int key, [[maybe_unused]] int scancode,
                               int action, [[maybe_unused]] int mods);
   static void mouseHandler(GLFWwindow *window, int button, int action, int mods);
+  static void windowRefreshHandler(GLFWwindow *window);
 
   void createInstance();
   static bool checkValidationLayerSupport();
@@ -189,42 +460,113 @@ private:
   [[nodiscard]] SwapChainSupportDetails
   querySwapChainSupport(vk::PhysicalDevice physicalDeviceCandidate) const;
   void createLogicalDevice();
-  void createSwapChain();
+  /**
+   * The old swap chain, if any, hands its resources over to the new one and must no longer be used
+   * to acquire images
+   */
+  void createSwapChain(vk::SwapchainKHR oldSwapChain = nullptr);
   static vk::SurfaceFormatKHR
   chooseSwapSurfaceFormat(const std::vector<vk::SurfaceFormatKHR> &availableFormats);
   static vk::PresentModeKHR
-  chooseSwapPresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes);
+  chooseSwapPresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes,
+                        PresentMode preferredMode);
   [[nodiscard]] vk::Extent2D chooseSwapExtent(const vk::SurfaceCapabilitiesKHR &capabilities) const;
-  void createImageViews();
-  void createRenderPass();
   void createGraphicsPipeline();
-  vk::raii::ShaderModule createShaderModule(const cmrc::file &code);
   void createComputePipeline();
-  void createFramebuffers();
+  void createSceneResources();
   void createCommandPool();
   void createDescriptorPool();
   void createCommandBuffers();
   void createComputeCommandBuffers();
+  void createRecordingStreams();
   void createSyncObjects();
-  void createUniformBuffers();
-  void updateUniformBuffer(uint32_t currentImage);
+  void createFrameSyncObjects();
+  void createFrameTimestampQueries();
+  /**
+   * Size everything indexed by frame in flight after the latency configuration
+   */
+  void createFrameResources();
+  void updateCamera();
   virtual void recordComputeCommandBuffer(vk::CommandBuffer commandBuffer) = 0;
   void waitForFence(vk::Fence fence) const;
+  /**
+   * Retire the current swap chain without waiting on the GPU, deferred while minimized
+   */
   void recreateSwapChain();
-  void recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const;
+  /**
+   * Destroy the retired swap chains that no frame in flight uses anymore, once the fence of the
+   * current frame was waited on
+   */
+  void releaseRetiredSwapChains();
+  [[nodiscard]] const vk::raii::Queue &getUploadQueue() const;
+  /**
+   * Signal the transfer semaphore once the uploads submitted since the previous compute submission
+   * are done, returning whether there were any
+   */
+  [[nodiscard]] bool signalUploads();
+  /**
+   * Destroy the staging buffers of the copies done
+   */
+  void releaseFinishedUploads();
+  /**
+   * Block until every copy in flight is done, for the commands submitted outside of the frames
+   */
+  void waitForUploads() const;
+  [[nodiscard]] bool isMinimized() const;
+  void recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex);
+  /**
+   * Record every stream of the frame in parallel, returning their buffers in execution order
+   */
+  std::vector<vk::CommandBuffer> recordDrawStreams(const vk::Extent2D &sceneExtent);
+  void blitSceneToSwapChain(vk::CommandBuffer commandBuffer, uint32_t imageIndex,
+                            const vk::Extent2D &sceneExtent) const;
+  /**
+   * Feed the GPU time of the last scene drawn by the current frame in flight to the scaler and to
+   * the trace, once its fence was waited on
+   */
+  void collectFrameTimestamps();
+  void calibrateGpuClock();
+  [[nodiscard]] Tracer::Clock::time_point toCpuTime(uint64_t timestamp) const;
+  /**
+   * Copy the scene of the last frame recorded to the buffer, scaled to the window. The source is
+   * the scene image or the swap chain image drawn to, in the transfer source layout.
+   */
+  void recordCapture(vk::CommandBuffer commandBuffer, vk::Image source, const Buffer &readback);
+  [[nodiscard]] Buffer createCaptureBuffer() const;
+  /**
+   * Hand the capture of the given frame in flight to the writer, once the GPU is done with it
+   */
+  void collectCapture(uint32_t frame);
+  /**
+   * Only while the device is idle
+   */
+  void collectAllCaptures();
+  [[nodiscard]] CaptureWriter &getCaptureWriter();
+  [[nodiscard]] vk::Extent2D getSceneExtent() const;
 
   void drawFrame();
-  virtual void drawCommand(vk::CommandBuffer commandBuffer) const = 0;
+  /**
+   * Record the share of the draws of the given stream, concurrently with the other streams. Each
+   * stream starts with the main pipeline and the camera bound, and streams are executed in order.
+   */
+  virtual void drawCommand(vk::CommandBuffer commandBuffer, uint32_t stream,
+                           uint32_t streamCount) const = 0;
   [[nodiscard]] virtual vk::VertexInputBindingDescription getVertexBindingDescription() const = 0;
   [[nodiscard]] virtual std::vector<vk::VertexInputAttributeDescription>
   getVertexAttributeDescription() const = 0;
   void createDepthResources();
   [[nodiscard]] vk::Format findDepthFormat() const;
+  static bool hasStencilComponent(vk::Format format);
   [[nodiscard]] vk::Format findSupportedFormat(const std::vector<vk::Format> &candidates,
                                                vk::ImageTiling tiling,
                                                vk::FormatFeatureFlags features) const;
+  /**
+   * The preferred memory properties are added to the required ones when a memory type of the image
+   * has them all
+   */
   void createImage(const vk::ImageCreateInfo &imageInfo, const vk::MemoryPropertyFlags &properties,
-                   vk::raii::Image &image, vk::raii::DeviceMemory &imageMemory) const;
+                   vk::raii::Image &image, vk::raii::DeviceMemory &imageMemory,
+                   const vk::MemoryPropertyFlags &preferredProperties = {}) const;
   static vk::AccessFlags accessFlagsForLayout(vk::ImageLayout layout);
   static vk::PipelineStageFlags pipelineStageForLayout(vk::ImageLayout layout);
   void mouseMoved(const glm::vec2 &newPos);
@@ -238,7 +580,7 @@ private:
                 VkDebugUtilsMessageTypeFlagsEXT messageTypes,
                 VkDebugUtilsMessengerCallbackDataEXT const *pCallbackData, void * /*pUserData*/);
   static void manageFps();
-  static void printFps();
+  void printFps();
 };
 
 } // namespace plaxel
@@ -1,9 +1,11 @@
 #include "camera.h"
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <glm/detail/type_mat4x4.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/geometric.hpp>
 #include <glm/trigonometric.hpp>
+#include <glm/vec4.hpp>
 #include <iostream>
 
 namespace plaxel {
@@ -19,10 +21,35 @@ glm::mat4 Camera::getViewMatrix() const {
   return rotM * transM;
 }
 
+float Camera::getDepth(const glm::vec3 &point) const {
+  // The camera looks down the negative z axis of the view space
+  return -(getViewMatrix() * glm::vec4(point, 1.0f)).z;
+}
+
+// The view matrix translates the world by position, which puts the eye at its opposite
+glm::vec3 Camera::getEyePosition() const { return -position; }
+
 void Camera::rotate(const float &dx, const float &dy) {
+  if (locked) {
+    return;
+  }
   rotation += glm::vec3(dy * rotationSpeed, -dx * rotationSpeed, 0.0f);
 }
 
+void Camera::lockView(const int depthAxis, const int depthDirection, const float depth) {
+  // Without rotation the camera looks down the negative z axis, each quarter turn of yaw moves it
+  // to the next horizontal axis
+  float yaw = depthAxis == 2 ? 0.f : -90.f;
+  if (depthDirection > 0) {
+    yaw += 180.f;
+  }
+  rotation = glm::vec3(0.f, yaw, 0.f);
+  glm::vec3 eye = getEyePosition();
+  eye[depthAxis] = static_cast<float>(depthDirection) * depth;
+  position = -eye;
+  locked = true;
+}
+
 glm::vec3 Camera::getFront() const {
   glm::vec3 camFront;
   camFront.x = static_cast<float>(-cos(glm::radians(rotation.x)) * sin(glm::radians(rotation.y)));
@@ -44,12 +71,14 @@ void Camera::update() {
   static double lastUpdateTime = glfwGetTime();
 
   const double startTime = glfwGetTime();
-  const auto deltaTime = static_cast<float>(startTime - lastUpdateTime);
+  // Not updated while the renderer idles, which must not turn into a jump on the next key press
+  const float deltaTime =
+      std::min(static_cast<float>(startTime - lastUpdateTime), MAX_UPDATE_STEP_S);
   lastUpdateTime = startTime;
 
-  if (moving()) {
+  if (isMoving()) {
     glm::vec3 direction{0.f, 0.f, 0.f};
-    if (keys.forward != keys.backward) {
+    if (keys.forward != keys.backward && !locked) {
       direction.z = keys.forward ? 1.0f : -1.0f;
     }
     if (keys.left != keys.right) {
@@ -62,8 +91,9 @@ void Camera::update() {
   }
 }
 
-bool Camera::moving() const {
-  return keys.left || keys.right || keys.up || keys.down || keys.forward || keys.backward;
+bool Camera::isMoving() const {
+  return keys.left || keys.right || keys.up || keys.down ||
+         (!locked && (keys.forward || keys.backward));
 }
 void Camera::printDebug() const {
   std::cout << "Camera debug info:\n";
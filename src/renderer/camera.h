@@ -4,13 +4,27 @@
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 namespace plaxel {
+// Longest movement step, in seconds
+constexpr float MAX_UPDATE_STEP_S = .1f;
+
 class Camera {
 public:
   [[nodiscard]] glm::mat4 getViewMatrix() const;
+  /**
+   * Distance from the camera to a point along the viewing direction, negative behind it
+   */
+  [[nodiscard]] float getDepth(const glm::vec3 &point) const;
+  [[nodiscard]] glm::vec3 getEyePosition() const;
 
   void rotate(const float &d, const float &d1);
+  /**
+   * Look down a horizontal axis, 0 for x or 2 for z, towards 1 or -1, from the given depth along
+   * it. The camera then only moves across that axis and ignores rotations.
+   */
+  void lockView(int depthAxis, int depthDirection, float depth);
 
   void update();
+  [[nodiscard]] bool isMoving() const;
 
   void printDebug() const;
 
@@ -24,7 +38,6 @@ public:
   } keys;
 
 private:
-  [[nodiscard]] bool moving() const;
   [[nodiscard]] glm::vec3 getFront() const;
   void translate(const glm::vec3 &delta);
 
@@ -32,6 +45,7 @@ private:
   const float movementSpeed = 3.f;
   glm::vec3 rotation{-30.f, -210.f, 0.f};
   glm::vec3 position{1.8f, 1.9f, 2.8f};
+  bool locked = false;
 };
 
 } // namespace plaxel
@@ -1,11 +1,53 @@
 #include "file_utils.h"
+#include "../assets/asset_pack.h"
+
+#include <cmrc/cmrc.hpp>
+#include <deque>
+#include <ranges>
+#include <unordered_map>
+#include <vector>
 
 CMRC_DECLARE(plaxel);
 
 namespace plaxel::files {
 
-cmrc::file readFile(const std::string &filename) {
+namespace {
+std::vector<AssetPack> &mountedPacks() {
+  static std::vector<AssetPack> packs;
+  return packs;
+}
+
+struct ReplacedFiles {
+  // Every content ever replaced, since readers may still hold earlier ones
+  std::deque<std::vector<char>> contents;
+  std::unordered_map<std::string, std::span<const char>> latest;
+};
+
+ReplacedFiles &replacedFiles() {
+  static ReplacedFiles files;
+  return files;
+}
+} // namespace
+
+std::span<const char> readFile(const std::string &filename) {
+  if (const auto replaced = replacedFiles().latest.find(filename);
+      replaced != replacedFiles().latest.end()) {
+    return replaced->second;
+  }
+  for (const AssetPack &pack : std::views::reverse(mountedPacks())) {
+    if (const auto content = pack.find(filename)) {
+      return *content;
+    }
+  }
   const auto fs = cmrc::plaxel::get_filesystem();
-  return fs.open(filename);
+  const cmrc::file file = fs.open(filename);
+  return {file.begin(), file.size()};
+}
+
+void mountAssetPack(const std::filesystem::path &path) { mountedPacks().emplace_back(path); }
+
+void replaceFile(const std::string &filename, std::vector<char> content) {
+  ReplacedFiles &files = replacedFiles();
+  files.latest[filename] = files.contents.emplace_back(std::move(content));
 }
-} // namespace plaxel::files
\ No newline at end of file
+} // namespace plaxel::files
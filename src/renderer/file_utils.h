@@ -1,13 +1,29 @@
 #ifndef PLAXEL_FILE_UTILS_H
 #define PLAXEL_FILE_UTILS_H
 
-#include <cmrc/cmrc.hpp>
+#include <filesystem>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace plaxel::files {
 
-cmrc::file readFile(const std::string &filename);
+/**
+ * Content of an asset, taken from the last mounted asset pack that has it, or else from the
+ * resources built into the executable. It stays valid until the program exits.
+ */
+std::span<const char> readFile(const std::string &filename);
+/**
+ * Look up assets in the given pack before the ones mounted so far. Packs stay mapped until the
+ * program exits. This must not run concurrently with readFile.
+ */
+void mountAssetPack(const std::filesystem::path &path);
+/**
+ * Serve the asset from memory from now on, over any pack. Previous contents of the asset stay
+ * valid. This must not run concurrently with readFile.
+ */
+void replaceFile(const std::string &filename, std::vector<char> content);
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,140 @@
+#include "frame_capture.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <iostream>
+#include <string>
+
+namespace plaxel {
+
+namespace {
+constexpr int RGBA_CHANNELS = 4;
+
+void writeFile(const std::filesystem::path &path, const std::vector<uint8_t> &data) {
+  std::ofstream file(path, std::ios::out | std::ios::binary);
+  file.write(reinterpret_cast<const char *>(data.data()),
+             static_cast<std::streamsize>(data.size()));
+  if (!file) {
+    std::cerr << "Failed to write " << path << std::endl;
+  }
+}
+} // namespace
+
+std::vector<uint8_t> encodePpm(const CapturedFrame &frame) {
+  const std::string header = "P6\n" + std::to_string(frame.width) + "\n" +
+                             std::to_string(frame.height) + "\n255\n";
+  const size_t pixelCount = static_cast<size_t>(frame.width) * frame.height;
+
+  std::vector<uint8_t> data(header.begin(), header.end());
+  data.resize(header.size() + pixelCount * 3);
+  uint8_t *out = data.data() + header.size();
+  for (size_t pixel = 0; pixel < pixelCount; ++pixel) {
+    const uint8_t *in = frame.pixels.data() + pixel * RGBA_CHANNELS;
+    *out++ = in[0];
+    *out++ = in[1];
+    *out++ = in[2];
+  }
+  return data;
+}
+
+std::vector<uint8_t> encodePng(const CapturedFrame &frame) {
+  std::vector<uint8_t> data;
+  stbi_write_png_to_func(
+      [](void *context, void *chunk, int size) {
+        auto &out = *static_cast<std::vector<uint8_t> *>(context);
+        const auto *bytes = static_cast<const uint8_t *>(chunk);
+        out.insert(out.end(), bytes, bytes + size);
+      },
+      &data, static_cast<int>(frame.width), static_cast<int>(frame.height), RGBA_CHANNELS,
+      frame.pixels.data(), static_cast<int>(frame.width) * RGBA_CHANNELS);
+  return data;
+}
+
+CaptureWriter::CaptureWriter(const size_t maxPendingFrames)
+    : pendingFrameLimit(maxPendingFrames), worker([this] { workerLoop(); }) {}
+
+CaptureWriter::~CaptureWriter() {
+  {
+    std::scoped_lock lock(tasksMutex);
+    stopping = true;
+  }
+  taskAvailable.notify_one();
+  worker.join();
+}
+
+void CaptureWriter::writeImage(std::filesystem::path path, CapturedFrame frame) {
+  enqueue(
+      [path = std::move(path), frame = std::move(frame)] {
+        writeFile(path, path.extension() == ".png" ? encodePng(frame) : encodePpm(frame));
+      },
+      true);
+}
+
+void CaptureWriter::openSequence(std::filesystem::path path) {
+  enqueue([this, path = std::move(path)] {
+    sequence = std::ofstream(path, std::ios::out | std::ios::binary);
+  });
+}
+
+void CaptureWriter::appendToSequence(CapturedFrame frame) {
+  enqueue(
+      [this, frame = std::move(frame)] {
+        if (sequence.is_open()) {
+          const std::vector<uint8_t> data = encodePpm(frame);
+          sequence.write(reinterpret_cast<const char *>(data.data()),
+                         static_cast<std::streamsize>(data.size()));
+        }
+      },
+      true);
+}
+
+void CaptureWriter::closeSequence() {
+  enqueue([this] { sequence.close(); });
+}
+
+void CaptureWriter::flush() {
+  std::unique_lock lock(tasksMutex);
+  tasksDone.wait(lock, [this] { return tasks.empty() && !busy; });
+}
+
+size_t CaptureWriter::getPendingFrameCount() {
+  std::scoped_lock lock(tasksMutex);
+  return pendingFrames;
+}
+
+void CaptureWriter::enqueue(std::function<void()> task, const bool holdsFrame) {
+  {
+    std::unique_lock lock(tasksMutex);
+    if (holdsFrame) {
+      // Throttles the capture rather than dropping frames of a sequence
+      tasksDone.wait(lock, [this] { return pendingFrames < pendingFrameLimit; });
+      ++pendingFrames;
+    }
+    tasks.push_back({std::move(task), holdsFrame});
+  }
+  taskAvailable.notify_one();
+}
+
+void CaptureWriter::workerLoop() {
+  std::unique_lock lock(tasksMutex);
+  while (true) {
+    taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+    if (tasks.empty()) {
+      return;
+    }
+    const Task task = std::move(tasks.front());
+    tasks.pop_front();
+    busy = true;
+    lock.unlock();
+    task.run();
+    lock.lock();
+    busy = false;
+    if (task.holdsFrame) {
+      --pendingFrames;
+    }
+    tasksDone.notify_all();
+  }
+}
+
+} // namespace plaxel
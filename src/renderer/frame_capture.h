@@ -0,0 +1,88 @@
+#ifndef PLAXEL_FRAME_CAPTURE_H
+#define PLAXEL_FRAME_CAPTURE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace plaxel {
+
+struct CapturedFrame {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  // RGBA, rows from top to bottom without padding
+  std::vector<uint8_t> pixels;
+};
+
+/**
+ * Binary PPM of the frame, without its alpha
+ */
+[[nodiscard]] std::vector<uint8_t> encodePpm(const CapturedFrame &frame);
+[[nodiscard]] std::vector<uint8_t> encodePng(const CapturedFrame &frame);
+
+/**
+ * Encodes and writes captured frames on its own thread, in the order they were captured, so that
+ * capturing only waits on the disk when it falls behind
+ */
+class CaptureWriter {
+public:
+  // Past this many frames not written yet, queuing another one blocks until one is
+  static constexpr size_t DEFAULT_MAX_PENDING_FRAMES = 8;
+
+  explicit CaptureWriter(size_t maxPendingFrames = DEFAULT_MAX_PENDING_FRAMES);
+  /**
+   * Writes everything queued before returning
+   */
+  ~CaptureWriter();
+  CaptureWriter(const CaptureWriter &) = delete;
+  CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+  /**
+   * PNG when the path ends with .png, binary PPM otherwise
+   */
+  void writeImage(std::filesystem::path path, CapturedFrame frame);
+  /**
+   * Frames of a sequence are appended to a single stream of binary PPM images, which ffmpeg reads
+   * with -f image2pipe
+   */
+  void openSequence(std::filesystem::path path);
+  void appendToSequence(CapturedFrame frame);
+  void closeSequence();
+  /**
+   * Wait until everything queued so far is written
+   */
+  void flush();
+  [[nodiscard]] size_t getPendingFrameCount();
+
+private:
+  struct Task {
+    std::function<void()> run;
+    // Keeps the pixels of a frame until it is written
+    bool holdsFrame = false;
+  };
+
+  std::deque<Task> tasks;
+  std::mutex tasksMutex;
+  std::condition_variable taskAvailable;
+  std::condition_variable tasksDone;
+  size_t pendingFrameLimit;
+  size_t pendingFrames = 0;
+  bool busy = false;
+  bool stopping = false;
+  // Only used by the worker
+  std::ofstream sequence;
+  std::thread worker;
+
+  void enqueue(std::function<void()> task, bool holdsFrame = false);
+  void workerLoop();
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_FRAME_CAPTURE_H
@@ -0,0 +1,107 @@
+#include "hot_reloader.h"
+#include "file_utils.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace plaxel {
+
+namespace {
+// How long the watching thread may take to notice it has to stop
+constexpr std::chrono::milliseconds WATCH_TIMEOUT{200};
+
+bool isShaderSource(const std::filesystem::path &path) {
+  const auto extension = path.extension();
+  return extension == ".vert" || extension == ".frag" || extension == ".comp";
+}
+
+bool isTextureSource(const std::filesystem::path &path) {
+  const auto extension = path.extension();
+  return extension == ".jpg" || extension == ".png";
+}
+
+std::string shellArgument(const std::filesystem::path &path) { return '"' + path.string() + '"'; }
+
+std::vector<char> readAll(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+} // namespace
+
+HotReloader::HotReloader(HotReloadConfig reloadConfig) : config(std::move(reloadConfig)) {
+  std::filesystem::create_directories(config.outputDirectory / "shaders");
+  std::filesystem::create_directories(config.outputDirectory / "textures");
+  watcher.watch(config.sourceDirectory / "shaders");
+  watcher.watch(config.sourceDirectory / "textures");
+  thread = std::jthread([this](const std::stop_token &stopToken) { watch(stopToken); });
+}
+
+void HotReloader::watch(const std::stop_token &stopToken) {
+  while (!stopToken.stop_requested()) {
+    for (const auto &source : watcher.waitForChanges(WATCH_TIMEOUT)) {
+      std::vector<CompiledAsset> assets = compile(source);
+      const std::scoped_lock lock(compiledMutex);
+      compiled.insert(compiled.end(), std::make_move_iterator(assets.begin()),
+                      std::make_move_iterator(assets.end()));
+    }
+  }
+}
+
+/**
+ * Compile a source with the same tools and names as the build, nothing when it fails so that the
+ * previous version stays in use
+ */
+std::vector<HotReloader::CompiledAsset>
+HotReloader::compile(const std::filesystem::path &source) const {
+  std::vector<std::string> names;
+  std::string command;
+  if (isShaderSource(source)) {
+    names.push_back("shaders/" + source.filename().string() + ".spv");
+    command = shellArgument(config.glslValidator) + " -V " + shellArgument(source) + " -o " +
+              shellArgument(config.outputDirectory / names[0]);
+  } else if (isTextureSource(source)) {
+    const std::string stem = source.stem().string();
+    names.push_back("textures/" + stem + ".ktx2");
+    names.push_back("textures/" + stem + ".rgba.ktx2");
+    command = shellArgument(config.textureCompiler) + " " + shellArgument(source) + " " +
+              shellArgument(config.outputDirectory / names[0]) + " " +
+              shellArgument(config.outputDirectory / names[1]);
+  } else {
+    return {};
+  }
+
+  std::cout << "Reloading " << source.filename().string() << std::endl;
+  if (std::system(command.c_str()) != 0) {
+    std::cerr << "Failed to compile " << source.string() << std::endl;
+    return {};
+  }
+  std::vector<CompiledAsset> assets;
+  for (auto &name : names) {
+    std::vector<char> content = readAll(config.outputDirectory / name);
+    assets.push_back({std::move(name), std::move(content)});
+  }
+  return assets;
+}
+
+ReloadedAssets HotReloader::takeReloaded() {
+  std::vector<CompiledAsset> assets;
+  {
+    const std::scoped_lock lock(compiledMutex);
+    assets.swap(compiled);
+  }
+
+  ReloadedAssets reloaded;
+  for (auto &[name, content] : assets) {
+    if (name.starts_with("shaders/")) {
+      reloaded.shaders.insert(name);
+    } else {
+      reloaded.textures = true;
+    }
+    files::replaceFile(name, std::move(content));
+  }
+  return reloaded;
+}
+
+} // namespace plaxel
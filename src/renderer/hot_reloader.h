@@ -0,0 +1,68 @@
+#ifndef PLAXEL_HOT_RELOADER_H
+#define PLAXEL_HOT_RELOADER_H
+
+#include "../assets/asset_watcher.h"
+
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace plaxel {
+
+struct HotReloadConfig {
+  // Holds the shaders and textures directories of the sources
+  std::filesystem::path sourceDirectory;
+  // Scratch directory for the compiled assets
+  std::filesystem::path outputDirectory;
+  std::string glslValidator;
+  std::string textureCompiler;
+};
+
+/**
+ * Assets replaced in files:: since the previous frame, named as for files::readFile
+ */
+struct ReloadedAssets {
+  std::set<std::string> shaders;
+  bool textures = false;
+
+  [[nodiscard]] bool empty() const { return shaders.empty() && !textures; }
+  [[nodiscard]] bool hasShader(const char *name) const { return shaders.contains(name); }
+};
+
+/**
+ * Development helper recompiling the shaders and textures as soon as their sources are saved, on
+ * a background thread. Compiled assets are only handed over at a frame boundary, through
+ * takeReloaded, so that the renderer rebuilds what depends on them while the GPU is idle.
+ */
+class HotReloader {
+public:
+  explicit HotReloader(HotReloadConfig reloadConfig);
+
+  /**
+   * Replace the assets compiled since the last call in files::, from the thread calling readFile
+   */
+  [[nodiscard]] ReloadedAssets takeReloaded();
+
+private:
+  struct CompiledAsset {
+    std::string name;
+    std::vector<char> content;
+  };
+
+  HotReloadConfig config;
+  AssetWatcher watcher;
+  std::mutex compiledMutex;
+  std::vector<CompiledAsset> compiled;
+  // Last member, so that the thread stops before the rest is destroyed
+  std::jthread thread;
+
+  void watch(const std::stop_token &stopToken);
+  [[nodiscard]] std::vector<CompiledAsset> compile(const std::filesystem::path &source) const;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_HOT_RELOADER_H
@@ -0,0 +1,62 @@
+#include "instance_batch.h"
+
+namespace plaxel {
+
+void InstanceBatch::clear() {
+  // The removed instances were already counted by getGeneration
+  if (shrunk()) {
+    ++generation;
+  }
+  for (uint32_t mesh = 0; mesh < MESH_TYPE_COUNT; ++mesh) {
+    instancesByMesh[mesh].resize(counts[mesh]);
+    counts[mesh] = 0;
+  }
+}
+
+void InstanceBatch::add(MeshType mesh, const glm::mat4 &transform, uint32_t sprite) {
+  std::vector<InstanceData> &instances = instancesByMesh[static_cast<uint32_t>(mesh)];
+  size_t &count = counts[static_cast<uint32_t>(mesh)];
+  const InstanceData instance{transform, sprite};
+  if (count == instances.size()) {
+    instances.push_back(instance);
+    ++generation;
+  } else if (instances[count] != instance) {
+    instances[count] = instance;
+    ++generation;
+  }
+  ++count;
+}
+
+std::span<const InstanceData> InstanceBatch::getInstances(MeshType mesh) const {
+  return std::span(instancesByMesh[static_cast<uint32_t>(mesh)])
+      .first(counts[static_cast<uint32_t>(mesh)]);
+}
+
+uint32_t InstanceBatch::getFirstInstance(MeshType mesh) const {
+  size_t first = 0;
+  for (uint32_t previous = 0; previous < static_cast<uint32_t>(mesh); ++previous) {
+    first += counts[previous];
+  }
+  return static_cast<uint32_t>(first);
+}
+
+size_t InstanceBatch::size() const {
+  size_t total = 0;
+  for (const size_t count : counts) {
+    total += count;
+  }
+  return total;
+}
+
+uint64_t InstanceBatch::getGeneration() const { return shrunk() ? generation + 1 : generation; }
+
+bool InstanceBatch::shrunk() const {
+  for (uint32_t mesh = 0; mesh < MESH_TYPE_COUNT; ++mesh) {
+    if (counts[mesh] < instancesByMesh[mesh].size()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace plaxel
@@ -0,0 +1,57 @@
+#ifndef PLAXEL_INSTANCE_BATCH_H
+#define PLAXEL_INSTANCE_BATCH_H
+
+#include <array>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <span>
+#include <vector>
+
+namespace plaxel {
+
+enum class MeshType : uint32_t { Sprite, Cube };
+constexpr uint32_t MESH_TYPE_COUNT = 2;
+
+struct alignas(16) InstanceData {
+  glm::mat4 transform;
+  uint32_t sprite;
+
+  bool operator==(const InstanceData &) const = default;
+};
+
+/**
+ * Instances to draw during the next frame, grouped by mesh type so that each mesh type ends up as
+ * a single contiguous range of the instance buffer, drawn with one indirect call.
+ *
+ * The batch is rebuilt every frame by clearing it and adding the instances again. Each instance
+ * added is compared with the one it replaces, so that the generation only changes when the
+ * contents do.
+ */
+class InstanceBatch {
+public:
+  void clear();
+  void add(MeshType mesh, const glm::mat4 &transform, uint32_t sprite);
+
+  [[nodiscard]] std::span<const InstanceData> getInstances(MeshType mesh) const;
+  /**
+   * Index of the first instance of the mesh type once every range is laid out in mesh type order
+   */
+  [[nodiscard]] uint32_t getFirstInstance(MeshType mesh) const;
+  [[nodiscard]] size_t size() const;
+  /**
+   * Equal for two states of the batch only when they hold the same instances
+   */
+  [[nodiscard]] uint64_t getGeneration() const;
+
+private:
+  // Instances of the previous build past the current count, until the next clear
+  std::array<std::vector<InstanceData>, MESH_TYPE_COUNT> instancesByMesh;
+  std::array<size_t, MESH_TYPE_COUNT> counts{};
+  uint64_t generation = 0;
+
+  [[nodiscard]] bool shrunk() const;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_INSTANCE_BATCH_H
@@ -0,0 +1,187 @@
+#include "ktx2.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace plaxel {
+
+namespace {
+constexpr std::array<uint8_t, 12> IDENTIFIER = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                                0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+// Identifier, 9 header fields and the index of the data format descriptor, key/values and
+// supercompression data
+constexpr size_t HEADER_SIZE = IDENTIFIER.size() + 9 * 4 + 4 * 4 + 2 * 8;
+constexpr size_t LEVEL_INDEX_ENTRY_SIZE = 3 * 8;
+
+// Khronos data format descriptor values
+constexpr uint32_t KHR_DF_MODEL_RGBSDA = 1;
+constexpr uint32_t KHR_DF_MODEL_BC1A = 128;
+constexpr uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+constexpr uint32_t KHR_DF_TRANSFER_SRGB = 2;
+constexpr uint32_t KHR_DF_CHANNEL_ALPHA = 15;
+constexpr uint32_t KHR_DF_SAMPLE_LINEAR = 1 << 4;
+
+void put32(std::vector<uint8_t> &out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void put64(std::vector<uint8_t> &out, uint64_t value) {
+  put32(out, static_cast<uint32_t>(value));
+  put32(out, static_cast<uint32_t>(value >> 32));
+}
+
+uint32_t get32(std::span<const uint8_t> file, size_t offset) {
+  if (offset + 4 > file.size()) {
+    throw Ktx2Error("truncated KTX2 file");
+  }
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; --i) {
+    value = value << 8 | file[offset + i];
+  }
+  return value;
+}
+
+uint64_t get64(std::span<const uint8_t> file, size_t offset) {
+  return get32(file, offset) | static_cast<uint64_t>(get32(file, offset + 4)) << 32;
+}
+
+struct Sample {
+  uint32_t bitOffset;
+  uint32_t bitLength;
+  uint32_t channel;
+  uint32_t upper;
+};
+
+/**
+ * Basic data format descriptor block, preceded by the total size of the descriptor
+ */
+std::vector<uint8_t> dataFormatDescriptor(uint32_t vkFormat) {
+  const bool compressed = vkFormat == KTX2_FORMAT_BC1_RGB_SRGB_BLOCK;
+  std::vector<Sample> samples;
+  if (compressed) {
+    samples.push_back({0, 64, 0, UINT32_MAX});
+  } else {
+    for (uint32_t channel = 0; channel < 3; ++channel) {
+      samples.push_back({channel * 8, 8, channel, 255});
+    }
+    samples.push_back({24, 8, KHR_DF_CHANNEL_ALPHA | KHR_DF_SAMPLE_LINEAR, 255});
+  }
+
+  const auto blockSize = static_cast<uint32_t>(24 + 16 * samples.size());
+  std::vector<uint8_t> descriptor;
+  put32(descriptor, 4 + blockSize);
+  // Khronos vendor, basic descriptor type
+  put32(descriptor, 0);
+  // Version 2 and block size
+  put32(descriptor, 2 | blockSize << 16);
+  put32(descriptor, (compressed ? KHR_DF_MODEL_BC1A : KHR_DF_MODEL_RGBSDA) |
+                        KHR_DF_PRIMARIES_BT709 << 8 | KHR_DF_TRANSFER_SRGB << 16);
+  // Texel block dimensions minus one
+  put32(descriptor, compressed ? 3 | 3 << 8 : 0);
+  // Bytes of the block in plane 0, other planes unused
+  put32(descriptor, compressed ? 8 : 4);
+  put32(descriptor, 0);
+  for (const auto &sample : samples) {
+    put32(descriptor, sample.bitOffset | (sample.bitLength - 1) << 16 | sample.channel << 24);
+    put32(descriptor, 0);
+    put32(descriptor, 0);
+    put32(descriptor, sample.upper);
+  }
+  return descriptor;
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+Ktx2Texture readKtx2(std::span<const uint8_t> file) {
+  if (file.size() < HEADER_SIZE ||
+      !std::equal(IDENTIFIER.begin(), IDENTIFIER.end(), file.begin())) {
+    throw Ktx2Error("not a KTX2 file");
+  }
+  size_t offset = IDENTIFIER.size();
+  const auto field = [&file, &offset] {
+    const uint32_t value = get32(file, offset);
+    offset += 4;
+    return value;
+  };
+
+  Ktx2Texture texture{};
+  texture.vkFormat = field();
+  [[maybe_unused]] const uint32_t typeSize = field();
+  texture.width = field();
+  texture.height = field();
+  const uint32_t depth = field();
+  const uint32_t layerCount = field();
+  const uint32_t faceCount = field();
+  const uint32_t levelCount = field();
+  const uint32_t supercompression = field();
+  if (depth != 0 || layerCount > 1 || faceCount != 1 || supercompression != 0) {
+    throw Ktx2Error("only single 2D textures without supercompression are supported");
+  }
+
+  offset = HEADER_SIZE;
+  for (uint32_t level = 0; level < std::max(levelCount, 1u); ++level) {
+    const uint64_t levelOffset = get64(file, offset);
+    const uint64_t levelLength = get64(file, offset + 8);
+    if (levelOffset + levelLength > file.size()) {
+      throw Ktx2Error("mip level out of the KTX2 file");
+    }
+    texture.levels.push_back({levelOffset, levelLength});
+    offset += LEVEL_INDEX_ENTRY_SIZE;
+  }
+  return texture;
+}
+
+std::vector<uint8_t> writeKtx2(uint32_t vkFormat, uint32_t width, uint32_t height,
+                               const std::vector<std::vector<uint8_t>> &levels) {
+  const std::vector<uint8_t> descriptor = dataFormatDescriptor(vkFormat);
+  const size_t descriptorOffset = HEADER_SIZE + levels.size() * LEVEL_INDEX_ENTRY_SIZE;
+  // Levels are aligned to the least common multiple of the texel block size and 4
+  const size_t alignment = vkFormat == KTX2_FORMAT_BC1_RGB_SRGB_BLOCK ? 8 : 4;
+
+  // Stored from the smallest level to the largest one, so that streaming can start early
+  std::vector<uint64_t> levelOffsets(levels.size());
+  size_t end = descriptorOffset + descriptor.size();
+  for (size_t level = levels.size(); level-- > 0;) {
+    levelOffsets[level] = alignUp(end, alignment);
+    end = levelOffsets[level] + levels[level].size();
+  }
+
+  std::vector<uint8_t> file(IDENTIFIER.begin(), IDENTIFIER.end());
+  put32(file, vkFormat);
+  // Type size is 1 for block compressed and 8 bit formats
+  put32(file, 1);
+  put32(file, width);
+  put32(file, height);
+  put32(file, 0);
+  put32(file, 0);
+  put32(file, 1);
+  put32(file, static_cast<uint32_t>(levels.size()));
+  put32(file, 0);
+  put32(file, static_cast<uint32_t>(descriptorOffset));
+  put32(file, static_cast<uint32_t>(descriptor.size()));
+  // No key/value data nor supercompression global data
+  put32(file, 0);
+  put32(file, 0);
+  put64(file, 0);
+  put64(file, 0);
+  for (size_t level = 0; level < levels.size(); ++level) {
+    put64(file, levelOffsets[level]);
+    put64(file, levels[level].size());
+    put64(file, levels[level].size());
+  }
+  file.insert(file.end(), descriptor.begin(), descriptor.end());
+
+  file.resize(end);
+  for (size_t level = 0; level < levels.size(); ++level) {
+    std::memcpy(file.data() + levelOffsets[level], levels[level].data(), levels[level].size());
+  }
+  return file;
+}
+
+} // namespace plaxel
@@ -0,0 +1,48 @@
+#ifndef PLAXEL_KTX2_H
+#define PLAXEL_KTX2_H
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace plaxel {
+
+// VkFormat values of the textures produced by the texture compiler
+constexpr uint32_t KTX2_FORMAT_R8G8B8A8_SRGB = 43;
+constexpr uint32_t KTX2_FORMAT_BC1_RGB_SRGB_BLOCK = 132;
+
+class Ktx2Error final : public std::runtime_error {
+public:
+  using runtime_error::runtime_error;
+};
+
+/**
+ * Location of one mip level inside the file
+ */
+struct Ktx2Level {
+  uint64_t offset;
+  uint64_t length;
+};
+
+/**
+ * 2D texture of a KTX2 file, levels starting with the largest one. Only the subset written by
+ * writeKtx2 is supported: a single layer and face, without supercompression.
+ */
+struct Ktx2Texture {
+  uint32_t vkFormat;
+  uint32_t width;
+  uint32_t height;
+  std::vector<Ktx2Level> levels;
+};
+
+[[nodiscard]] Ktx2Texture readKtx2(std::span<const uint8_t> file);
+/**
+ * Serialize a texture in one of the formats above, levels starting with the largest one
+ */
+[[nodiscard]] std::vector<uint8_t> writeKtx2(uint32_t vkFormat, uint32_t width, uint32_t height,
+                                             const std::vector<std::vector<uint8_t>> &levels);
+
+} // namespace plaxel
+
+#endif // PLAXEL_KTX2_H
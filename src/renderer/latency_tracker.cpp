@@ -0,0 +1,58 @@
+#include "latency_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace plaxel {
+
+namespace {
+double millisecondsBetween(LatencyTracker::Clock::time_point start,
+                           LatencyTracker::Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+double nearestRank(const std::vector<double> &sortedSamples, double percentile) {
+  const auto rank = static_cast<size_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(sortedSamples.size())));
+  return sortedSamples[std::clamp<size_t>(rank, 1, sortedSamples.size()) - 1];
+}
+} // namespace
+
+void LatencyTracker::inputReceived(Clock::time_point time) {
+  if (!pendingInput) {
+    pendingInput = time;
+  }
+}
+
+void LatencyTracker::frameSubmitted(Clock::time_point time) {
+  submittedInput = pendingInput;
+  pendingInput.reset();
+  if (submittedInput) {
+    inputToSubmitMs.push_back(millisecondsBetween(*submittedInput, time));
+  }
+}
+
+void LatencyTracker::framePresented(Clock::time_point time) {
+  if (submittedInput) {
+    inputToPresentMs.push_back(millisecondsBetween(*submittedInput, time));
+    submittedInput.reset();
+  }
+}
+
+LatencyReport LatencyTracker::takeReport() {
+  LatencyReport report{computePercentiles(inputToSubmitMs), computePercentiles(inputToPresentMs)};
+  inputToSubmitMs.clear();
+  inputToPresentMs.clear();
+  return report;
+}
+
+LatencyPercentiles computePercentiles(std::vector<double> &samplesMs) {
+  if (samplesMs.empty()) {
+    return {};
+  }
+  std::ranges::sort(samplesMs);
+  return {samplesMs.size(), nearestRank(samplesMs, 50), nearestRank(samplesMs, 95),
+          nearestRank(samplesMs, 99)};
+}
+
+} // namespace plaxel
@@ -0,0 +1,55 @@
+#ifndef PLAXEL_LATENCY_TRACKER_H
+#define PLAXEL_LATENCY_TRACKER_H
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace plaxel {
+
+struct LatencyPercentiles {
+  size_t samples = 0;
+  double p50Ms = 0;
+  double p95Ms = 0;
+  double p99Ms = 0;
+};
+
+struct LatencyReport {
+  LatencyPercentiles inputToSubmit;
+  LatencyPercentiles inputToPresent;
+};
+
+/**
+ * Measures how long the oldest input event handled by a frame waits until the frame is submitted,
+ * then presented. Inputs received between two submissions are all handled by the next frame, so
+ * only the first one of them is tracked.
+ */
+class LatencyTracker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void inputReceived(Clock::time_point time);
+  void frameSubmitted(Clock::time_point time);
+  void framePresented(Clock::time_point time);
+
+  /**
+   * Percentiles of the frames since the previous report
+   */
+  [[nodiscard]] LatencyReport takeReport();
+
+private:
+  std::optional<Clock::time_point> pendingInput;
+  std::optional<Clock::time_point> submittedInput;
+  std::vector<double> inputToSubmitMs;
+  std::vector<double> inputToPresentMs;
+};
+
+/**
+ * Nearest-rank percentiles of the samples, which are reordered
+ */
+[[nodiscard]] LatencyPercentiles computePercentiles(std::vector<double> &samplesMs);
+
+} // namespace plaxel
+
+#endif // PLAXEL_LATENCY_TRACKER_H
@@ -0,0 +1,305 @@
+#include "particle_system.h"
+#include "file_utils.h"
+#include "../world/voxel_window.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace plaxel {
+
+namespace {
+constexpr uint32_t SIMULATE_PHASE = 0;
+constexpr uint32_t FINALIZE_PHASE = 1;
+constexpr int BENCHMARK_PASSES = 8;
+constexpr float BENCHMARK_STEP_S = 1.0f / 60;
+
+// Layouts mirrored by shaders/particles.comp and shaders/particles.vert
+struct Particle {
+  glm::vec4 positionLife;
+  glm::vec4 velocitySize;
+  glm::vec4 color;
+};
+
+struct ParticleState {
+  std::array<uint32_t, 2> aliveCounts;
+  // Half of the particle buffer holding the live particles, the other one receives the survivors
+  uint32_t current;
+  uint32_t padding;
+  vk::DispatchIndirectCommand dispatch;
+  uint32_t padding2;
+  vk::DrawIndirectCommand draw;
+};
+
+// Specialization constants of shaders/particles.comp, in the order of their ids
+struct ParticleSpecialization {
+  uint32_t workgroupSize;
+  uint32_t maxParticles;
+  uint32_t maxParticlesEmittedPerFrame;
+  glm::ivec3 windowSize;
+};
+
+struct ParticlePushConstants {
+  glm::ivec4 windowOrigin;
+  float dt;
+  uint32_t emitterCount;
+  uint32_t emittedCount;
+  uint32_t phase;
+};
+
+static_assert(sizeof(ParticleEmitter) == 64, "ParticleEmitter must match its std430 layout");
+static_assert(offsetof(ParticleState, dispatch) == 16 && offsetof(ParticleState, draw) == 32,
+              "ParticleState must match its std430 layout");
+
+uint32_t workgroupCount(uint32_t invocations, uint32_t workgroupSize) {
+  return (invocations + workgroupSize - 1) / workgroupSize;
+}
+} // namespace
+
+ParticleSystem::ParticleSystem(const vk::raii::Device &logicalDevice,
+                               const vk::raii::PhysicalDevice &physicalDevice,
+                               Buffer &voxelWindowBuffer,
+                               std::span<const uint32_t> queueFamilies)
+    : device(logicalDevice) {
+  using enum vk::MemoryPropertyFlagBits;
+  using enum vk::BufferUsageFlagBits;
+
+  particleBuffer.emplace(device, physicalDevice, 2 * MAX_PARTICLES * sizeof(Particle),
+                         eStorageBuffer, eDeviceLocal, queueFamilies);
+  stateBuffer.emplace(device, physicalDevice, sizeof(ParticleState),
+                      eStorageBuffer | eIndirectBuffer | eTransferDst, eDeviceLocal, queueFamilies);
+  // Rewritten before every pass, while the previous pass is known to be complete
+  emitterBuffer.emplace(device, physicalDevice, MAX_PARTICLE_EMITTERS * sizeof(ParticleEmitter),
+                        eStorageBuffer, eHostVisible | eHostCoherent, queueFamilies);
+  pendingEmitters.reserve(MAX_PARTICLE_EMITTERS);
+
+  createDescriptorSetLayouts();
+  createDescriptorSets(voxelWindowBuffer);
+  createComputePipeline();
+}
+
+void ParticleSystem::emit(const ParticleEmitter &emitter) {
+  if (pendingEmitters.size() < MAX_PARTICLE_EMITTERS) {
+    pendingEmitters.push_back(emitter);
+  }
+}
+
+void ParticleSystem::recordCompute(vk::CommandBuffer commandBuffer,
+                                   const glm::ivec3 &windowOrigin, float dt) {
+  using enum vk::PipelineStageFlagBits;
+
+  if (!stateInitialized) {
+    initializeState(commandBuffer);
+  }
+
+  // Billboards of earlier frames reading the half of the particle buffer written below are waited
+  // for by the submission, since they may run on another queue
+
+  uint32_t emittedCount = 0;
+  for (auto &emitter : pendingEmitters) {
+    emitter.count = std::min(emitter.count, MAX_PARTICLES_EMITTED_PER_FRAME - emittedCount);
+    emittedCount += emitter.count;
+  }
+  const auto emitterCount = static_cast<uint32_t>(pendingEmitters.size());
+  if (emitterCount > 0) {
+    emitterBuffer->copyToMemory(pendingEmitters.data(), emitterCount * sizeof(ParticleEmitter), 0);
+  }
+  pendingEmitters.clear();
+
+  commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *computePipeline);
+  commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *computePipelineLayout, 0,
+                                   *computeDescriptorSet, nullptr);
+
+  ParticlePushConstants constants{glm::ivec4(windowOrigin, 0), dt, emitterCount, emittedCount,
+                                  SIMULATE_PHASE};
+  commandBuffer.pushConstants(*computePipelineLayout, vk::ShaderStageFlagBits::eCompute, 0,
+                              sizeof(constants), &constants);
+  // Sized by the previous finalize phase for the live particles plus the maximum emission
+  commandBuffer.dispatchIndirect(stateBuffer->getBuffer(), offsetof(ParticleState, dispatch));
+
+  vk::MemoryBarrier simulated;
+  simulated.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+  simulated.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+  commandBuffer.pipelineBarrier(eComputeShader, eComputeShader, {}, simulated, nullptr, nullptr);
+
+  constants.phase = FINALIZE_PHASE;
+  commandBuffer.pushConstants(*computePipelineLayout, vk::ShaderStageFlagBits::eCompute, 0,
+                              sizeof(constants), &constants);
+  commandBuffer.dispatch(1, 1, 1);
+
+  vk::MemoryBarrier finalized;
+  finalized.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+  finalized.dstAccessMask =
+      vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead;
+  // The billboards are made visible by the semaphore of the submission
+  commandBuffer.pipelineBarrier(eComputeShader, eDrawIndirect | eComputeShader, {}, finalized,
+                                nullptr, nullptr);
+}
+
+void ParticleSystem::draw(vk::CommandBuffer commandBuffer,
+                          vk::PipelineLayout pipelineLayout) const {
+  commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 1,
+                                   *drawDescriptorSet, nullptr);
+  // 6 vertices per particle, firstInstance points at the live half of the particle buffer
+  commandBuffer.drawIndirect(stateBuffer->getBuffer(), offsetof(ParticleState, draw), 1, 0);
+}
+
+vk::DescriptorSetLayout ParticleSystem::getDrawDescriptorSetLayout() const {
+  return *drawDescriptorSetLayout;
+}
+
+void ParticleSystem::createDescriptorSetLayouts() {
+  std::vector<vk::DescriptorSetLayoutBinding> computeBindings;
+  // particles, state, emitters and voxel window
+  for (uint32_t i = 0; i < 4; ++i) {
+    computeBindings.emplace_back(i, vk::DescriptorType::eStorageBuffer, 1,
+                                 vk::ShaderStageFlagBits::eCompute);
+  }
+  vk::DescriptorSetLayoutCreateInfo computeLayoutInfo;
+  computeLayoutInfo.bindingCount = static_cast<uint32_t>(computeBindings.size());
+  computeLayoutInfo.pBindings = computeBindings.data();
+  computeDescriptorSetLayout = vk::raii::DescriptorSetLayout(device, computeLayoutInfo);
+
+  const vk::DescriptorSetLayoutBinding drawBinding(0, vk::DescriptorType::eStorageBuffer, 1,
+                                                   vk::ShaderStageFlagBits::eVertex);
+  vk::DescriptorSetLayoutCreateInfo drawLayoutInfo;
+  drawLayoutInfo.bindingCount = 1;
+  drawLayoutInfo.pBindings = &drawBinding;
+  drawDescriptorSetLayout = vk::raii::DescriptorSetLayout(device, drawLayoutInfo);
+}
+
+void ParticleSystem::createDescriptorSets(Buffer &voxelWindowBuffer) {
+  vk::DescriptorPoolSize poolSize;
+  poolSize.type = vk::DescriptorType::eStorageBuffer;
+  poolSize.descriptorCount = 5;
+
+  vk::DescriptorPoolCreateInfo poolInfo;
+  poolInfo.poolSizeCount = 1;
+  poolInfo.pPoolSizes = &poolSize;
+  poolInfo.maxSets = 2;
+  poolInfo.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
+  descriptorPool = vk::raii::DescriptorPool(device, poolInfo);
+
+  const std::array layouts = {*computeDescriptorSetLayout, *drawDescriptorSetLayout};
+  vk::DescriptorSetAllocateInfo allocInfo;
+  allocInfo.descriptorPool = *descriptorPool;
+  allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+  allocInfo.pSetLayouts = layouts.data();
+
+  auto descriptorSets = vk::raii::DescriptorSets(device, allocInfo);
+  computeDescriptorSet = std::move(descriptorSets[0]);
+  drawDescriptorSet = std::move(descriptorSets[1]);
+
+  std::vector<vk::WriteDescriptorSet> descriptorWrites;
+  descriptorWrites.push_back(
+      particleBuffer->getDescriptorWriteForCompute(*computeDescriptorSet, 0));
+  descriptorWrites.push_back(stateBuffer->getDescriptorWriteForCompute(*computeDescriptorSet, 1));
+  descriptorWrites.push_back(
+      emitterBuffer->getDescriptorWriteForCompute(*computeDescriptorSet, 2));
+  descriptorWrites.push_back(
+      voxelWindowBuffer.getDescriptorWriteForCompute(*computeDescriptorSet, 3));
+  device.updateDescriptorSets(descriptorWrites, nullptr);
+
+  device.updateDescriptorSets(particleBuffer->getDescriptorWriteForCompute(*drawDescriptorSet, 0),
+                              nullptr);
+}
+
+void ParticleSystem::reloadComputePipeline() { createComputePipeline(); }
+
+void ParticleSystem::setWorkgroupSize(uint32_t size) {
+  workgroupSize = size;
+  createComputePipeline();
+  // The next dispatch of the state buffer was sized for the previous workgroup size
+  stateInitialized = false;
+}
+
+void ParticleSystem::recordBenchmark(vk::CommandBuffer commandBuffer) {
+  stateInitialized = false;
+  ParticleEmitter emitter;
+  emitter.position.w = 8.f;
+  emitter.velocity.w = 4.f;
+  emitter.count = MAX_PARTICLES_EMITTED_PER_FRAME;
+  // Outlives the benchmark, so that every pass simulates the particles of the previous ones
+  emitter.lifetime = 2 * BENCHMARK_PASSES * BENCHMARK_STEP_S;
+  // Centered on the emitter, so that particles collide against whatever the window holds
+  const glm::ivec3 windowOrigin(-VOXEL_WINDOW_SIZE_X / 2, -VOXEL_WINDOW_SIZE_Y / 2,
+                                -VOXEL_WINDOW_SIZE_Z / 2);
+  for (int pass = 0; pass < BENCHMARK_PASSES; ++pass) {
+    emit(emitter);
+    recordCompute(commandBuffer, windowOrigin, BENCHMARK_STEP_S);
+  }
+  stateInitialized = false;
+}
+
+void ParticleSystem::createComputePipeline() {
+  const auto shaderCode = files::readFile("shaders/particles.comp.spv");
+  vk::ShaderModuleCreateInfo moduleInfo;
+  moduleInfo.codeSize = shaderCode.size();
+  moduleInfo.pCode = reinterpret_cast<const uint32_t *>(shaderCode.data());
+  const vk::raii::ShaderModule shaderModule(device, moduleInfo);
+
+  vk::PushConstantRange pushConstantRange;
+  pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
+  pushConstantRange.offset = 0;
+  pushConstantRange.size = sizeof(ParticlePushConstants);
+
+  vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
+  pipelineLayoutInfo.setLayoutCount = 1;
+  pipelineLayoutInfo.pSetLayouts = &*computeDescriptorSetLayout;
+  pipelineLayoutInfo.pushConstantRangeCount = 1;
+  pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+  computePipelineLayout = vk::raii::PipelineLayout(device, pipelineLayoutInfo);
+
+  const ParticleSpecialization specialization{
+      workgroupSize, MAX_PARTICLES, MAX_PARTICLES_EMITTED_PER_FRAME,
+      glm::ivec3(VOXEL_WINDOW_SIZE_X, VOXEL_WINDOW_SIZE_Y, VOXEL_WINDOW_SIZE_Z)};
+  const std::array<vk::SpecializationMapEntry, 6> specializationEntries = {
+      vk::SpecializationMapEntry{0, offsetof(ParticleSpecialization, workgroupSize), 4},
+      vk::SpecializationMapEntry{1, offsetof(ParticleSpecialization, maxParticles), 4},
+      vk::SpecializationMapEntry{2, offsetof(ParticleSpecialization, maxParticlesEmittedPerFrame),
+                                 4},
+      vk::SpecializationMapEntry{3, offsetof(ParticleSpecialization, windowSize), 4},
+      vk::SpecializationMapEntry{4, offsetof(ParticleSpecialization, windowSize) + 4, 4},
+      vk::SpecializationMapEntry{5, offsetof(ParticleSpecialization, windowSize) + 8, 4}};
+  vk::SpecializationInfo specializationInfo;
+  specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+  specializationInfo.pMapEntries = specializationEntries.data();
+  specializationInfo.dataSize = sizeof(specialization);
+  specializationInfo.pData = &specialization;
+
+  vk::PipelineShaderStageCreateInfo stageInfo;
+  stageInfo.stage = vk::ShaderStageFlagBits::eCompute;
+  stageInfo.module = *shaderModule;
+  stageInfo.pName = "main";
+  stageInfo.pSpecializationInfo = &specializationInfo;
+
+  vk::ComputePipelineCreateInfo pipelineInfo;
+  pipelineInfo.layout = *computePipelineLayout;
+  pipelineInfo.stage = stageInfo;
+  computePipeline = vk::raii::Pipeline(device, nullptr, pipelineInfo);
+}
+
+/**
+ * The state is written from the compute command buffer rather than with a staging copy, the
+ * first pass then starts from an empty particle list sized for a full emission
+ */
+void ParticleSystem::initializeState(vk::CommandBuffer commandBuffer) {
+  ParticleState state{};
+  state.dispatch =
+      vk::DispatchIndirectCommand(workgroupCount(MAX_PARTICLES_EMITTED_PER_FRAME, workgroupSize),
+                                  1, 1);
+  state.draw = vk::DrawIndirectCommand(6, 0, 0, 0);
+  commandBuffer.updateBuffer(stateBuffer->getBuffer(), 0, sizeof(state), &state);
+
+  vk::MemoryBarrier barrier;
+  barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+  barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite |
+                          vk::AccessFlagBits::eIndirectCommandRead;
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eComputeShader |
+                                    vk::PipelineStageFlagBits::eDrawIndirect,
+                                {}, barrier, nullptr, nullptr);
+  stateInitialized = true;
+}
+
+} // namespace plaxel
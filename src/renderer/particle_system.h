@@ -0,0 +1,111 @@
+#ifndef PLAXEL_PARTICLE_SYSTEM_H
+#define PLAXEL_PARTICLE_SYSTEM_H
+
+#include "Buffer.h"
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace plaxel {
+
+// Passed to shaders/particles.comp as specialization constants
+constexpr uint32_t MAX_PARTICLES = 65536;
+constexpr uint32_t MAX_PARTICLES_EMITTED_PER_FRAME = 4096;
+constexpr uint32_t MAX_PARTICLE_EMITTERS = 256;
+// Used until a size tuned for the device is set
+constexpr uint32_t DEFAULT_PARTICLE_WORKGROUP_SIZE = 256;
+
+/**
+ * Burst of particles spawned by the GPU on the next compute pass. This is all the CPU ever knows
+ * about particles: their state only lives in GPU buffers.
+ */
+struct ParticleEmitter {
+  // w is the radius of the sphere the particles are spawned in
+  glm::vec4 position{0.f};
+  // w is the random deviation added to each particle velocity
+  glm::vec4 velocity{0.f};
+  glm::vec4 color{1.f};
+  uint32_t count = 0;
+  float lifetime = 1.f;
+  float size = .1f;
+  uint32_t seed = 0;
+};
+
+/**
+ * Particles simulated entirely on the GPU. Each compute pass spawns the requested emitters,
+ * integrates the live particles, bounces them against the voxel window and compacts the survivors
+ * into the other half of a double buffered particle list. The same pass writes the arguments of
+ * the next dispatch and of the indirect billboard draw, so particle counts never go through the
+ * CPU either.
+ */
+class ParticleSystem {
+public:
+  /**
+   * The buffers are shared between the given queue families, which simulate and draw the particles
+   */
+  ParticleSystem(const vk::raii::Device &logicalDevice,
+                 const vk::raii::PhysicalDevice &physicalDevice, Buffer &voxelWindowBuffer,
+                 std::span<const uint32_t> queueFamilies = {});
+
+  /**
+   * Queue an emitter for the next compute pass. Emitters beyond MAX_PARTICLE_EMITTERS per pass
+   * are dropped, particles beyond MAX_PARTICLES_EMITTED_PER_FRAME are not spawned.
+   */
+  void emit(const ParticleEmitter &emitter);
+
+  /**
+   * Record one simulation step in the compute command buffer, whose previous submission must be
+   * complete
+   */
+  void recordCompute(vk::CommandBuffer commandBuffer, const glm::ivec3 &windowOrigin, float dt);
+  /**
+   * Draw the particles as billboards, the particle pipeline and its set 0 must already be bound
+   */
+  void draw(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout) const;
+
+  [[nodiscard]] vk::DescriptorSetLayout getDrawDescriptorSetLayout() const;
+  /**
+   * Rebuild the simulation pipeline from the current shader, while the device is idle
+   */
+  void reloadComputePipeline();
+  /**
+   * Rebuild the simulation pipeline for another workgroup size, while the device is idle. Live
+   * particles are dropped.
+   */
+  void setWorkgroupSize(uint32_t size);
+  /**
+   * Record a few passes spawning and simulating as many particles as they can, to time the
+   * simulation. The particles are dropped by the next pass.
+   */
+  void recordBenchmark(vk::CommandBuffer commandBuffer);
+
+private:
+  const vk::raii::Device &device;
+
+  std::optional<Buffer> particleBuffer;
+  std::optional<Buffer> stateBuffer;
+  std::optional<Buffer> emitterBuffer;
+  bool stateInitialized = false;
+  uint32_t workgroupSize = DEFAULT_PARTICLE_WORKGROUP_SIZE;
+  std::vector<ParticleEmitter> pendingEmitters;
+
+  vk::raii::DescriptorPool descriptorPool = nullptr;
+  vk::raii::DescriptorSetLayout computeDescriptorSetLayout = nullptr;
+  vk::raii::DescriptorSetLayout drawDescriptorSetLayout = nullptr;
+  vk::raii::DescriptorSet computeDescriptorSet = nullptr;
+  vk::raii::DescriptorSet drawDescriptorSet = nullptr;
+  vk::raii::PipelineLayout computePipelineLayout = nullptr;
+  vk::raii::Pipeline computePipeline = nullptr;
+
+  void createDescriptorSetLayouts();
+  void createDescriptorSets(Buffer &voxelWindowBuffer);
+  void createComputePipeline();
+  void initializeState(vk::CommandBuffer commandBuffer);
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_PARTICLE_SYSTEM_H
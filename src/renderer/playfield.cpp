@@ -0,0 +1,63 @@
+#include "playfield.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace plaxel {
+
+namespace {
+int toChunk(float coordinate) {
+  return static_cast<int>(std::floor(coordinate / static_cast<float>(CHUNK_SIZE)));
+}
+} // namespace
+
+Playfield::Playfield(const PlayfieldLayout &playfieldLayout) : layout(playfieldLayout) {}
+
+const PlayfieldLayout &Playfield::getLayout() const { return layout; }
+
+PlayfieldLayer Playfield::layerOf(float depth) const {
+  if (depth < layout.layerBounds[1]) {
+    return PlayfieldLayer::Foreground;
+  }
+  if (depth < layout.layerBounds[2]) {
+    return PlayfieldLayer::Playfield;
+  }
+  return PlayfieldLayer::Background;
+}
+
+std::vector<PlayfieldRow> Playfield::visibleRows(const glm::vec3 &eye,
+                                                 const glm::vec2 &tanHalfFieldOfView) const {
+  std::vector<PlayfieldRow> rows;
+  const auto direction = static_cast<float>(layout.depthDirection);
+  const float eyeDepth = direction * eye[layout.depthAxis];
+  const float nearest = std::max(layout.layerBounds[0], eyeDepth);
+  const float farthest = layout.layerBounds[3];
+  if (nearest >= farthest) {
+    return rows;
+  }
+
+  // Chunk coordinates along the depth axis, in the order of increasing depth
+  const int firstChunk = toChunk(direction * std::nextafter(nearest, farthest));
+  const int lastChunk = toChunk(direction * std::nextafter(farthest, nearest));
+  for (int depthChunk = firstChunk;; depthChunk += layout.depthDirection) {
+    const float rowBegin = direction * static_cast<float>(depthChunk * CHUNK_SIZE);
+    const float rowEnd = direction * static_cast<float>((depthChunk + 1) * CHUNK_SIZE);
+    // The visible area is widest at the far side of the row
+    const float distance = std::max(rowBegin, rowEnd) - eyeDepth;
+    const float halfWidth = distance * tanHalfFieldOfView.x + layout.margin;
+    const float halfHeight = distance * tanHalfFieldOfView.y + layout.margin;
+    const float scroll = eye[layout.scrollAxis];
+    const float vertical = eye[layout.verticalAxis];
+
+    rows.push_back({depthChunk,
+                    {toChunk(scroll - halfWidth), toChunk(scroll + halfWidth)},
+                    {toChunk(vertical - halfHeight), toChunk(vertical + halfHeight)},
+                    layerOf((rowBegin + rowEnd) / 2)});
+    if (depthChunk == lastChunk) {
+      break;
+    }
+  }
+  return rows;
+}
+
+} // namespace plaxel
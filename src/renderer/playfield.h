@@ -0,0 +1,90 @@
+#ifndef PLAXEL_PLAYFIELD_H
+#define PLAXEL_PLAYFIELD_H
+
+#include "../world/world.h"
+
+#include <array>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace plaxel {
+
+enum class PlayfieldLayer { Foreground, Playfield, Background };
+
+/**
+ * How a side scroller looks at the world: the camera moves along the scroll axis and always looks
+ * down the depth axis, through a foreground, the playfield slab and a background
+ */
+struct PlayfieldLayout {
+  int scrollAxis = 0;
+  int verticalAxis = 1;
+  int depthAxis = 2;
+  // 1 when the camera looks towards increasing coordinates along the depth axis, -1 otherwise
+  int depthDirection = -1;
+  // Depths where the foreground, the playfield and the background start, then where the
+  // background ends. Depths are coordinates along the depth axis, increasing into the screen.
+  std::array<float, 4> layerBounds{-32.f, -8.f, 8.f, 256.f};
+  // Where the camera stays, in front of the foreground
+  float cameraDepth = -48.f;
+  // Kept around the visible area so that chunks appear beyond the edges of the screen
+  float margin = CHUNK_SIZE;
+};
+
+/**
+ * Chunks of one depth row that can be on screen
+ */
+struct PlayfieldRow {
+  int depthChunk;
+  // Inclusive ranges of chunk coordinates
+  glm::ivec2 scrollChunks;
+  glm::ivec2 verticalChunks;
+  PlayfieldLayer layer;
+};
+
+/**
+ * Schedules the chunks to draw without testing them against the frustum: since the viewing
+ * direction is fixed, the visible chunks of each depth row form a rectangle growing with the
+ * distance to the camera. Rows are visited front to back so that near geometry fills the depth
+ * buffer first and hides the rest early.
+ */
+class Playfield {
+public:
+  explicit Playfield(const PlayfieldLayout &playfieldLayout);
+
+  [[nodiscard]] const PlayfieldLayout &getLayout() const;
+  [[nodiscard]] PlayfieldLayer layerOf(float depth) const;
+
+  /**
+   * Visible rows from front to back, tanHalfFieldOfView being the tangent of half the horizontal
+   * and vertical fields of view
+   */
+  [[nodiscard]] std::vector<PlayfieldRow> visibleRows(const glm::vec3 &eye,
+                                                      const glm::vec2 &tanHalfFieldOfView) const;
+
+  /**
+   * Call f(chunkPos, layer) for every chunk position that may be visible, front to back
+   */
+  template <typename F>
+  void forEachVisibleChunk(const glm::vec3 &eye, const glm::vec2 &tanHalfFieldOfView,
+                           F &&f) const {
+    for (const auto &row : visibleRows(eye, tanHalfFieldOfView)) {
+      glm::ivec3 chunkPos;
+      chunkPos[layout.depthAxis] = row.depthChunk;
+      for (int vertical = row.verticalChunks.x; vertical <= row.verticalChunks.y; ++vertical) {
+        chunkPos[layout.verticalAxis] = vertical;
+        for (int scroll = row.scrollChunks.x; scroll <= row.scrollChunks.y; ++scroll) {
+          chunkPos[layout.scrollAxis] = scroll;
+          f(chunkPos, row.layer);
+        }
+      }
+    }
+  }
+
+private:
+  PlayfieldLayout layout;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_PLAYFIELD_H
@@ -0,0 +1,54 @@
+#include "queue_families.h"
+
+#include <algorithm>
+
+namespace plaxel {
+
+std::vector<uint32_t> QueueFamilyIndices::getSharingFamilies() const {
+  std::vector<uint32_t> families;
+  for (const auto &family : {graphicsAndComputeFamily, computeFamily, transferFamily}) {
+    if (family && std::ranges::find(families, *family) == families.end()) {
+      families.push_back(*family);
+    }
+  }
+  return families;
+}
+
+QueueFamilyIndices
+selectQueueFamilies(const std::vector<vk::QueueFamilyProperties> &queueFamilies,
+                    const std::function<bool(uint32_t)> &supportsPresent) {
+  using enum vk::QueueFlagBits;
+  QueueFamilyIndices indices;
+
+  for (uint32_t i = 0; i < queueFamilies.size(); ++i) {
+    const vk::QueueFlags flags = queueFamilies[i].queueFlags;
+    if (queueFamilies[i].queueCount == 0) {
+      continue;
+    }
+    if (!indices.graphicsAndComputeFamily && (flags & eGraphics) && (flags & eCompute)) {
+      indices.graphicsAndComputeFamily = i;
+    }
+    if (!indices.computeFamily && (flags & eCompute) && !(flags & eGraphics)) {
+      indices.computeFamily = i;
+    }
+    if (!indices.transferFamily && (flags & eTransfer) && !(flags & eGraphics) &&
+        !(flags & eCompute)) {
+      indices.transferFamily = i;
+    }
+    // Presenting from the graphics family avoids sharing the swap chain images
+    if (supportsPresent(i) &&
+        (!indices.presentFamily || indices.graphicsAndComputeFamily == i)) {
+      indices.presentFamily = i;
+    }
+  }
+
+  if (!indices.computeFamily) {
+    indices.computeFamily = indices.graphicsAndComputeFamily;
+  }
+  if (!indices.transferFamily) {
+    indices.transferFamily = indices.graphicsAndComputeFamily;
+  }
+  return indices;
+}
+
+} // namespace plaxel
@@ -0,0 +1,43 @@
+#ifndef PLAXEL_QUEUE_FAMILIES_H
+#define PLAXEL_QUEUE_FAMILIES_H
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace plaxel {
+
+struct QueueFamilyIndices {
+  std::optional<uint32_t> graphicsAndComputeFamily;
+  std::optional<uint32_t> presentFamily;
+  // Dedicated families when the device has them, otherwise the graphics one
+  std::optional<uint32_t> computeFamily;
+  std::optional<uint32_t> transferFamily;
+
+  [[nodiscard]] bool isComplete() const {
+    return graphicsAndComputeFamily.has_value() && presentFamily.has_value();
+  }
+  [[nodiscard]] bool hasAsyncCompute() const { return computeFamily != graphicsAndComputeFamily; }
+  [[nodiscard]] bool hasDedicatedTransfer() const {
+    return transferFamily != graphicsAndComputeFamily;
+  }
+  /**
+   * Distinct families of the graphics, compute and transfer queues, for resources shared between
+   * them without ownership transfers
+   */
+  [[nodiscard]] std::vector<uint32_t> getSharingFamilies() const;
+};
+
+/**
+ * Pick the graphics and present families, and the families with the fewest other capabilities for
+ * compute and transfers, since those usually map to independent hardware queues
+ */
+[[nodiscard]] QueueFamilyIndices
+selectQueueFamilies(const std::vector<vk::QueueFamilyProperties> &queueFamilies,
+                    const std::function<bool(uint32_t)> &supportsPresent);
+
+} // namespace plaxel
+
+#endif // PLAXEL_QUEUE_FAMILIES_H
@@ -1,17 +1,82 @@
 #include "renderer.h"
 #include "file_utils.h"
+#include "ktx2.h"
+#include "tuning_cache.h"
+#include <bit>
+#include <cmath>
 #include <cmrc/cmrc.hpp>
+#include <limits>
 #include <random>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
 namespace plaxel {
 
+namespace {
+// Workgroup sizes tried for the particle simulation, powers of two within the device limits
+constexpr uint32_t MIN_TUNED_WORKGROUP_SIZE = 32;
+constexpr uint32_t MAX_TUNED_WORKGROUP_SIZE = 1024;
+// Each size keeps its best run, the first ones also pay for warming up the caches
+constexpr int TUNING_RUNS = 3;
+constexpr const char *PARTICLE_WORKGROUP_SIZE_PARAMETER = "particles.workgroup_size";
+
+void addQuad(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, const glm::vec3 &center,
+             const glm::vec3 &tangent, const glm::vec3 &bitangent) {
+  const auto first = static_cast<uint32_t>(vertices.size());
+  vertices.push_back({center - tangent * .5f - bitangent * .5f, {0.f, 1.f}});
+  vertices.push_back({center + tangent * .5f - bitangent * .5f, {1.f, 1.f}});
+  vertices.push_back({center + tangent * .5f + bitangent * .5f, {1.f, 0.f}});
+  vertices.push_back({center - tangent * .5f + bitangent * .5f, {0.f, 0.f}});
+  for (const uint32_t corner : {0u, 1u, 2u, 2u, 3u, 0u}) {
+    indices.push_back(first + corner);
+  }
+}
+
+vk::VertexInputBindingDescription getInstanceBindingDescription() {
+  vk::VertexInputBindingDescription bindingDescription;
+  bindingDescription.binding = 1;
+  bindingDescription.stride = sizeof(InstanceData);
+  bindingDescription.inputRate = vk::VertexInputRate::eInstance;
+  return bindingDescription;
+}
+
+vk::VertexInputBindingDescription getTerrainBindingDescription() {
+  vk::VertexInputBindingDescription bindingDescription;
+  bindingDescription.binding = 0;
+  bindingDescription.stride = sizeof(TerrainVertex);
+  return bindingDescription;
+}
+
+std::vector<vk::VertexInputAttributeDescription> getTerrainAttributeDescriptions() {
+  std::vector<vk::VertexInputAttributeDescription> attributeDescriptions;
+  attributeDescriptions.emplace_back(0, 0, vk::Format::eR32G32B32Sfloat,
+                                     offsetof(TerrainVertex, position));
+  attributeDescriptions.emplace_back(1, 0, vk::Format::eR32Uint, offsetof(TerrainVertex, data));
+  return attributeDescriptions;
+}
+
+std::vector<vk::VertexInputAttributeDescription> getInstanceAttributeDescriptions() {
+  std::vector<vk::VertexInputAttributeDescription> attributeDescriptions;
+  for (uint32_t column = 0; column < 4; ++column) {
+    attributeDescriptions.emplace_back(2 + column, 1, vk::Format::eR32G32B32A32Sfloat,
+                                       offsetof(InstanceData, transform) +
+                                           column * sizeof(glm::vec4));
+  }
+  attributeDescriptions.emplace_back(6, 1, vk::Format::eR32Uint, offsetof(InstanceData, sprite));
+  return attributeDescriptions;
+}
+} // namespace
+
 void Renderer::initVulkan() {
   BaseRenderer::initVulkan();
 
   createComputeBuffers();
+  createMeshBuffers();
+  createInstancedPipeline();
+  createTerrainPipeline();
+  createVoxelWindowBuffers();
+  particleSystem.emplace(device, physicalDevice, *voxelWindowBuffer,
+                         queueFamilies.getSharingFamilies());
+  tuneParticleWorkgroupSize();
+  createParticlePipeline();
 
   createTextureImage();
   createTextureImageView();
@@ -67,24 +132,281 @@ void Renderer::recordComputeCommandBuffer(vk::CommandBuffer commandBuffer) {
 
   commandBuffer.begin(beginInfo);
 
+  uploadVoxelWindow(commandBuffer);
+
   commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *computePipeline);
 
   commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *computePipelineLayout, 0,
                                    *computeDescriptorSet, nullptr);
   commandBuffer.dispatch(1, 1, 1);
 
+  const auto now = std::chrono::steady_clock::now();
+  // Clamped so that particles do not tunnel through blocks after a long frame
+  const float dt = std::min(std::chrono::duration<float>(now - lastParticleStep).count(),
+                            MAX_PARTICLE_STEP_S);
+  lastParticleStep = now;
+  const glm::ivec3 windowOrigin = voxelWindow ? voxelWindow->getOrigin() : glm::ivec3(0);
+  particleSystem->recordCompute(commandBuffer, windowOrigin, dt);
+
   commandBuffer.end();
 }
 
-void Renderer::drawCommand(vk::CommandBuffer commandBuffer) const {
-  const std::vector<vk::DeviceSize> offsets = {0};
-  commandBuffer.bindVertexBuffers(0, vertexBuffer->getBuffer(), offsets);
-  commandBuffer.bindIndexBuffer(indexBuffer->getBuffer(), 0, vk::IndexType::eUint32);
+/**
+ * Copy the voxels edited since the previous frame into the voxel window buffer. Called while the
+ * previous compute submission is known to be complete, so the staging buffer is free to reuse.
+ */
+void Renderer::uploadVoxelWindow(vk::CommandBuffer commandBuffer) {
+  if (!voxelWindow) {
+    return;
+  }
+  const auto [firstWord, endWord] = voxelWindow->takeDirtyWords();
+  if (firstWord == endWord) {
+    return;
+  }
+
+  const vk::DeviceSize offset = firstWord * sizeof(uint32_t);
+  const vk::DeviceSize size = (endWord - firstWord) * sizeof(uint32_t);
+  voxelWindowStagingBuffer->copyToMemory(voxelWindow->getWords().data() + firstWord, size, offset);
+
+  vk::BufferCopy copyRegion;
+  copyRegion.srcOffset = offset;
+  copyRegion.dstOffset = offset;
+  copyRegion.size = size;
+  commandBuffer.copyBuffer(voxelWindowStagingBuffer->getBuffer(), voxelWindowBuffer->getBuffer(),
+                           copyRegion);
+
+  vk::MemoryBarrier barrier;
+  barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+  barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eComputeShader, {}, barrier, nullptr,
+                                nullptr);
+}
 
+/**
+ * The first stream starts with the main mesh and the last one ends with the instances and the
+ * particles, the terrain being shared between all of them
+ */
+void Renderer::drawCommand(vk::CommandBuffer commandBuffer, uint32_t stream,
+                           uint32_t streamCount) const {
   commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipelineLayout, 0,
-                                   *descriptorSets[currentFrame], nullptr);
+                                   *descriptorSet, nullptr);
 
-  commandBuffer.drawIndexedIndirect(drawCommandBuffer->getBuffer(), 0, 1, 0);
+  if (stream == 0) {
+    const std::vector<vk::DeviceSize> offsets = {0};
+    commandBuffer.bindVertexBuffers(0, vertexBuffer->getBuffer(), offsets);
+    commandBuffer.bindIndexBuffer(indexBuffer->getBuffer(), 0, vk::IndexType::eUint32);
+    commandBuffer.drawIndexedIndirect(drawCommandBuffer->getBuffer(), 0, 1, 0);
+  }
+
+  drawTerrain(commandBuffer, stream, streamCount);
+
+  if (stream == streamCount - 1) {
+    drawInstances(commandBuffer);
+    drawParticles(commandBuffer);
+  }
+}
+
+/**
+ * Draw the stream's contiguous share of the visible chunks, keeping their order across streams.
+ * The terrain shares the layout and descriptor set of the main pipeline.
+ */
+void Renderer::drawTerrain(vk::CommandBuffer commandBuffer, uint32_t stream,
+                           uint32_t streamCount) const {
+  const size_t begin = visibleChunks.size() * stream / streamCount;
+  const size_t end = visibleChunks.size() * (stream + 1) / streamCount;
+  if (begin == end) {
+    return;
+  }
+  commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *terrainPipeline);
+  for (size_t i = begin; i < end; ++i) {
+    drawTerrainChunk(commandBuffer, visibleChunks[i].first, *visibleChunks[i].second);
+  }
+}
+
+/**
+ * Chunks drawn by the frame. With a playfield, chunks outside of the visible slab are never looked
+ * at.
+ */
+void Renderer::collectVisibleChunks() {
+  visibleChunks.clear();
+  if (!playfield) {
+    for (const auto &[chunkPos, chunk] : terrainChunks) {
+      visibleChunks.emplace_back(chunkPos, &chunk);
+    }
+    return;
+  }
+  playfield->forEachVisibleChunk(getCamera().getEyePosition(), getTanHalfFieldOfView(),
+                                 [this](const glm::ivec3 &chunkPos, PlayfieldLayer) {
+                                   const auto chunk = terrainChunks.find(chunkPos);
+                                   if (chunk != terrainChunks.end()) {
+                                     visibleChunks.emplace_back(chunkPos, &chunk->second);
+                                   }
+                                 });
+}
+
+/**
+ * Each chunk is drawn at the coarsest level of detail whose cells stay small on screen at its
+ * nearest depth. Its vertices are relative to its origin, which is pushed with the camera.
+ */
+void Renderer::drawTerrainChunk(vk::CommandBuffer commandBuffer, const glm::ivec3 &chunkPos,
+                                const TerrainChunk &chunk) const {
+  const glm::vec3 center = glm::vec3(chunkPos * CHUNK_SIZE) + CHUNK_SIZE / 2.f;
+  const float depth = getCamera().getDepth(center) - CHUNK_BOUNDING_RADIUS;
+  int lod = depth > MIN_LOD_DEPTH ? selectLod(getPixelsPerUnitAtUnitDepth() / depth) : 0;
+  while (lod > 0 && !chunk.built[lod]) {
+    lod--;
+  }
+  const auto &mesh = chunk.lods[lod];
+  if (!mesh) {
+    return;
+  }
+  pushCamera(commandBuffer, *pipelineLayout, glm::vec3(chunkPos * CHUNK_SIZE));
+  constexpr vk::DeviceSize offset = 0;
+  commandBuffer.bindVertexBuffers(0, mesh->vertices.getBuffer(), offset);
+  commandBuffer.bindIndexBuffer(mesh->indices.getBuffer(), 0, vk::IndexType::eUint32);
+  commandBuffer.drawIndexed(mesh->indexCount, 1, 0, 0, 0);
+}
+
+/**
+ * Draw every instance of the frame with one indirect call per mesh type. The descriptor set bound
+ * for the main pipeline stays valid since both pipelines share the same layout, only the offset
+ * left by the terrain chunks is reset.
+ */
+void Renderer::drawInstances(vk::CommandBuffer commandBuffer) const {
+  if (frameInstanceCounts[currentFrame] == 0) {
+    return;
+  }
+
+  commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *instancedPipeline);
+  pushCamera(commandBuffer, *pipelineLayout);
+
+  const std::array buffers = {meshVertexBuffer->getBuffer(),
+                              instanceBuffers[currentFrame].getBuffer()};
+  const std::array<vk::DeviceSize, 2> offsets = {0, 0};
+  commandBuffer.bindVertexBuffers(0, buffers, offsets);
+  commandBuffer.bindIndexBuffer(meshIndexBuffer->getBuffer(), 0, vk::IndexType::eUint32);
+
+  for (uint32_t mesh = 0; mesh < MESH_TYPE_COUNT; ++mesh) {
+    commandBuffer.drawIndexedIndirect(instanceDrawCommandBuffers[currentFrame].getBuffer(),
+                                      mesh * sizeof(vk::DrawIndexedIndirectCommand), 1,
+                                      sizeof(vk::DrawIndexedIndirectCommand));
+  }
+}
+
+/**
+ * The particle count is only known by the GPU, so the draw is always recorded and may be empty
+ */
+void Renderer::drawParticles(vk::CommandBuffer commandBuffer) const {
+  commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *particlePipeline);
+  commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *particlePipelineLayout, 0,
+                                   *descriptorSet, nullptr);
+  pushCamera(commandBuffer, *particlePipelineLayout);
+  particleSystem->draw(commandBuffer, *particlePipelineLayout);
+}
+
+void Renderer::prepareFrame(uint32_t frame) {
+  const size_t instanceCount = instanceBatch.size();
+  if (instanceCount * sizeof(InstanceData) > instanceBuffers[frame].getSize()) {
+    // The fence of the frame was waited on, so its previous buffer is no longer read
+    instanceBuffers[frame] = createInstanceBuffer(std::bit_ceil(instanceCount));
+  }
+
+  std::array<vk::DrawIndexedIndirectCommand, MESH_TYPE_COUNT> commands;
+  for (uint32_t mesh = 0; mesh < MESH_TYPE_COUNT; ++mesh) {
+    const auto instances = instanceBatch.getInstances(static_cast<MeshType>(mesh));
+    const uint32_t firstInstance = instanceBatch.getFirstInstance(static_cast<MeshType>(mesh));
+    if (!instances.empty()) {
+      instanceBuffers[frame].copyToMemory(instances.data(),
+                                          instances.size() * sizeof(InstanceData),
+                                          firstInstance * sizeof(InstanceData));
+    }
+
+    const MeshRange &range = meshRanges[mesh];
+    commands[mesh] = vk::DrawIndexedIndirectCommand(range.indexCount,
+                                                    static_cast<uint32_t>(instances.size()),
+                                                    range.firstIndex, range.vertexOffset,
+                                                    firstInstance);
+  }
+
+  instanceDrawCommandBuffers[frame].copyToMemory(commands.data(), sizeof(commands), 0);
+  frameInstanceCounts[frame] = static_cast<uint32_t>(instanceCount);
+  drawnInstanceGeneration = instanceBatch.getGeneration();
+
+  while (!retiredTerrainMeshes.empty() &&
+         areFramesDone(retiredTerrainMeshes.front().retiredAtFrame)) {
+    retiredTerrainMeshes.pop_front();
+  }
+
+  collectVisibleChunks();
+}
+
+bool Renderer::isAnimating() const {
+  return instanceBatch.getGeneration() != drawnInstanceGeneration ||
+         std::chrono::steady_clock::now() < particlesAliveUntil;
+}
+
+InstanceBatch &Renderer::getInstanceBatch() { return instanceBatch; }
+
+void Renderer::updateTerrain(const std::vector<ChunkMeshUpdate> &meshes) {
+  using enum vk::BufferUsageFlagBits;
+  if (meshes.empty()) {
+    return;
+  }
+  requestRedraw();
+  for (const auto &[chunkPos, lod, mesh] : meshes) {
+    TerrainChunk &chunk = terrainChunks[chunkPos];
+    chunk.built.set(lod);
+    if (chunk.lods[lod]) {
+      // Its upload may only be waited on by the next frame
+      retiredTerrainMeshes.push_back({std::move(*chunk.lods[lod]), getSubmittedFrameCount() + 1});
+      chunk.lods[lod].reset();
+    }
+    if (mesh.indices.empty()) {
+      continue;
+    }
+    // Stored relative to the chunk, keeping the precision of far away vertices
+    const glm::vec3 origin(chunkPos * CHUNK_SIZE);
+    std::vector<TerrainVertex> vertices = mesh.vertices;
+    for (auto &vertex : vertices) {
+      vertex.position -= origin;
+    }
+    chunk.lods[lod] = TerrainMeshBuffers{
+        createBufferWithInitialData(eVertexBuffer, vertices.data(),
+                                    vertices.size() * sizeof(TerrainVertex)),
+        createBufferWithInitialData(eIndexBuffer, mesh.indices.data(),
+                                    mesh.indices.size() * sizeof(uint32_t)),
+        static_cast<uint32_t>(mesh.indices.size())};
+  }
+}
+
+void Renderer::setWorld(World &world) {
+  voxelWindow.emplace(world);
+  world.addEditListener([this](const BlockEdit &edit) {
+    voxelWindow->onEdit(edit);
+    requestRedraw();
+  });
+}
+
+void Renderer::setPlayfield(const PlayfieldLayout &layout) {
+  // The camera only turns around the y axis
+  if (layout.verticalAxis != 1) {
+    throw NotImplementedError("the vertical axis of the playfield must be y");
+  }
+  playfield.emplace(layout);
+  getCamera().lockView(layout.depthAxis, layout.depthDirection, layout.cameraDepth);
+  // The camera looks straight down the depth axis, so the end of the background is that far away
+  setFarPlane(layout.layerBounds[3] - layout.cameraDepth);
+}
+
+void Renderer::emitParticles(const ParticleEmitter &emitter) {
+  if (particleSystem) {
+    particleSystem->emit(emitter);
+    const auto lifetime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float>(emitter.lifetime));
+    particlesAliveUntil =
+        std::max(particlesAliveUntil, std::chrono::steady_clock::now() + lifetime);
+  }
 }
 
 std::vector<vk::VertexInputAttributeDescription> Renderer::getVertexAttributeDescription() const {
@@ -99,68 +421,264 @@ void Renderer::createComputeBuffers() {
   using enum vk::MemoryPropertyFlagBits;
   using enum vk::BufferUsageFlagBits;
 
+  // Written by the compute queue and read by the graphics one every frame, so shared rather than
+  // transferred back and forth
+  const std::vector<uint32_t> sharingFamilies = queueFamilies.getSharingFamilies();
   vertexBuffer.emplace(device, physicalDevice, sizeof(Vertex) * MAX_VERTEX_COUNT,
-                       eStorageBuffer | eVertexBuffer, eDeviceLocal);
+                       eStorageBuffer | eVertexBuffer, eDeviceLocal, sharingFamilies);
 
   indexBuffer.emplace(device, physicalDevice, sizeof(uint32_t) * MAX_INDEX_COUNT,
-                      eStorageBuffer | eIndexBuffer, eDeviceLocal);
+                      eStorageBuffer | eIndexBuffer, eDeviceLocal, sharingFamilies);
 
   drawCommandBuffer.emplace(device, physicalDevice, sizeof(VkDrawIndexedIndirectCommand),
-                            eStorageBuffer | eIndirectBuffer, eDeviceLocal);
+                            eStorageBuffer | eIndirectBuffer, eDeviceLocal, sharingFamilies);
   constexpr TestData src = {0};
-  testDataBuffer = createBufferWithInitialData(eStorageBuffer, &src, sizeof(src));
+  testDataBuffer = createBufferWithInitialData(eStorageBuffer, &src, sizeof(src), true);
+}
+
+void Renderer::createMeshBuffers() {
+  using enum vk::BufferUsageFlagBits;
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+
+  meshRanges[static_cast<uint32_t>(MeshType::Sprite)].firstIndex = 0;
+  addQuad(vertices, indices, glm::vec3(0.f), {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f});
+  meshRanges[static_cast<uint32_t>(MeshType::Sprite)].indexCount =
+      static_cast<uint32_t>(indices.size());
+
+  // Vertex offsets stay at 0 since the indices already point into the shared vertex buffer
+  auto &cube = meshRanges[static_cast<uint32_t>(MeshType::Cube)];
+  cube.firstIndex = static_cast<uint32_t>(indices.size());
+  for (const auto &face : CUBE_FACES) {
+    addQuad(vertices, indices, face.normal * .5f, face.tangent, face.bitangent);
+  }
+  cube.indexCount = static_cast<uint32_t>(indices.size()) - cube.firstIndex;
+
+  meshVertexBuffer = createBufferWithInitialData(eVertexBuffer, vertices.data(),
+                                                 vertices.size() * sizeof(Vertex));
+  meshIndexBuffer = createBufferWithInitialData(eIndexBuffer, indices.data(),
+                                                indices.size() * sizeof(uint32_t));
+}
+
+void Renderer::initCustomFrameResources() {
+  using enum vk::MemoryPropertyFlagBits;
+  using enum vk::BufferUsageFlagBits;
+
+  // Host visible since they are rewritten every frame, one of each per frame in flight
+  instanceBuffers.clear();
+  instanceDrawCommandBuffers.clear();
+  frameInstanceCounts.assign(getFramesInFlight(), 0);
+  for (uint32_t i = 0; i < getFramesInFlight(); i++) {
+    instanceBuffers.push_back(createInstanceBuffer(INITIAL_INSTANCE_CAPACITY));
+    instanceDrawCommandBuffers.emplace_back(
+        device, physicalDevice, sizeof(vk::DrawIndexedIndirectCommand) * MESH_TYPE_COUNT,
+        eIndirectBuffer, eHostVisible | eHostCoherent);
+  }
+}
+
+Buffer Renderer::createInstanceBuffer(size_t capacity) const {
+  using enum vk::MemoryPropertyFlagBits;
+  return {device, physicalDevice, sizeof(InstanceData) * capacity,
+          vk::BufferUsageFlagBits::eVertexBuffer, eHostVisible | eHostCoherent};
+}
+
+void Renderer::createInstancedPipeline() {
+  GraphicsPipelineDescription description;
+  description.vertexShader = "shaders/instanced.vert.spv";
+  description.fragmentShader = "shaders/shader.frag.spv";
+  description.bindings = {Vertex::getBindingDescription(), getInstanceBindingDescription()};
+  description.attributes = Vertex::getAttributeDescriptions();
+  const auto instanceAttributes = getInstanceAttributeDescriptions();
+  description.attributes.insert(description.attributes.end(), instanceAttributes.begin(),
+                                instanceAttributes.end());
+
+  instancedPipeline = createGraphicsPipeline(description);
+}
+
+void Renderer::createTerrainPipeline() {
+  GraphicsPipelineDescription description;
+  description.vertexShader = "shaders/terrain.vert.spv";
+  description.fragmentShader = "shaders/terrain.frag.spv";
+  description.bindings = {getTerrainBindingDescription()};
+  description.attributes = getTerrainAttributeDescriptions();
+
+  terrainPipeline = createGraphicsPipeline(description);
+}
+
+void Renderer::createVoxelWindowBuffers() {
+  using enum vk::MemoryPropertyFlagBits;
+  using enum vk::BufferUsageFlagBits;
+
+  // Starts empty, the voxels are uploaded once a world is set
+  const std::vector<uint32_t> emptyWindow(VOXEL_WINDOW_WORD_COUNT, 0);
+  voxelWindowBuffer = createBufferWithInitialData(
+      eStorageBuffer, emptyWindow.data(), emptyWindow.size() * sizeof(uint32_t), true);
+  voxelWindowStagingBuffer.emplace(device, physicalDevice,
+                                   VOXEL_WINDOW_WORD_COUNT * sizeof(uint32_t), eTransferSrc,
+                                   eHostVisible | eHostCoherent);
+}
+
+/**
+ * The fastest workgroup size of the particle simulation differs a lot between devices, it is
+ * measured on the first run with each device and driver, then read back from the tuning cache
+ */
+void Renderer::tuneParticleWorkgroupSize() {
+  TuningCache cache(getDefaultTuningCachePath());
+  const std::string deviceKey = getDeviceKey();
+  const vk::PhysicalDeviceLimits limits = physicalDevice.getProperties().limits;
+  const uint32_t maxSize = std::min({MAX_TUNED_WORKGROUP_SIZE,
+                                     limits.maxComputeWorkGroupInvocations,
+                                     limits.maxComputeWorkGroupSize[0]});
+  uint32_t workgroupSize = DEFAULT_PARTICLE_WORKGROUP_SIZE;
+  const auto cached = cache.get(deviceKey, PARTICLE_WORKGROUP_SIZE_PARAMETER);
+  // A damaged or edited value could fail the pipeline creation, it is tuned again instead
+  if (cached && *cached >= MIN_TUNED_WORKGROUP_SIZE && *cached <= maxSize &&
+      std::has_single_bit(*cached)) {
+    workgroupSize = *cached;
+  } else {
+    double bestTime = std::numeric_limits<double>::infinity();
+    for (uint32_t candidate = MIN_TUNED_WORKGROUP_SIZE; candidate <= maxSize; candidate *= 2) {
+      particleSystem->setWorkgroupSize(candidate);
+      for (int run = 0; run < TUNING_RUNS; ++run) {
+        const double time = measureGpuTime([this](vk::CommandBuffer commandBuffer) {
+          particleSystem->recordBenchmark(commandBuffer);
+        });
+        if (time < bestTime) {
+          bestTime = time;
+          workgroupSize = candidate;
+        }
+      }
+    }
+    cache.set(deviceKey, PARTICLE_WORKGROUP_SIZE_PARAMETER, workgroupSize);
+  }
+  particleSystem->setWorkgroupSize(workgroupSize);
+}
+
+void Renderer::createParticlePipeline() {
+  const std::array setLayouts = {*descriptorSetLayout,
+                                 particleSystem->getDrawDescriptorSetLayout()};
+  vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
+  pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+  pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+  pipelineLayoutInfo.pushConstantRangeCount = 1;
+  pipelineLayoutInfo.pPushConstantRanges = &CAMERA_PUSH_CONSTANT_RANGE;
+  particlePipelineLayout = vk::raii::PipelineLayout(device, pipelineLayoutInfo);
+
+  // Billboards are expanded from the particle buffer, without any vertex input
+  GraphicsPipelineDescription description;
+  description.vertexShader = "shaders/particles.vert.spv";
+  description.fragmentShader = "shaders/particles.frag.spv";
+  description.layout = *particlePipelineLayout;
+
+  particlePipeline = createGraphicsPipeline(description);
 }
 
 Buffer Renderer::createBufferWithInitialData(const vk::BufferUsageFlags usage, const void *src,
                                              // ReSharper disable once CppDFAConstantParameter
-                                             const vk::DeviceSize size) const {
+                                             const vk::DeviceSize size,
+                                             const bool readByCompute) {
   using enum vk::MemoryPropertyFlagBits;
   using enum vk::BufferUsageFlagBits;
   Buffer stagingBuffer(device, physicalDevice, size, eTransferSrc, eHostVisible | eHostCoherent);
   stagingBuffer.copyToMemory(src);
-  Buffer buffer(device, physicalDevice, size, usage | eTransferDst, eDeviceLocal);
-  copyBuffer(stagingBuffer.getBuffer(), buffer.getBuffer(), size);
+  const std::vector<uint32_t> sharingFamilies =
+      readByCompute ? queueFamilies.getSharingFamilies() : std::vector<uint32_t>{};
+  Buffer buffer(device, physicalDevice, size, usage | eTransferDst, eDeviceLocal, sharingFamilies);
+  copyBuffer(std::move(stagingBuffer), buffer.getBuffer(), sharingFamilies.size() > 1);
   return buffer;
 }
 
+/**
+ * Every block texture becomes a layer of one texture array, so that the terrain is drawn with a
+ * single descriptor set whatever blocks it shows. Textures are BC1 compressed with their mip
+ * chain when the device can sample it, otherwise the mip levels of the uncompressed fallback are
+ * blitted at load time.
+ */
 void Renderer::createTextureImage() {
   using enum vk::MemoryPropertyFlagBits;
   using enum vk::BufferUsageFlagBits;
-  int texWidth;
-  int texHeight;
-  int texChannels;
-  const auto texture = files::readFile("textures/texture.jpg");
-  stbi_uc *pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(texture.begin()),
-                                          static_cast<int>(texture.size()), &texWidth, &texHeight,
-                                          &texChannels, STBI_rgb_alpha);
-  const vk::DeviceSize imageSize = texWidth * texHeight * 4;
+  const bool compressed =
+      static_cast<bool>(physicalDevice.getFormatProperties(vk::Format::eBc1RgbSrgbBlock)
+                            .optimalTilingFeatures &
+                        vk::FormatFeatureFlagBits::eSampledImage);
+  textureFormat = compressed ? vk::Format::eBc1RgbSrgbBlock : vk::Format::eR8G8B8A8Srgb;
+
+  std::vector<std::span<const char>> files;
+  std::vector<Ktx2Texture> textures;
+  for (const char *name : BLOCK_TEXTURES) {
+    const std::string path = std::string(name) + (compressed ? ".ktx2" : ".rgba.ktx2");
+    const std::span<const char> file = files.emplace_back(files::readFile(path));
+    textures.push_back(readKtx2({reinterpret_cast<const uint8_t *>(file.data()), file.size()}));
+    const Ktx2Texture &texture = textures.back();
+    if (texture.width != textures.front().width || texture.height != textures.front().height ||
+        texture.levels.size() != textures.front().levels.size()) {
+      throw VulkanInitializationError("block textures must all have the same size!");
+    }
+    if (texture.vkFormat != static_cast<uint32_t>(textureFormat)) {
+      throw VulkanInitializationError("unexpected block texture format!");
+    }
+  }
+  const uint32_t texWidth = textures.front().width;
+  const uint32_t texHeight = textures.front().height;
+  const auto storedLevels = static_cast<uint32_t>(textures.front().levels.size());
+
+  textureMipLevels = storedLevels;
+  vk::ImageUsageFlags usage =
+      vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
+  if (!compressed && static_cast<bool>(physicalDevice.getFormatProperties(textureFormat)
+                                           .optimalTilingFeatures &
+                                       vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
+    textureMipLevels =
+        static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+    usage |= vk::ImageUsageFlagBits::eTransferSrc;
+  }
 
-  if (!pixels) {
-    throw VulkanInitializationError("failed to load texture image!");
+  // Stored levels one after the other, all the layers of a level being contiguous
+  std::vector<uint8_t> data;
+  std::vector<vk::BufferImageCopy> regions;
+  for (uint32_t level = 0; level < storedLevels; ++level) {
+    for (uint32_t layer = 0; layer < BLOCK_TEXTURE_COUNT; ++layer) {
+      const Ktx2Level &stored = textures[layer].levels[level];
+      vk::BufferImageCopy &region = regions.emplace_back();
+      region.bufferOffset = data.size();
+      region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+      region.imageSubresource.mipLevel = level;
+      region.imageSubresource.baseArrayLayer = layer;
+      region.imageSubresource.layerCount = 1;
+      region.imageExtent =
+          vk::Extent3D{std::max(texWidth >> level, 1u), std::max(texHeight >> level, 1u), 1};
+      const auto *levelData =
+          reinterpret_cast<const uint8_t *>(files[layer].data()) + stored.offset;
+      data.insert(data.end(), levelData, levelData + stored.length);
+    }
   }
 
-  Buffer stagingBuffer(device, physicalDevice, imageSize, eTransferSrc,
+  Buffer stagingBuffer(device, physicalDevice, data.size(), eTransferSrc,
                        eHostVisible | eHostCoherent);
 
-  stagingBuffer.copyToMemory(pixels);
-
-  stbi_image_free(pixels);
+  stagingBuffer.copyToMemory(data.data());
 
-  createImage(texWidth, texHeight, vk::Format::eR8G8B8A8Srgb, vk::ImageTiling::eOptimal,
-              vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, eDeviceLocal,
-              textureImage, textureImageMemory);
+  createImage(texWidth, texHeight, textureFormat, vk::ImageTiling::eOptimal, usage, eDeviceLocal,
+              textureImage, textureImageMemory, BLOCK_TEXTURE_COUNT, textureMipLevels);
 
   transitionImageLayout(*textureImage, vk::ImageLayout::eUndefined,
-                        vk::ImageLayout::eTransferDstOptimal);
-  copyBufferToImage(stagingBuffer.getBuffer(), *textureImage, static_cast<uint32_t>(texWidth),
-                    static_cast<uint32_t>(texHeight));
-  transitionImageLayout(*textureImage, vk::ImageLayout::eTransferDstOptimal,
-                        vk::ImageLayout::eShaderReadOnlyOptimal);
+                        vk::ImageLayout::eTransferDstOptimal, BLOCK_TEXTURE_COUNT,
+                        textureMipLevels);
+  copyBufferToImage(stagingBuffer.getBuffer(), *textureImage, regions);
+  if (compressed) {
+    transitionImageLayout(*textureImage, vk::ImageLayout::eTransferDstOptimal,
+                          vk::ImageLayout::eShaderReadOnlyOptimal, BLOCK_TEXTURE_COUNT,
+                          textureMipLevels);
+  } else {
+    generateMipmaps(*textureImage, texWidth, texHeight, textureMipLevels, BLOCK_TEXTURE_COUNT);
+  }
 }
 
 void Renderer::createTextureImageView() {
+  // An array view even for a single layer, the shaders sample a sampler2DArray
   textureImageView =
-      createImageView(*textureImage, vk::Format::eR8G8B8A8Srgb, vk::ImageAspectFlagBits::eColor);
+      createImageView(*textureImage, textureFormat, vk::ImageAspectFlagBits::eColor,
+                      vk::ImageViewType::e2DArray, BLOCK_TEXTURE_COUNT, textureMipLevels);
 }
 
 void Renderer::createTextureSampler() {
@@ -185,26 +703,20 @@ void Renderer::createTextureSampler() {
   samplerInfo.compareEnable = vk::False;
   samplerInfo.compareOp = vk::CompareOp::eAlways;
   samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+  samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
   textureSampler = vk::raii::Sampler(device, samplerInfo);
 }
 
 void Renderer::createDescriptorSetLayout() {
-  vk::DescriptorSetLayoutBinding uboLayoutBinding;
-  uboLayoutBinding.binding = 0;
-  uboLayoutBinding.descriptorCount = 1;
-  uboLayoutBinding.descriptorType = vk::DescriptorType::eUniformBuffer;
-  uboLayoutBinding.pImmutableSamplers = nullptr;
-  uboLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eVertex;
-
   vk::DescriptorSetLayoutBinding samplerLayoutBinding;
-  samplerLayoutBinding.binding = 1;
+  samplerLayoutBinding.binding = 0;
   samplerLayoutBinding.descriptorCount = 1;
   samplerLayoutBinding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
   samplerLayoutBinding.pImmutableSamplers = nullptr;
   samplerLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
 
-  const std::array bindings = {uboLayoutBinding, samplerLayoutBinding};
+  const std::array bindings = {samplerLayoutBinding};
   vk::DescriptorSetLayoutCreateInfo layoutInfo;
   layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
   layoutInfo.pBindings = bindings.data();
@@ -227,63 +739,64 @@ void Renderer::createComputeDescriptorPool() {
 }
 
 void Renderer::createDescriptorSets() {
-  const std::vector layouts(MAX_FRAMES_IN_FLIGHT, *descriptorSetLayout);
   vk::DescriptorSetAllocateInfo allocInfo;
   allocInfo.descriptorPool = *descriptorPool;
-  allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-  allocInfo.pSetLayouts = layouts.data();
-
-  descriptorSets = vk::raii::DescriptorSets(device, allocInfo);
-
-  for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    vk::DescriptorBufferInfo bufferInfo;
-    bufferInfo.buffer = uniformBuffers[i].getBuffer();
-    bufferInfo.offset = 0;
-    bufferInfo.range = sizeof(UniformBufferObject);
-
-    vk::DescriptorImageInfo imageInfo;
-    imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-    imageInfo.imageView = *textureImageView;
-    imageInfo.sampler = *textureSampler;
+  allocInfo.descriptorSetCount = 1;
+  allocInfo.pSetLayouts = &*descriptorSetLayout;
 
-    std::vector<vk::WriteDescriptorSet> descriptorWrites;
+  // The textures only change on reload, while no frame is in flight, so one set is enough
+  descriptorSet = std::move(vk::raii::DescriptorSets(device, allocInfo)[0]);
+  updateTextureDescriptors();
+}
 
-    vk::WriteDescriptorSet &descriptorWrite = descriptorWrites.emplace_back();
-    descriptorWrite.dstSet = *descriptorSets[i];
-    descriptorWrite.dstBinding = 0;
-    descriptorWrite.dstArrayElement = 0;
-    descriptorWrite.descriptorType = vk::DescriptorType::eUniformBuffer;
-    descriptorWrite.descriptorCount = 1;
-    descriptorWrite.pBufferInfo = &bufferInfo;
+void Renderer::updateTextureDescriptors() {
+  vk::DescriptorImageInfo imageInfo;
+  imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+  imageInfo.imageView = *textureImageView;
+  imageInfo.sampler = *textureSampler;
+
+  vk::WriteDescriptorSet descriptorWrite;
+  descriptorWrite.dstSet = *descriptorSet;
+  descriptorWrite.dstBinding = 0;
+  descriptorWrite.dstArrayElement = 0;
+  descriptorWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+  descriptorWrite.descriptorCount = 1;
+  descriptorWrite.pImageInfo = &imageInfo;
+
+  device.updateDescriptorSets(descriptorWrite, nullptr);
+}
 
-    vk::WriteDescriptorSet &descriptorWrite2 = descriptorWrites.emplace_back();
-    descriptorWrite2.dstSet = *descriptorSets[i];
-    descriptorWrite2.dstBinding = 1;
-    descriptorWrite2.dstArrayElement = 0;
-    descriptorWrite2.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-    descriptorWrite2.descriptorCount = 1;
-    descriptorWrite2.pImageInfo = &imageInfo;
+void Renderer::reloadAssets(const ReloadedAssets &assets) {
+  BaseRenderer::reloadAssets(assets);
 
-    device.updateDescriptorSets(descriptorWrites, nullptr);
+  if (assets.hasShader("shaders/instanced.vert.spv") ||
+      assets.hasShader("shaders/shader.frag.spv")) {
+    createInstancedPipeline();
+  }
+  if (assets.hasShader("shaders/terrain.vert.spv") ||
+      assets.hasShader("shaders/terrain.frag.spv")) {
+    createTerrainPipeline();
+  }
+  if (assets.hasShader("shaders/particles.vert.spv") ||
+      assets.hasShader("shaders/particles.frag.spv")) {
+    createParticlePipeline();
+  }
+  if (assets.hasShader("shaders/particles.comp.spv")) {
+    particleSystem->reloadComputePipeline();
+  }
+  if (assets.textures) {
+    // The sampler does not depend on the texture, even when its mip levels change
+    createTextureImage();
+    createTextureImageView();
+    updateTextureDescriptors();
   }
 }
 
 void Renderer::copyBufferToImage(const vk::Buffer buffer, const vk::Image image,
-                                 const uint32_t width, const uint32_t height) const {
+                                 const std::vector<vk::BufferImageCopy> &regions) const {
   const vk::raii::CommandBuffer commandBuffer = beginSingleTimeCommands();
 
-  vk::BufferImageCopy region;
-  region.bufferOffset = 0;
-  region.bufferRowLength = 0;
-  region.bufferImageHeight = 0;
-  region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-  region.imageSubresource.mipLevel = 0;
-  region.imageSubresource.baseArrayLayer = 0;
-  region.imageSubresource.layerCount = 1;
-  region.imageOffset = vk::Offset3D{0, 0, 0};
-  region.imageExtent = vk::Extent3D{width, height, 1};
-
-  commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, region);
+  commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, regions);
 
   endSingleTimeCommands(*commandBuffer);
 }
@@ -292,6 +805,8 @@ vk::PipelineLayoutCreateInfo Renderer::getPipelineLayoutInfo() const {
   vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
   pipelineLayoutInfo.setLayoutCount = 1;
   pipelineLayoutInfo.pSetLayouts = &*descriptorSetLayout;
+  pipelineLayoutInfo.pushConstantRangeCount = 1;
+  pipelineLayoutInfo.pPushConstantRanges = &CAMERA_PUSH_CONSTANT_RANGE;
   return pipelineLayoutInfo;
 }
 
@@ -7,11 +7,35 @@
 
 #include "Buffer.h"
 #include "base_renderer.h"
-
+#include "instance_batch.h"
+#include "particle_system.h"
+#include "playfield.h"
+#include "../world/chunk_mesher.h"
+#include "../world/voxel_window.h"
+
+#include <bitset>
+#include <chrono>
+#include <deque>
 #include <glm/detail/type_mat4x4.hpp>
 #include <glm/fwd.hpp>
+#include <unordered_map>
+#include <utility>
 namespace plaxel {
 
+// Instance buffers grow past it when a frame draws more instances
+constexpr uint32_t INITIAL_INSTANCE_CAPACITY = 16384;
+
+// Layers of the block texture array, indexed by the texture of TerrainVertex. Other meshes use the
+// first one. Names of the KTX2 files produced by the texture compiler, without their extension.
+constexpr std::array BLOCK_TEXTURES = {"textures/texture"};
+constexpr auto BLOCK_TEXTURE_COUNT = static_cast<uint32_t>(BLOCK_TEXTURES.size());
+static_assert(BLOCK_TEXTURE_COUNT <= MAX_BLOCK_TEXTURES);
+constexpr float MAX_PARTICLE_STEP_S = 0.1f;
+// Distance from the center of a chunk to its corners
+constexpr float CHUNK_BOUNDING_RADIUS = 0.866f * CHUNK_SIZE;
+// Chunks closer than this are always drawn at full resolution
+constexpr float MIN_LOD_DEPTH = 1.0f;
+
 struct TestData {
   int32_t testData;
 };
@@ -38,48 +62,166 @@ struct Vertex {
   }
 };
 
+/**
+ * Location of one mesh type inside the shared mesh vertex and index buffers
+ */
+struct MeshRange {
+  uint32_t firstIndex;
+  uint32_t indexCount;
+  int32_t vertexOffset;
+};
+
+/**
+ * GPU copy of the mesh of one chunk
+ */
+struct TerrainMeshBuffers {
+  Buffer vertices;
+  Buffer indices;
+  uint32_t indexCount;
+};
+
+/**
+ * Replaced while frames in flight may still draw it
+ */
+struct RetiredTerrainMesh {
+  TerrainMeshBuffers buffers;
+  // Frames submitted before it was replaced
+  uint64_t retiredAtFrame;
+};
+
+/**
+ * Meshes of one chunk at every level of detail, empty ones have no buffers
+ */
+struct TerrainChunk {
+  std::array<std::optional<TerrainMeshBuffers>, LOD_COUNT> lods;
+  // Levels whose mesh was received, which are the only ones that can be picked
+  std::bitset<LOD_COUNT> built;
+};
+
 class Renderer : public BaseRenderer {
+public:
+  /**
+   * Instances drawn by the next frames, to be refilled by the caller whenever they change
+   */
+  [[nodiscard]] InstanceBatch &getInstanceBatch();
+
+  /**
+   * Replace the meshes of the given chunks at their level of detail
+   */
+  void updateTerrain(const std::vector<ChunkMeshUpdate> &meshes);
+  /**
+   * Mirror the blocks of the world on the GPU for the passes colliding against them. The world
+   * must outlive the renderer since it keeps notifying it of its edits.
+   */
+  void setWorld(World &world);
+  /**
+   * Only draw the terrain visible from a side scroller camera, front to back, and lock the camera
+   * to the layout. Until this is called the camera is free and every chunk is drawn.
+   */
+  void setPlayfield(const PlayfieldLayout &layout);
+  /**
+   * Spawn a burst of GPU particles on the next frame, ignored until the window is shown
+   */
+  void emitParticles(const ParticleEmitter &emitter);
+
 private:
   void initVulkan() override;
   void initCustomDescriptorSetLayout() override;
+  void initCustomFrameResources() override;
   vk::raii::CommandBuffers computeCommandBuffers = nullptr;
 
   vk::raii::Image textureImage = nullptr;
   vk::raii::DeviceMemory textureImageMemory = nullptr;
   vk::raii::ImageView textureImageView = nullptr;
   vk::raii::Sampler textureSampler = nullptr;
+  vk::Format textureFormat = vk::Format::eR8G8B8A8Srgb;
+  uint32_t textureMipLevels = 1;
 
   vk::raii::DescriptorPool computeDescriptorPool = nullptr;
   vk::raii::DescriptorSetLayout computeDescriptorSetLayout = nullptr;
   vk::raii::DescriptorSet computeDescriptorSet = nullptr;
 
   vk::raii::DescriptorSetLayout descriptorSetLayout = nullptr;
-  vk::raii::DescriptorSets descriptorSets = nullptr;
+  vk::raii::DescriptorSet descriptorSet = nullptr;
 
   std::optional<Buffer> vertexBuffer;
   std::optional<Buffer> indexBuffer;
   std::optional<Buffer> drawCommandBuffer;
   std::optional<Buffer> testDataBuffer;
 
+  InstanceBatch instanceBatch;
+  // Of the last frame drawn, to only redraw on demand when the instances changed
+  uint64_t drawnInstanceGeneration = 0;
+  vk::raii::Pipeline instancedPipeline = nullptr;
+  std::optional<Buffer> meshVertexBuffer;
+  std::optional<Buffer> meshIndexBuffer;
+  std::array<MeshRange, MESH_TYPE_COUNT> meshRanges{};
+  std::vector<Buffer> instanceBuffers;
+  std::vector<Buffer> instanceDrawCommandBuffers;
+  std::vector<uint32_t> frameInstanceCounts;
+
+  vk::raii::Pipeline terrainPipeline = nullptr;
+  std::unordered_map<glm::ivec3, TerrainChunk, IVec3Hash> terrainChunks;
+  // Oldest first
+  std::deque<RetiredTerrainMesh> retiredTerrainMeshes;
+  std::optional<Playfield> playfield;
+  // Filled before recording the frame, in drawing order
+  std::vector<std::pair<glm::ivec3, const TerrainChunk *>> visibleChunks;
+
+  std::optional<VoxelWindow> voxelWindow;
+  std::optional<Buffer> voxelWindowBuffer;
+  std::optional<Buffer> voxelWindowStagingBuffer;
+
+  std::optional<ParticleSystem> particleSystem;
+  vk::raii::PipelineLayout particlePipelineLayout = nullptr;
+  vk::raii::Pipeline particlePipeline = nullptr;
+  std::chrono::steady_clock::time_point lastParticleStep;
+  // Every particle emitted so far is dead after this point, and the simulation can pause
+  std::chrono::steady_clock::time_point particlesAliveUntil;
+
   void createComputeDescriptorSetLayout();
   void createComputeDescriptorSets();
   void recordComputeCommandBuffer(vk::CommandBuffer commandBuffer) override;
-  void drawCommand(vk::CommandBuffer commandBuffer) const override;
+  void drawCommand(vk::CommandBuffer commandBuffer, uint32_t stream,
+                   uint32_t streamCount) const override;
+  void drawTerrain(vk::CommandBuffer commandBuffer, uint32_t stream, uint32_t streamCount) const;
+  void collectVisibleChunks();
+  void drawTerrainChunk(vk::CommandBuffer commandBuffer, const glm::ivec3 &chunkPos,
+                        const TerrainChunk &chunk) const;
+  void drawInstances(vk::CommandBuffer commandBuffer) const;
+  void drawParticles(vk::CommandBuffer commandBuffer) const;
+  void uploadVoxelWindow(vk::CommandBuffer commandBuffer);
+  void prepareFrame(uint32_t frame) override;
+  void reloadAssets(const ReloadedAssets &assets) override;
+  [[nodiscard]] bool isAnimating() const override;
   [[nodiscard]] vk::VertexInputBindingDescription getVertexBindingDescription() const override;
   [[nodiscard]] std::vector<vk::VertexInputAttributeDescription>
   getVertexAttributeDescription() const override;
   void createComputeBuffers();
+  void createMeshBuffers();
+  void createInstancedPipeline();
+  [[nodiscard]] Buffer createInstanceBuffer(size_t capacity) const;
+  void createTerrainPipeline();
+  void createVoxelWindowBuffers();
+  void tuneParticleWorkgroupSize();
+  void createParticlePipeline();
   void createComputeDescriptorPool();
   void createDescriptorSetLayout();
   void createDescriptorSets();
+  void updateTextureDescriptors();
   void createTextureImageView();
   void createTextureSampler();
   void createTextureImage();
-  void copyBufferToImage(vk::Buffer buffer, vk::Image image, uint32_t width, uint32_t height) const;
+  void copyBufferToImage(vk::Buffer buffer, vk::Image image,
+                         const std::vector<vk::BufferImageCopy> &regions) const;
   [[nodiscard]] vk::PipelineLayoutCreateInfo getPipelineLayoutInfo() const override;
   [[nodiscard]] vk::PipelineLayoutCreateInfo getComputePipelineLayoutInfo() const override;
+  /**
+   * Buffers read by the compute pass are shared between all the queue families, others are owned
+   * by the graphics one
+   */
   Buffer createBufferWithInitialData(vk::BufferUsageFlags usage, const void *src,
-                                   vk::DeviceSize size) const;
+                                     vk::DeviceSize size, bool readByCompute = false);
 };
 
 } // namespace plaxel
@@ -0,0 +1,47 @@
+#include "resolution_scaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace plaxel {
+
+namespace {
+constexpr double SMOOTHING = 0.2;
+// Aim below the budget to absorb variations between frames
+constexpr double TARGET_BUDGET_FRACTION = 0.9;
+// Frames between this fraction of the budget and the budget itself keep their scale, so that the
+// resolution does not oscillate around the target
+constexpr double STABLE_BUDGET_FRACTION = 0.75;
+// Largest relative change of the scale between two frames, against visible jumps in sharpness
+constexpr float MAX_SCALE_STEP = 0.1f;
+} // namespace
+
+ResolutionScaler::ResolutionScaler(const ResolutionScalingConfig &scalingConfig)
+    : config(scalingConfig), scale(scalingConfig.maxScale) {}
+
+float ResolutionScaler::frameMeasured(double gpuTimeMs) {
+  // Unlike the frame time, the cost of the whole window does not depend on the current scale
+  const double fullScaleTimeMs = gpuTimeMs / (scale * scale);
+  smoothedFullScaleTimeMs =
+      smoothedFullScaleTimeMs > 0
+          ? smoothedFullScaleTimeMs + SMOOTHING * (fullScaleTimeMs - smoothedFullScaleTimeMs)
+          : fullScaleTimeMs;
+  if (smoothedFullScaleTimeMs <= 0) {
+    return scale;
+  }
+  const double expectedTimeMs = smoothedFullScaleTimeMs * scale * scale;
+  if (expectedTimeMs <= config.gpuBudgetMs &&
+      expectedTimeMs >= config.gpuBudgetMs * STABLE_BUDGET_FRACTION) {
+    return scale;
+  }
+
+  const auto idealScale = static_cast<float>(
+      std::sqrt(config.gpuBudgetMs * TARGET_BUDGET_FRACTION / smoothedFullScaleTimeMs));
+  scale = std::clamp(idealScale, scale * (1.0f - MAX_SCALE_STEP), scale * (1.0f + MAX_SCALE_STEP));
+  scale = std::clamp(scale, config.minScale, config.maxScale);
+  return scale;
+}
+
+float ResolutionScaler::getScale() const { return scale; }
+
+} // namespace plaxel
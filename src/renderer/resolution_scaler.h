@@ -0,0 +1,39 @@
+#ifndef PLAXEL_RESOLUTION_SCALER_H
+#define PLAXEL_RESOLUTION_SCALER_H
+
+namespace plaxel {
+
+struct ResolutionScalingConfig {
+  // GPU time of the scene that frames should stay under
+  double gpuBudgetMs = 1000.0 / 60.0;
+  // Fractions of the window size, per axis
+  float minScale = 0.5f;
+  float maxScale = 1.0f;
+};
+
+/**
+ * Picks the resolution of the scene from the GPU time of the previous frames. The cost of a frame
+ * is assumed to grow with its pixel count, so the scale follows the square root of the ratio
+ * between the budget and the time the frame would take at full resolution.
+ */
+class ResolutionScaler {
+public:
+  explicit ResolutionScaler(const ResolutionScalingConfig &config);
+
+  /**
+   * Account for a frame rendered at the current scale, returning the scale of the next one
+   */
+  float frameMeasured(double gpuTimeMs);
+  [[nodiscard]] float getScale() const;
+
+private:
+  ResolutionScalingConfig config;
+  float scale;
+  // GPU time the frames would take at full resolution, as an exponential moving average so that a
+  // single slow frame does not drop the resolution
+  double smoothedFullScaleTimeMs = 0;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_RESOLUTION_SCALER_H
@@ -0,0 +1,83 @@
+#include "tuning_cache.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace plaxel {
+
+namespace {
+// Relative paths in the variables are ignored, they would depend on the working directory
+std::optional<std::filesystem::path> getAbsolutePathFromEnv(const char *variable) {
+  const char *value = std::getenv(variable);
+  if (!value || !*value) {
+    return std::nullopt;
+  }
+  std::filesystem::path path(value);
+  if (!path.is_absolute()) {
+    return std::nullopt;
+  }
+  return path;
+}
+} // namespace
+
+std::filesystem::path getDefaultTuningCachePath() {
+  if (const char *path = std::getenv("PLAXEL_TUNING_CACHE"); path && *path) {
+    return path;
+  }
+  const std::filesystem::path file = std::filesystem::path("plaxel") / "tuning.txt";
+  if (const auto cacheHome = getAbsolutePathFromEnv("XDG_CACHE_HOME")) {
+    return *cacheHome / file;
+  }
+  if (const auto localAppData = getAbsolutePathFromEnv("LOCALAPPDATA")) {
+    return *localAppData / file;
+  }
+  if (const auto home = getAbsolutePathFromEnv("HOME")) {
+    return *home / ".cache" / file;
+  }
+  std::error_code error;
+  const std::filesystem::path temp = std::filesystem::temp_directory_path(error);
+  return error ? file.filename() : temp / file;
+}
+
+TuningCache::TuningCache(std::filesystem::path cachePath) : path(std::move(cachePath)) {
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string device;
+    std::string parameter;
+    uint32_t value;
+    if (fields >> device >> parameter >> value) {
+      values[{device, parameter}] = value;
+    }
+  }
+}
+
+std::optional<uint32_t> TuningCache::get(const std::string &device,
+                                         const std::string &parameter) const {
+  if (const auto value = values.find({device, parameter}); value != values.end()) {
+    return value->second;
+  }
+  return std::nullopt;
+}
+
+void TuningCache::set(const std::string &device, const std::string &parameter, uint32_t value) {
+  values[{device, parameter}] = value;
+
+  if (path.has_parent_path()) {
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+  std::ofstream file(path);
+  for (const auto &[key, storedValue] : values) {
+    file << key.first << ' ' << key.second << ' ' << storedValue << '\n';
+  }
+  if (!file) {
+    // Only costs measuring again on the next run
+    std::cerr << "Failed to save tuning cache to " << path.string() << std::endl;
+  }
+}
+
+} // namespace plaxel
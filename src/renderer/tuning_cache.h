@@ -0,0 +1,41 @@
+#ifndef PLAXEL_TUNING_CACHE_H
+#define PLAXEL_TUNING_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace plaxel {
+
+/**
+ * Per user location of the cache: $PLAXEL_TUNING_CACHE when set, otherwise plaxel/tuning.txt in
+ * the cache directory of the user, or in the temporary directory when there is none
+ */
+[[nodiscard]] std::filesystem::path getDefaultTuningCachePath();
+
+/**
+ * Parameters measured once per device, such as the best workgroup size of a compute kernel,
+ * persisted in a text file with one "<device> <parameter> <value>" line each. Lines that cannot be
+ * parsed are ignored, so that a stale or damaged file only means measuring again.
+ */
+class TuningCache {
+public:
+  explicit TuningCache(std::filesystem::path cachePath);
+
+  [[nodiscard]] std::optional<uint32_t> get(const std::string &device,
+                                            const std::string &parameter) const;
+  /**
+   * Store the value and rewrite the file right away, creating its directory if needed
+   */
+  void set(const std::string &device, const std::string &parameter, uint32_t value);
+
+private:
+  std::filesystem::path path;
+  std::map<std::pair<std::string, std::string>, uint32_t> values;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_TUNING_CACHE_H
@@ -0,0 +1,400 @@
+#include "chunk_mesher.h"
+
+#include <algorithm>
+#include <glm/common.hpp>
+#include <span>
+
+namespace plaxel {
+
+namespace {
+// Sky light only, like the voxels of chunks that do not exist
+constexpr uint8_t OPEN_AIR_LIGHT = MAX_LIGHT << 4;
+
+/**
+ * Copy the blocks and light of a chunk and of the given thickness of its neighbours around it
+ */
+template <int APRON, typename Index>
+void copyChunkWithApron(const World &world, const LightEngine &lighting,
+                        const glm::ivec3 &chunkPos, std::span<BlockId> blocks,
+                        std::span<uint8_t> light, Index index) {
+  // The chunk and its 26 neighbours, looked up once instead of once per voxel
+  std::array<const Chunk *, 27> chunks{};
+  std::array<const ChunkLight *, 27> chunkLights{};
+  for (int i = 0; i < 27; ++i) {
+    const glm::ivec3 neighbour = chunkPos + glm::ivec3(i % 3 - 1, i / 3 % 3 - 1, i / 9 - 1);
+    chunks[i] = world.getChunk(neighbour);
+    chunkLights[i] = lighting.getChunkLight(neighbour);
+  }
+
+  for (int y = -APRON; y < CHUNK_SIZE + APRON; ++y) {
+    for (int z = -APRON; z < CHUNK_SIZE + APRON; ++z) {
+      for (int x = -APRON; x < CHUNK_SIZE + APRON; ++x) {
+        const glm::ivec3 localPos(x, y, z);
+        const glm::ivec3 neighbourOffset = World::toChunkPos(localPos) + 1;
+        const int neighbour = neighbourOffset.x + neighbourOffset.y * 3 + neighbourOffset.z * 9;
+        const int chunkIndex = Chunk::index(World::toLocalPos(localPos));
+        const int copyIndex = index(localPos);
+        blocks[copyIndex] =
+            chunks[neighbour] ? chunks[neighbour]->getBlock(World::toLocalPos(localPos)) : AIR;
+        light[copyIndex] =
+            chunkLights[neighbour] ? chunkLights[neighbour]->levels[chunkIndex] : OPEN_AIR_LIGHT;
+      }
+    }
+  }
+}
+} // namespace
+
+void LodSource::fill(const World &world, const LightEngine &lighting,
+                     const glm::ivec3 &chunkPos) {
+  copyChunkWithApron<MAX_LOD_CELL_SIZE>(world, lighting, chunkPos, blocks, light, index);
+}
+
+int LodSource::index(const glm::ivec3 &localPos) {
+  constexpr int OFFSET = MAX_LOD_CELL_SIZE;
+  return ((localPos.y + OFFSET) * LOD_SOURCE_SIZE + localPos.z + OFFSET) * LOD_SOURCE_SIZE +
+         localPos.x + OFFSET;
+}
+
+int selectLod(float voxelPixels) {
+  for (int lod = LOD_COUNT - 1; lod > 0; --lod) {
+    if (static_cast<float>(1 << lod) * voxelPixels <= MAX_LOD_CELL_PIXELS) {
+      return lod;
+    }
+  }
+  return 0;
+}
+
+void PaddedChunk::fill(const World &world, const LightEngine &lighting,
+                       const glm::ivec3 &chunkPos) {
+  copyChunkWithApron<1>(world, lighting, chunkPos, blocks, light, index);
+}
+
+/**
+ * Each voxel takes the value of the coarse cell containing it. A cell is solid when at least half
+ * of its voxels are, with its most frequent block, so that thin details disappear instead of
+ * growing. Its light is the brightest of its voxels.
+ */
+void PaddedChunk::downsample(const LodSource &source, int lod) {
+  const int cellSize = 1 << lod;
+  const int cellVolume = cellSize * cellSize * cellSize;
+  std::array<uint16_t, 256> blockCounts{};
+
+  // Cells overlapping the apron start up to one cell before the chunk
+  for (int cellY = -cellSize; cellY <= CHUNK_SIZE; cellY += cellSize) {
+    for (int cellZ = -cellSize; cellZ <= CHUNK_SIZE; cellZ += cellSize) {
+      for (int cellX = -cellSize; cellX <= CHUNK_SIZE; cellX += cellSize) {
+        const glm::ivec3 cell(cellX, cellY, cellZ);
+        blockCounts.fill(0);
+        int solidCount = 0;
+        BlockId block = AIR;
+        uint8_t blockLight = 0;
+        uint8_t skyLight = 0;
+        for (int y = 0; y < cellSize; ++y) {
+          for (int z = 0; z < cellSize; ++z) {
+            for (int x = 0; x < cellSize; ++x) {
+              const int sourceIndex = LodSource::index(cell + glm::ivec3(x, y, z));
+              const BlockId voxel = source.blocks[sourceIndex];
+              if (voxel != AIR) {
+                solidCount++;
+                if (++blockCounts[voxel] > blockCounts[block]) {
+                  block = voxel;
+                }
+              }
+              blockLight = std::max<uint8_t>(blockLight, source.light[sourceIndex] & 0xF);
+              skyLight = std::max<uint8_t>(skyLight, source.light[sourceIndex] >> 4);
+            }
+          }
+        }
+        if (2 * solidCount < cellVolume) {
+          block = AIR;
+        }
+
+        const glm::ivec3 low = glm::max(cell, glm::ivec3(-1));
+        const glm::ivec3 high = glm::min(cell + cellSize, glm::ivec3(CHUNK_SIZE + 1));
+        for (int y = low.y; y < high.y; ++y) {
+          for (int z = low.z; z < high.z; ++z) {
+            for (int x = low.x; x < high.x; ++x) {
+              const int paddedIndex = index({x, y, z});
+              blocks[paddedIndex] = block;
+              light[paddedIndex] = static_cast<uint8_t>(skyLight << 4 | blockLight);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+int PaddedChunk::index(const glm::ivec3 &localPos) {
+  return ((localPos.y + 1) * PADDED_CHUNK_SIZE + localPos.z + 1) * PADDED_CHUNK_SIZE +
+         localPos.x + 1;
+}
+
+bool PaddedChunk::isSolid(const glm::ivec3 &localPos) const {
+  return blocks[index(localPos)] != AIR;
+}
+
+ChunkMesher::ChunkMesher(const World &sourceWorld, const LightEngine &sourceLighting,
+                         const BlockTextures &textures)
+    : world(sourceWorld), lighting(sourceLighting), blockTextures(textures) {}
+
+ChunkMesh ChunkMesher::mesh(const glm::ivec3 &chunkPos, MeshingMode mode) const {
+  ChunkMesh mesh;
+  if (!world.getChunk(chunkPos)) {
+    return mesh;
+  }
+
+  PaddedChunk padded;
+  padded.fill(world, lighting, chunkPos);
+
+  const glm::ivec3 origin = chunkPos * CHUNK_SIZE;
+  if (mode == MeshingMode::Greedy) {
+    meshGreedy(mesh, padded, origin);
+  } else {
+    meshNaive(mesh, padded, origin);
+  }
+  return mesh;
+}
+
+std::vector<ChunkMesh> ChunkMesher::meshLods(const glm::ivec3 &chunkPos) const {
+  std::vector<ChunkMesh> meshes(LOD_COUNT - 1);
+  if (!world.getChunk(chunkPos)) {
+    return meshes;
+  }
+
+  LodSource source;
+  source.fill(world, lighting, chunkPos);
+  std::vector<PaddedChunk> levels(LOD_COUNT);
+  for (int lod = 0; lod < LOD_COUNT; ++lod) {
+    levels[lod].downsample(source, lod);
+  }
+
+  const glm::ivec3 origin = chunkPos * CHUNK_SIZE;
+  for (int lod = 1; lod < LOD_COUNT; ++lod) {
+    meshGreedy(meshes[lod - 1], levels[lod], origin, false);
+    addSkirts(meshes[lod - 1], levels, lod, origin);
+  }
+  return meshes;
+}
+
+void ChunkMesher::meshNaive(ChunkMesh &mesh, const PaddedChunk &padded,
+                            const glm::ivec3 &origin) const {
+  for (int y = 0; y < CHUNK_SIZE; ++y) {
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+      for (int x = 0; x < CHUNK_SIZE; ++x) {
+        const glm::ivec3 localPos(x, y, z);
+        if (!padded.isSolid(localPos)) {
+          continue;
+        }
+        for (const auto &face : CUBE_FACES) {
+          // Faces between two blocks can never be seen, even across chunk borders
+          if (!padded.isSolid(localPos + glm::ivec3(face.normal))) {
+            const glm::vec3 center = glm::vec3(origin + localPos) + .5f + face.normal * .5f;
+            addQuad(mesh, center, face, 1, 1, appearance(padded, localPos, face));
+          }
+        }
+      }
+    }
+  }
+}
+
+namespace {
+int axisOf(const glm::vec3 &direction) {
+  return direction.x != 0 ? 0 : direction.y != 0 ? 1 : 2;
+}
+} // namespace
+
+/**
+ * Each slice of the chunk perpendicular to a face direction is reduced to a mask of the visible
+ * faces, which is swept row by row: every face not merged yet is grown along the row, then the
+ * resulting strip is grown over the next rows while they match it entirely.
+ */
+void ChunkMesher::meshGreedy(ChunkMesh &mesh, const PaddedChunk &padded, const glm::ivec3 &origin,
+                             bool occlusion) const {
+  std::array<FaceAppearance, CHUNK_SIZE * CHUNK_SIZE> mask{};
+  std::array<bool, CHUNK_SIZE * CHUNK_SIZE> visible{};
+
+  for (const auto &face : CUBE_FACES) {
+    const int normalAxis = axisOf(face.normal);
+    const int rowAxis = axisOf(face.tangent);
+    const int columnAxis = axisOf(face.bitangent);
+
+    for (int slice = 0; slice < CHUNK_SIZE; ++slice) {
+      for (int j = 0; j < CHUNK_SIZE; ++j) {
+        for (int i = 0; i < CHUNK_SIZE; ++i) {
+          glm::ivec3 localPos;
+          localPos[normalAxis] = slice;
+          localPos[rowAxis] = i;
+          localPos[columnAxis] = j;
+          const int cell = j * CHUNK_SIZE + i;
+          visible[cell] = padded.isSolid(localPos) &&
+                          !padded.isSolid(localPos + glm::ivec3(face.normal));
+          if (visible[cell]) {
+            mask[cell] = appearance(padded, localPos, face, occlusion);
+          }
+        }
+      }
+
+      for (int j = 0; j < CHUNK_SIZE; ++j) {
+        for (int i = 0; i < CHUNK_SIZE; ++i) {
+          const int cell = j * CHUNK_SIZE + i;
+          if (!visible[cell]) {
+            continue;
+          }
+          const FaceAppearance look = mask[cell];
+          const auto &occlusions = look.occlusions;
+          // Occlusion is interpolated across the merged quad, so it has to be constant along the
+          // directions it grows in for the result to match the faces it replaces
+          const bool uniformAlongRow =
+              occlusions[0] == occlusions[1] && occlusions[3] == occlusions[2];
+          const bool uniformAlongColumn =
+              occlusions[0] == occlusions[3] && occlusions[1] == occlusions[2];
+          const auto matches = [&](int row, int column) {
+            const int other = row * CHUNK_SIZE + column;
+            return visible[other] && mask[other] == look;
+          };
+
+          int width = 1;
+          while (uniformAlongRow && i + width < CHUNK_SIZE && matches(j, i + width)) {
+            width++;
+          }
+          int height = 1;
+          while (uniformAlongColumn && j + height < CHUNK_SIZE) {
+            bool rowMatches = true;
+            for (int k = i; k < i + width && rowMatches; ++k) {
+              rowMatches = matches(j + height, k);
+            }
+            if (!rowMatches) {
+              break;
+            }
+            height++;
+          }
+
+          for (int row = j; row < j + height; ++row) {
+            std::fill_n(visible.begin() + row * CHUNK_SIZE + i, width, false);
+          }
+
+          glm::vec3 center;
+          center[normalAxis] = static_cast<float>(slice) + .5f + face.normal[normalAxis] * .5f;
+          center[rowAxis] = static_cast<float>(i) + static_cast<float>(width) * .5f;
+          center[columnAxis] = static_cast<float>(j) + static_cast<float>(height) * .5f;
+          addQuad(mesh, glm::vec3(origin) + center, face, width, height, look);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Neighbour chunks drawn at a finer level of detail cull their border faces against the finer
+ * version of this chunk. Where it has solid voxels that disappear at this level, those faces are
+ * missing from both meshes, so this mesh adds them back on its side of the border.
+ */
+void ChunkMesher::addSkirts(ChunkMesh &mesh, std::span<const PaddedChunk> levels, int lod,
+                            const glm::ivec3 &origin) const {
+  const PaddedChunk &coarse = levels[lod];
+  for (size_t faceIndex = 0; faceIndex < CUBE_FACES.size(); ++faceIndex) {
+    const glm::ivec3 outwards(CUBE_FACES[faceIndex].normal);
+    // Faces come in opposite pairs
+    const CubeFace &inwards = CUBE_FACES[faceIndex ^ 1];
+    const int normalAxis = axisOf(CUBE_FACES[faceIndex].normal);
+    const int border = outwards[normalAxis] > 0 ? CHUNK_SIZE - 1 : 0;
+
+    for (int j = 0; j < CHUNK_SIZE; ++j) {
+      for (int i = 0; i < CHUNK_SIZE; ++i) {
+        glm::ivec3 localPos;
+        localPos[normalAxis] = border;
+        localPos[(normalAxis + 1) % 3] = i;
+        localPos[(normalAxis + 2) % 3] = j;
+        if (coarse.isSolid(localPos)) {
+          continue;
+        }
+        const glm::ivec3 apronPos = localPos + outwards;
+        for (int finer = 0; finer < lod; ++finer) {
+          if (levels[finer].isSolid(localPos) && levels[finer].isSolid(apronPos)) {
+            FaceAppearance look;
+            look.block = levels[finer].blocks[PaddedChunk::index(apronPos)];
+            look.light = coarse.light[PaddedChunk::index(localPos)];
+            look.occlusions.fill(MAX_AMBIENT_OCCLUSION);
+            const glm::vec3 center = glm::vec3(origin + apronPos) + .5f + inwards.normal * .5f;
+            addQuad(mesh, center, inwards, 1, 1, look);
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+FaceAppearance ChunkMesher::appearance(const PaddedChunk &padded, const glm::ivec3 &localPos,
+                                       const CubeFace &face, bool occlusion) {
+  const glm::ivec3 facing = localPos + glm::ivec3(face.normal);
+  const glm::ivec3 tangent(face.tangent);
+  const glm::ivec3 bitangent(face.bitangent);
+
+  FaceAppearance look;
+  look.block = padded.blocks[PaddedChunk::index(localPos)];
+  look.light = padded.light[PaddedChunk::index(facing)];
+  if (!occlusion) {
+    look.occlusions.fill(MAX_AMBIENT_OCCLUSION);
+    return look;
+  }
+  look.occlusions = {
+      ambientOcclusion(padded, facing, -tangent, -bitangent),
+      ambientOcclusion(padded, facing, tangent, -bitangent),
+      ambientOcclusion(padded, facing, tangent, bitangent),
+      ambientOcclusion(padded, facing, -tangent, bitangent),
+  };
+  return look;
+}
+
+void ChunkMesher::addQuad(ChunkMesh &mesh, const glm::vec3 &center, const CubeFace &face,
+                          uint32_t width, uint32_t height, const FaceAppearance &look) const {
+  const auto blockLight = static_cast<uint8_t>(look.light & 0xF);
+  const auto skyLight = static_cast<uint8_t>(look.light >> 4);
+  const auto &occlusions = look.occlusions;
+  const uint16_t texture = blockTextures[look.block];
+
+  // Corners in counter-clockwise order, as signs along the tangent and the bitangent
+  constexpr std::array<std::array<int, 2>, 4> CORNERS = {{{-1, -1}, {1, -1}, {1, 1}, {-1, 1}}};
+  const auto first = static_cast<uint32_t>(mesh.vertices.size());
+  for (size_t i = 0; i < CORNERS.size(); ++i) {
+    const auto [t, b] = CORNERS[i];
+    // One texture repetition per face, the sampler repeats it over merged quads
+    const uint32_t u = static_cast<uint32_t>(t + 1) / 2 * width;
+    const uint32_t v = static_cast<uint32_t>(1 - b) / 2 * height;
+    const glm::vec3 offset = face.tangent * (.5f * static_cast<float>(width) * t) +
+                             face.bitangent * (.5f * static_cast<float>(height) * b);
+    mesh.vertices.push_back({center + offset, packTerrainVertexData(u, v, blockLight, skyLight,
+                                                                    occlusions[i], texture)});
+  }
+
+  // Split the quad along its least occluded diagonal, otherwise the occlusion interpolated across
+  // the two triangles is not symmetric and shows as a crease
+  if (occlusions[0] + occlusions[2] < occlusions[1] + occlusions[3]) {
+    for (const uint32_t corner : {1u, 2u, 3u, 3u, 0u, 1u}) {
+      mesh.indices.push_back(first + corner);
+    }
+  } else {
+    for (const uint32_t corner : {0u, 1u, 2u, 2u, 3u, 0u}) {
+      mesh.indices.push_back(first + corner);
+    }
+  }
+}
+
+/**
+ * Occlusion of a face corner by the two blocks along its edges and the block at its diagonal, all
+ * in the layer of voxels the face looks at. Two sides are enough to fully occlude the corner.
+ */
+uint8_t ChunkMesher::ambientOcclusion(const PaddedChunk &padded, const glm::ivec3 &facing,
+                                      const glm::ivec3 &side1, const glm::ivec3 &side2) {
+  const bool solid1 = padded.isSolid(facing + side1);
+  const bool solid2 = padded.isSolid(facing + side2);
+  if (solid1 && solid2) {
+    return 0;
+  }
+  const bool solidCorner = padded.isSolid(facing + side1 + side2);
+  return static_cast<uint8_t>(MAX_AMBIENT_OCCLUSION - solid1 - solid2 - solidCorner);
+}
+
+} // namespace plaxel
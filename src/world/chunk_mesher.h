@@ -0,0 +1,203 @@
+#ifndef PLAXEL_CHUNK_MESHER_H
+#define PLAXEL_CHUNK_MESHER_H
+
+#include "lighting.h"
+#include "world.h"
+
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace plaxel {
+
+struct CubeFace {
+  glm::vec3 normal;
+  glm::vec3 tangent;
+  glm::vec3 bitangent;
+};
+
+// tangent x bitangent = normal, so corners listed in this order are counter-clockwise from outside
+inline const std::array<CubeFace, 6> CUBE_FACES = {{
+    {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+    {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+    {{0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+    {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+    {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+    {{0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+}};
+
+// Bit layout of TerrainVertex::data, must match shaders/terrain.vert
+constexpr uint32_t TERRAIN_U_SHIFT = 0;
+constexpr uint32_t TERRAIN_V_SHIFT = 5;
+constexpr uint32_t TERRAIN_BLOCK_LIGHT_SHIFT = 10;
+constexpr uint32_t TERRAIN_SKY_LIGHT_SHIFT = 14;
+constexpr uint32_t TERRAIN_AO_SHIFT = 18;
+constexpr uint32_t TERRAIN_TEXTURE_SHIFT = 20;
+
+// Layers of the block texture array that the remaining bits of TerrainVertex::data can address
+constexpr uint32_t MAX_BLOCK_TEXTURES = 1 << (32 - TERRAIN_TEXTURE_SHIFT);
+
+// Texture array layer of each block id
+using BlockTextures = std::array<uint16_t, 256>;
+
+// Ambient occlusion of a vertex, from fully occluded to not occluded at all
+constexpr uint8_t MAX_AMBIENT_OCCLUSION = 3;
+
+/**
+ * Vertex of the terrain meshes. Texture coordinates take 5 bits each so that they can tile the
+ * texture over merged faces, light levels take 4 bits each, ambient occlusion 2 bits and the
+ * texture array layer the rest.
+ */
+struct TerrainVertex {
+  glm::vec3 position;
+  uint32_t data;
+};
+
+[[nodiscard]] constexpr uint32_t packTerrainVertexData(uint32_t u, uint32_t v, uint8_t blockLight,
+                                                       uint8_t skyLight, uint8_t ambientOcclusion,
+                                                       uint16_t texture = 0) {
+  return u << TERRAIN_U_SHIFT | v << TERRAIN_V_SHIFT |
+         static_cast<uint32_t>(blockLight) << TERRAIN_BLOCK_LIGHT_SHIFT |
+         static_cast<uint32_t>(skyLight) << TERRAIN_SKY_LIGHT_SHIFT |
+         static_cast<uint32_t>(ambientOcclusion) << TERRAIN_AO_SHIFT |
+         static_cast<uint32_t>(texture) << TERRAIN_TEXTURE_SHIFT;
+}
+
+struct ChunkMesh {
+  std::vector<TerrainVertex> vertices;
+  std::vector<uint32_t> indices;
+};
+
+/**
+ * New mesh of a chunk at one level of detail
+ */
+struct ChunkMeshUpdate {
+  glm::ivec3 chunkPos;
+  int lod;
+  ChunkMesh mesh;
+};
+
+constexpr int PADDED_CHUNK_SIZE = CHUNK_SIZE + 2;
+constexpr int PADDED_CHUNK_VOLUME = PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE;
+
+// Level of detail 0 is the full resolution, each next one merges 2x2x2 cells of the previous one
+constexpr int LOD_COUNT = 4;
+constexpr int MAX_LOD_CELL_SIZE = 1 << (LOD_COUNT - 1);
+constexpr int LOD_SOURCE_SIZE = CHUNK_SIZE + 2 * MAX_LOD_CELL_SIZE;
+constexpr int LOD_SOURCE_VOLUME = LOD_SOURCE_SIZE * LOD_SOURCE_SIZE * LOD_SOURCE_SIZE;
+// Coarsest level of detail picked for a chunk is the one whose cells still fit in this many pixels
+constexpr float MAX_LOD_CELL_PIXELS = 3.f;
+
+/**
+ * Blocks and light of a chunk surrounded by the neighbour voxels making up the coarsest cells of
+ * its apron, from which every level of detail of the chunk is downsampled
+ */
+struct LodSource {
+  std::array<BlockId, LOD_SOURCE_VOLUME> blocks{};
+  std::array<uint8_t, LOD_SOURCE_VOLUME> light{};
+
+  void fill(const World &world, const LightEngine &lighting, const glm::ivec3 &chunkPos);
+
+  /**
+   * Index of a position relative to the chunk origin, from -MAX_LOD_CELL_SIZE to
+   * CHUNK_SIZE + MAX_LOD_CELL_SIZE - 1 on each axis
+   */
+  [[nodiscard]] static int index(const glm::ivec3 &localPos);
+};
+
+/**
+ * Level of detail to draw a chunk with, given the size on screen of one of its voxels in pixels
+ */
+[[nodiscard]] int selectLod(float voxelPixels);
+
+/**
+ * Blocks and light of a chunk surrounded by a one voxel apron copied from its neighbours, so that
+ * faces and corners on the border can be meshed without looking up other chunks
+ */
+struct PaddedChunk {
+  std::array<BlockId, PADDED_CHUNK_VOLUME> blocks{};
+  // Packed as in ChunkLight
+  std::array<uint8_t, PADDED_CHUNK_VOLUME> light{};
+
+  void fill(const World &world, const LightEngine &lighting, const glm::ivec3 &chunkPos);
+  /**
+   * Fill with the chunk downsampled to a level of detail, still one entry per voxel
+   */
+  void downsample(const LodSource &source, int lod);
+
+  /**
+   * Index of a position relative to the chunk origin, from -1 to CHUNK_SIZE on each axis
+   */
+  [[nodiscard]] static int index(const glm::ivec3 &localPos);
+  [[nodiscard]] bool isSolid(const glm::ivec3 &localPos) const;
+};
+
+enum class MeshingMode {
+  // One quad per visible block face
+  Naive,
+  // Coplanar faces that look the same are merged into maximal rectangles
+  Greedy,
+};
+
+/**
+ * Everything that decides how a block face looks. Greedy meshing merges faces with equal
+ * appearances, as long as their occlusion does not vary along the direction they are merged in.
+ */
+struct FaceAppearance {
+  BlockId block = AIR;
+  // Packed as in ChunkLight
+  uint8_t light = 0;
+  // Per corner, in the counter-clockwise order of the face
+  std::array<uint8_t, 4> occlusions{};
+
+  bool operator==(const FaceAppearance &) const = default;
+};
+
+/**
+ * Build the meshes of the chunks. Only faces between a block and air are emitted, with the light
+ * of the voxel they look at and the ambient occlusion of their corners baked into their vertices.
+ * Only reads the world and its light, so several chunks can be meshed concurrently.
+ */
+class ChunkMesher {
+public:
+  ChunkMesher(const World &sourceWorld, const LightEngine &sourceLighting,
+              const BlockTextures &textures = {});
+
+  [[nodiscard]] ChunkMesh mesh(const glm::ivec3 &chunkPos,
+                               MeshingMode mode = MeshingMode::Naive) const;
+  /**
+   * Meshes of the chunk at the levels of detail 1 to LOD_COUNT - 1, in that order. They are
+   * greedy meshed without ambient occlusion, which is not noticeable at the distance they are
+   * drawn from and would prevent merging faces inside coarse cells.
+   */
+  [[nodiscard]] std::vector<ChunkMesh> meshLods(const glm::ivec3 &chunkPos) const;
+
+private:
+  const World &world;
+  const LightEngine &lighting;
+  BlockTextures blockTextures;
+
+  void meshNaive(ChunkMesh &mesh, const PaddedChunk &padded, const glm::ivec3 &origin) const;
+  void meshGreedy(ChunkMesh &mesh, const PaddedChunk &padded, const glm::ivec3 &origin,
+                  bool occlusion = true) const;
+  void addSkirts(ChunkMesh &mesh, std::span<const PaddedChunk> levels, int lod,
+                 const glm::ivec3 &origin) const;
+
+  [[nodiscard]] static FaceAppearance appearance(const PaddedChunk &padded,
+                                                 const glm::ivec3 &localPos, const CubeFace &face,
+                                                 bool occlusion = true);
+  /**
+   * Add a quad of width by height faces, along the tangent and the bitangent of the face
+   */
+  void addQuad(ChunkMesh &mesh, const glm::vec3 &center, const CubeFace &face, uint32_t width,
+               uint32_t height, const FaceAppearance &look) const;
+  [[nodiscard]] static uint8_t ambientOcclusion(const PaddedChunk &padded,
+                                                const glm::ivec3 &facing, const glm::ivec3 &side1,
+                                                const glm::ivec3 &side2);
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_CHUNK_MESHER_H
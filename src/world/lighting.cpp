@@ -0,0 +1,240 @@
+#include "lighting.h"
+
+#include <algorithm>
+
+namespace plaxel {
+
+namespace {
+const glm::ivec3 DOWN{0, -1, 0};
+const std::array<glm::ivec3, 6> NEIGHBOURS = {{
+    {1, 0, 0},
+    {-1, 0, 0},
+    {0, 1, 0},
+    {0, -1, 0},
+    {0, 0, 1},
+    {0, 0, -1},
+}};
+
+int shiftOf(LightChannel channel) { return channel == LightChannel::Sky ? 4 : 0; }
+} // namespace
+
+LightEngine::LightEngine(const World &sourceWorld, const LightEmissions &blockEmissions)
+    : world(sourceWorld), emissions(blockEmissions) {
+  // From the top so that each chunk is seeded by the sky light of the already lit one above
+  std::vector<glm::ivec3> chunkPositions;
+  for (const auto &[chunkPos, chunk] : world.getChunks()) {
+    chunkPositions.push_back(chunkPos);
+  }
+  std::ranges::sort(chunkPositions,
+                    [](const glm::ivec3 &a, const glm::ivec3 &b) { return a.y > b.y; });
+  for (const auto &chunkPos : chunkPositions) {
+    ensureChunk(chunkPos);
+  }
+  dirtyChunks.clear();
+}
+
+void LightEngine::onEdit(const BlockEdit &edit) {
+  const std::scoped_lock lock(pendingEditsMutex);
+  pendingEdits.push_back(edit);
+}
+
+void LightEngine::update() {
+  std::vector<BlockEdit> edits;
+  {
+    const std::scoped_lock lock(pendingEditsMutex);
+    edits.swap(pendingEdits);
+  }
+  for (const auto &edit : edits) {
+    applyEdit(edit);
+  }
+}
+
+uint8_t LightEngine::getLight(const glm::ivec3 &pos, LightChannel channel) const {
+  const auto it = chunks.find(World::toChunkPos(pos));
+  if (it == chunks.end()) {
+    return channel == LightChannel::Sky ? MAX_LIGHT : 0;
+  }
+  const uint8_t levels = it->second->levels[Chunk::index(World::toLocalPos(pos))];
+  return (levels >> shiftOf(channel)) & 0xF;
+}
+
+const ChunkLight *LightEngine::getChunkLight(const glm::ivec3 &chunkPos) const {
+  const auto it = chunks.find(chunkPos);
+  return it == chunks.end() ? nullptr : it->second.get();
+}
+
+ChunkSet LightEngine::takeDirtyChunks() {
+  ChunkSet result;
+  result.swap(dirtyChunks);
+  return result;
+}
+
+void LightEngine::applyEdit(const BlockEdit &edit) {
+  ensureChunk(World::toChunkPos(edit.pos));
+
+  for (const LightChannel channel : {LightChannel::Block, LightChannel::Sky}) {
+    if (edit.current != AIR) {
+      // The voxel now blocks the light that went through it
+      removeLight(edit.pos, channel);
+      if (const uint8_t emission = emissions[edit.current];
+          channel == LightChannel::Block && emission > 0) {
+        setLight(edit.pos, channel, emission);
+        addQueue.push_back(edit.pos);
+      }
+    } else {
+      if (channel == LightChannel::Block && emissions[edit.previous] > 0) {
+        removeLight(edit.pos, channel);
+      }
+      // The neighbours now light the opened voxel
+      for (const auto &offset : NEIGHBOURS) {
+        if (getLight(edit.pos + offset, channel) > 0) {
+          addQueue.push_back(edit.pos + offset);
+        }
+      }
+    }
+    propagateAdditions(channel);
+  }
+}
+
+/**
+ * Create the light of a chunk seen for the first time. Sky light falls down the columns open to
+ * the voxels above, then the light of the neighbour chunks flows in.
+ */
+void LightEngine::ensureChunk(const glm::ivec3 &chunkPos) {
+  if (chunks.contains(chunkPos)) {
+    return;
+  }
+  chunks.emplace(chunkPos, std::make_unique<ChunkLight>());
+
+  const glm::ivec3 origin = chunkPos * CHUNK_SIZE;
+  std::vector<glm::ivec3> emitters;
+  for (int x = 0; x < CHUNK_SIZE; ++x) {
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+      const glm::ivec3 top = origin + glm::ivec3(x, CHUNK_SIZE - 1, z);
+      bool open = getLight(top - DOWN, LightChannel::Sky) == MAX_LIGHT;
+      for (glm::ivec3 pos = top; pos.y >= origin.y; pos += DOWN) {
+        open = open && !world.isSolid(pos);
+        if (open) {
+          setLight(pos, LightChannel::Sky, MAX_LIGHT);
+          addQueue.push_back(pos);
+        }
+        if (const uint8_t emission = getEmission(pos); emission > 0) {
+          setLight(pos, LightChannel::Block, emission);
+          emitters.push_back(pos);
+        }
+      }
+
+      // The chunk below saw this one as open air, its columns may now be in the shade
+      const glm::ivec3 bottom = origin + glm::ivec3(x, 0, z);
+      if (chunks.contains(World::toChunkPos(bottom + DOWN)) &&
+          getLight(bottom, LightChannel::Sky) < MAX_LIGHT) {
+        removeLight(bottom + DOWN, LightChannel::Sky);
+      }
+    }
+  }
+
+  std::vector<glm::ivec3> borders;
+  for (int i = 0; i < CHUNK_SIZE; ++i) {
+    for (int j = 0; j < CHUNK_SIZE; ++j) {
+      for (const glm::ivec3 &border : {glm::ivec3(-1, i, j), glm::ivec3(CHUNK_SIZE, i, j),
+                                       glm::ivec3(i, -1, j), glm::ivec3(i, CHUNK_SIZE, j),
+                                       glm::ivec3(i, j, -1), glm::ivec3(i, j, CHUNK_SIZE)}) {
+        if (chunks.contains(World::toChunkPos(origin + border))) {
+          borders.push_back(origin + border);
+        }
+      }
+    }
+  }
+
+  addQueue.insert(addQueue.end(), borders.begin(), borders.end());
+  propagateAdditions(LightChannel::Sky);
+  addQueue.insert(addQueue.end(), borders.begin(), borders.end());
+  addQueue.insert(addQueue.end(), emitters.begin(), emitters.end());
+  propagateAdditions(LightChannel::Block);
+}
+
+bool LightEngine::setLight(const glm::ivec3 &pos, LightChannel channel, uint8_t level) {
+  const auto it = chunks.find(World::toChunkPos(pos));
+  if (it == chunks.end()) {
+    return false;
+  }
+  uint8_t &levels = it->second->levels[Chunk::index(World::toLocalPos(pos))];
+  const int shift = shiftOf(channel);
+  levels = static_cast<uint8_t>((levels & ~(0xF << shift)) | (level << shift));
+  markDirty(pos);
+  return true;
+}
+
+void LightEngine::removeLight(const glm::ivec3 &pos, LightChannel channel) {
+  const uint8_t level = getLight(pos, channel);
+  if (level == 0) {
+    return;
+  }
+  setLight(pos, channel, 0);
+  removeQueue.push_back({pos, level});
+  propagateRemovals(channel);
+}
+
+/**
+ * Darken every voxel that was lit through the removed ones. Brighter neighbours are lit by
+ * another source, they are queued to fill the darkened area back.
+ */
+void LightEngine::propagateRemovals(LightChannel channel) {
+  while (!removeQueue.empty()) {
+    const auto [pos, level] = removeQueue.front();
+    removeQueue.pop_front();
+
+    for (const auto &offset : NEIGHBOURS) {
+      const glm::ivec3 neighbour = pos + offset;
+      const uint8_t neighbourLevel = getLight(neighbour, channel);
+      if (neighbourLevel == 0) {
+        continue;
+      }
+      const bool litByPos = neighbourLevel < level ||
+                            (channel == LightChannel::Sky && offset == DOWN &&
+                             level == MAX_LIGHT && neighbourLevel == MAX_LIGHT);
+      const bool isSource = channel == LightChannel::Block && getEmission(neighbour) > 0;
+      if (litByPos && !isSource && setLight(neighbour, channel, 0)) {
+        removeQueue.push_back({neighbour, neighbourLevel});
+      } else {
+        addQueue.push_back(neighbour);
+      }
+    }
+  }
+}
+
+void LightEngine::propagateAdditions(LightChannel channel) {
+  while (!addQueue.empty()) {
+    const glm::ivec3 pos = addQueue.front();
+    addQueue.pop_front();
+
+    const uint8_t level = getLight(pos, channel);
+    if (level <= 1) {
+      continue;
+    }
+    for (const auto &offset : NEIGHBOURS) {
+      const glm::ivec3 neighbour = pos + offset;
+      if (world.isSolid(neighbour)) {
+        continue;
+      }
+      // Sky light keeps its full level while falling straight down
+      const uint8_t propagated =
+          channel == LightChannel::Sky && offset == DOWN && level == MAX_LIGHT ? MAX_LIGHT
+                                                                               : level - 1;
+      if (getLight(neighbour, channel) < propagated &&
+          setLight(neighbour, channel, propagated)) {
+        addQueue.push_back(neighbour);
+      }
+    }
+  }
+}
+
+uint8_t LightEngine::getEmission(const glm::ivec3 &pos) const {
+  return emissions[world.getBlock(pos)];
+}
+
+void LightEngine::markDirty(const glm::ivec3 &pos) {
+  World::insertChunksTouching(pos, dirtyChunks);
+}
+
+} // namespace plaxel
@@ -0,0 +1,96 @@
+#ifndef PLAXEL_LIGHTING_H
+#define PLAXEL_LIGHTING_H
+
+#include "world.h"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace plaxel {
+
+constexpr uint8_t MAX_LIGHT = 15;
+
+enum class LightChannel { Block, Sky };
+
+// Block light level emitted by each block id
+using LightEmissions = std::array<uint8_t, 256>;
+
+/**
+ * Light levels of one chunk, the sky light in the high nibble and the block light in the low one
+ */
+struct ChunkLight {
+  std::array<uint8_t, CHUNK_VOLUME> levels{};
+};
+
+/**
+ * Voxel lighting with a block light channel, emitted by blocks, and a sky light channel, falling
+ * down from the sky without attenuation. Both are flood filled over the non solid voxels, losing
+ * one level per step.
+ *
+ * Edits are applied incrementally: light only spreads from or is removed around the edited
+ * voxels, so an edit costs the size of the area whose light actually changes. Voxels of chunks
+ * that do not exist are open air, lit by the sky.
+ */
+class LightEngine {
+public:
+  /**
+   * Light every chunk already in the world
+   */
+  explicit LightEngine(const World &sourceWorld, const LightEmissions &blockEmissions = {});
+
+  /**
+   * Queue an edit, thread safe
+   */
+  void onEdit(const BlockEdit &edit);
+  /**
+   * Propagate the light changes of the queued edits. Reads the world, which must not be edited
+   * until it returns.
+   */
+  void update();
+
+  [[nodiscard]] uint8_t getLight(const glm::ivec3 &pos, LightChannel channel) const;
+  /**
+   * Light of a whole chunk, nullptr when the chunk is open air fully lit by the sky
+   */
+  [[nodiscard]] const ChunkLight *getChunkLight(const glm::ivec3 &chunkPos) const;
+  /**
+   * Chunks whose light changed since the last call, including the neighbours of changed border
+   * voxels since their faces are lit by them
+   */
+  [[nodiscard]] ChunkSet takeDirtyChunks();
+
+private:
+  struct RemovedLight {
+    glm::ivec3 pos;
+    uint8_t level;
+  };
+
+  const World &world;
+  LightEmissions emissions;
+  std::unordered_map<glm::ivec3, std::unique_ptr<ChunkLight>, IVec3Hash> chunks;
+  ChunkSet dirtyChunks;
+
+  std::mutex pendingEditsMutex;
+  std::vector<BlockEdit> pendingEdits;
+
+  std::deque<glm::ivec3> addQueue;
+  std::deque<RemovedLight> removeQueue;
+
+  void applyEdit(const BlockEdit &edit);
+  void ensureChunk(const glm::ivec3 &chunkPos);
+  bool setLight(const glm::ivec3 &pos, LightChannel channel, uint8_t level);
+  void removeLight(const glm::ivec3 &pos, LightChannel channel);
+  void propagateRemovals(LightChannel channel);
+  void propagateAdditions(LightChannel channel);
+  [[nodiscard]] uint8_t getEmission(const glm::ivec3 &pos) const;
+  void markDirty(const glm::ivec3 &pos);
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_LIGHTING_H
@@ -0,0 +1,104 @@
+#include "terrain.h"
+
+namespace plaxel {
+
+Terrain::Terrain(World &sourceWorld, JobSystem &jobSystem, const LightEmissions &emissions,
+                 const BlockTextures &textures)
+    : world(sourceWorld), jobs(jobSystem), lighting(sourceWorld, emissions),
+      mesher(sourceWorld, lighting, textures) {
+  for (const auto &[chunkPos, chunk] : world.getChunks()) {
+    editedChunks.insert(chunkPos);
+  }
+  sourceWorld.addEditListener([this](const BlockEdit &edit) {
+    lighting.onEdit(edit);
+    const std::scoped_lock lock(editedChunksMutex);
+    World::insertChunksTouching(edit.pos, editedChunks);
+  });
+}
+
+void Terrain::update() {
+  lighting.update();
+
+  ChunkSet dirtyChunks = lighting.takeDirtyChunks();
+  std::vector<glm::ivec3> chunkPositions;
+  std::vector<MeshingMode> modes;
+  {
+    const std::scoped_lock lock(editedChunksMutex);
+    dirtyChunks.merge(editedChunks);
+    editedChunks.clear();
+
+    for (const auto &chunkPos : dirtyChunks) {
+      if (world.getChunk(chunkPos)) {
+        chunkPositions.push_back(chunkPos);
+        const auto mode = chunkMeshingModes.find(chunkPos);
+        modes.push_back(mode != chunkMeshingModes.end() ? mode->second : defaultMeshingMode);
+      }
+    }
+  }
+
+  for (const auto &chunkPos : chunkPositions) {
+    for (int i = 0; i < 27; ++i) {
+      lodDirtyChunks.insert(chunkPos + glm::ivec3(i % 3 - 1, i / 3 % 3 - 1, i / 9 - 1));
+    }
+  }
+  std::vector<glm::ivec3> lodChunkPositions;
+  while (!lodDirtyChunks.empty() && lodChunkPositions.size() < MAX_LOD_REMESHES_PER_UPDATE) {
+    const glm::ivec3 chunkPos = *lodDirtyChunks.begin();
+    lodDirtyChunks.erase(lodDirtyChunks.begin());
+    if (world.getChunk(chunkPos)) {
+      lodChunkPositions.push_back(chunkPos);
+    }
+  }
+
+  std::vector<ChunkMesh> chunkMeshes(chunkPositions.size());
+  std::vector<std::vector<ChunkMesh>> lodMeshes(lodChunkPositions.size());
+  const size_t jobCount = chunkPositions.size() + lodChunkPositions.size();
+  jobs.parallelFor(jobCount, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (i < chunkPositions.size()) {
+        chunkMeshes[i] = mesher.mesh(chunkPositions[i], modes[i]);
+      } else {
+        const size_t lodIndex = i - chunkPositions.size();
+        lodMeshes[lodIndex] = mesher.meshLods(lodChunkPositions[lodIndex]);
+      }
+    }
+  });
+
+  for (size_t i = 0; i < chunkPositions.size(); ++i) {
+    meshes.push_back({chunkPositions[i], 0, std::move(chunkMeshes[i])});
+  }
+  for (size_t i = 0; i < lodChunkPositions.size(); ++i) {
+    for (size_t level = 0; level < lodMeshes[i].size(); ++level) {
+      meshes.push_back(
+          {lodChunkPositions[i], static_cast<int>(level) + 1, std::move(lodMeshes[i][level])});
+    }
+  }
+}
+
+std::vector<ChunkMeshUpdate> Terrain::takeMeshes() {
+  std::vector<ChunkMeshUpdate> result;
+  result.swap(meshes);
+  return result;
+}
+
+const LightEngine &Terrain::getLighting() const { return lighting; }
+
+void Terrain::setMeshingMode(MeshingMode mode) {
+  const std::scoped_lock lock(editedChunksMutex);
+  defaultMeshingMode = mode;
+  for (const auto &[chunkPos, chunk] : world.getChunks()) {
+    editedChunks.insert(chunkPos);
+  }
+}
+
+void Terrain::setMeshingMode(const glm::ivec3 &chunkPos, std::optional<MeshingMode> mode) {
+  const std::scoped_lock lock(editedChunksMutex);
+  if (mode) {
+    chunkMeshingModes[chunkPos] = *mode;
+  } else {
+    chunkMeshingModes.erase(chunkPos);
+  }
+  editedChunks.insert(chunkPos);
+}
+
+} // namespace plaxel
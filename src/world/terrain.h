@@ -0,0 +1,69 @@
+#ifndef PLAXEL_TERRAIN_H
+#define PLAXEL_TERRAIN_H
+
+#include "../jobs/job_system.h"
+#include "chunk_mesher.h"
+#include "lighting.h"
+#include "world.h"
+
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace plaxel {
+
+// Coarse meshes are only seen from afar, so their updates are spread over several frames
+constexpr size_t MAX_LOD_REMESHES_PER_UPDATE = 8;
+
+/**
+ * Keeps the light and the meshes of the world up to date with its edits. Only the chunks touched
+ * by an edit, or by the light it changed, are remeshed. Coarse cells span up to MAX_LOD_CELL_SIZE
+ * voxels, so the coarse meshes of the neighbours of those chunks are rebuilt too, a few per update.
+ */
+class Terrain {
+public:
+  Terrain(World &sourceWorld, JobSystem &jobSystem, const LightEmissions &emissions = {},
+          const BlockTextures &textures = {});
+
+  /**
+   * Relight and remesh after the edits made since the last call, meshing chunks in parallel.
+   * Meant to run as a job: it reads the world, which must not be edited until it returns.
+   */
+  void update();
+
+  /**
+   * Meshes built by the previous updates, which must be complete
+   */
+  [[nodiscard]] std::vector<ChunkMeshUpdate> takeMeshes();
+
+  [[nodiscard]] const LightEngine &getLighting() const;
+
+  /**
+   * Meshing mode of the chunks without their own, greedy unless changed. Every chunk is remeshed.
+   */
+  void setMeshingMode(MeshingMode mode);
+  /**
+   * Override the meshing mode of one chunk, or remove its override when mode is empty
+   */
+  void setMeshingMode(const glm::ivec3 &chunkPos, std::optional<MeshingMode> mode);
+
+private:
+  const World &world;
+  JobSystem &jobs;
+  LightEngine lighting;
+  ChunkMesher mesher;
+
+  // Guards the edited chunks and the meshing modes, which are changed while update runs
+  std::mutex editedChunksMutex;
+  ChunkSet editedChunks;
+  MeshingMode defaultMeshingMode = MeshingMode::Greedy;
+  std::unordered_map<glm::ivec3, MeshingMode, IVec3Hash> chunkMeshingModes;
+  // Only accessed by update
+  ChunkSet lodDirtyChunks;
+  std::vector<ChunkMeshUpdate> meshes;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_TERRAIN_H
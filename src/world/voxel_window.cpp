@@ -0,0 +1,95 @@
+#include "voxel_window.h"
+
+#include <algorithm>
+
+namespace plaxel {
+
+VoxelWindow::VoxelWindow(const World &sourceWorld)
+    : world(sourceWorld), words(VOXEL_WINDOW_WORD_COUNT, 0) {
+  refill();
+}
+
+void VoxelWindow::setOrigin(const glm::ivec3 &newOrigin) {
+  if (newOrigin == origin) {
+    return;
+  }
+  origin = newOrigin;
+  refill();
+}
+
+const glm::ivec3 &VoxelWindow::getOrigin() const { return origin; }
+
+void VoxelWindow::onEdit(const BlockEdit &edit) {
+  if (const glm::ivec3 localPos = edit.pos - origin; contains(localPos)) {
+    store(index(localPos), edit.current);
+  }
+}
+
+BlockId VoxelWindow::getBlock(const glm::ivec3 &pos) const {
+  const glm::ivec3 localPos = pos - origin;
+  if (!contains(localPos)) {
+    return AIR;
+  }
+  const int voxelIndex = index(localPos);
+  return static_cast<BlockId>(words[voxelIndex >> 2] >> ((voxelIndex & 3) * 8));
+}
+
+const std::vector<uint32_t> &VoxelWindow::getWords() const { return words; }
+
+std::pair<uint32_t, uint32_t> VoxelWindow::takeDirtyWords() {
+  const std::pair range{dirtyBegin, dirtyEnd};
+  dirtyBegin = 0;
+  dirtyEnd = 0;
+  return range;
+}
+
+int VoxelWindow::index(const glm::ivec3 &localPos) {
+  return (localPos.y * VOXEL_WINDOW_SIZE_Z + localPos.z) * VOXEL_WINDOW_SIZE_X + localPos.x;
+}
+
+bool VoxelWindow::contains(const glm::ivec3 &localPos) const {
+  return localPos.x >= 0 && localPos.y >= 0 && localPos.z >= 0 &&
+         localPos.x < VOXEL_WINDOW_SIZE_X && localPos.y < VOXEL_WINDOW_SIZE_Y &&
+         localPos.z < VOXEL_WINDOW_SIZE_Z;
+}
+
+void VoxelWindow::store(int voxelIndex, BlockId block) {
+  const auto word = static_cast<uint32_t>(voxelIndex >> 2);
+  const int shift = (voxelIndex & 3) * 8;
+  words[word] = (words[word] & ~(0xFFu << shift)) | (static_cast<uint32_t>(block) << shift);
+  markDirty(word);
+}
+
+void VoxelWindow::markDirty(uint32_t word) {
+  if (dirtyBegin == dirtyEnd) {
+    dirtyBegin = word;
+    dirtyEnd = word + 1;
+    return;
+  }
+  dirtyBegin = std::min(dirtyBegin, word);
+  dirtyEnd = std::max(dirtyEnd, word + 1);
+}
+
+void VoxelWindow::refill() {
+  std::ranges::fill(words, 0);
+  // Only walk the chunks that exist instead of every voxel of the window
+  for (const auto &[chunkPos, chunk] : world.getChunks()) {
+    const glm::ivec3 chunkOrigin = chunkPos * CHUNK_SIZE;
+    for (int y = 0; y < CHUNK_SIZE; ++y) {
+      for (int z = 0; z < CHUNK_SIZE; ++z) {
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+          const glm::ivec3 localPos = chunkOrigin + glm::ivec3(x, y, z) - origin;
+          if (const BlockId block = chunk->getBlock({x, y, z});
+              block != AIR && contains(localPos)) {
+            const int voxelIndex = index(localPos);
+            words[voxelIndex >> 2] |= static_cast<uint32_t>(block) << ((voxelIndex & 3) * 8);
+          }
+        }
+      }
+    }
+  }
+  dirtyBegin = 0;
+  dirtyEnd = VOXEL_WINDOW_WORD_COUNT;
+}
+
+} // namespace plaxel
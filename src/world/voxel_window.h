@@ -0,0 +1,63 @@
+#ifndef PLAXEL_VOXEL_WINDOW_H
+#define PLAXEL_VOXEL_WINDOW_H
+
+#include "world.h"
+
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <utility>
+#include <vector>
+
+namespace plaxel {
+
+// Must match WINDOW_SIZE in the shaders reading the window
+constexpr int VOXEL_WINDOW_SIZE_X = 128;
+constexpr int VOXEL_WINDOW_SIZE_Y = 64;
+constexpr int VOXEL_WINDOW_SIZE_Z = 32;
+constexpr int VOXEL_WINDOW_VOLUME = VOXEL_WINDOW_SIZE_X * VOXEL_WINDOW_SIZE_Y * VOXEL_WINDOW_SIZE_Z;
+// Block ids are packed 4 per 32 bits word, since GLSL has no 8 bits storage by default
+constexpr int VOXEL_WINDOW_WORD_COUNT = VOXEL_WINDOW_VOLUME / 4;
+
+/**
+ * Dense copy of the blocks of a fixed box of the world, laid out for GPU passes (e.g. particle
+ * collisions) that need random access to voxels. It follows the world edits and remembers which
+ * words changed since the last upload, so that only those need to be copied again.
+ */
+class VoxelWindow {
+public:
+  explicit VoxelWindow(const World &sourceWorld);
+
+  /**
+   * Move the window so that its lowest corner is at origin, which refills every voxel
+   */
+  void setOrigin(const glm::ivec3 &newOrigin);
+  [[nodiscard]] const glm::ivec3 &getOrigin() const;
+
+  void onEdit(const BlockEdit &edit);
+
+  [[nodiscard]] BlockId getBlock(const glm::ivec3 &pos) const;
+  [[nodiscard]] const std::vector<uint32_t> &getWords() const;
+
+  /**
+   * Range [first, end) of the words changed since the last call, empty if nothing changed
+   */
+  [[nodiscard]] std::pair<uint32_t, uint32_t> takeDirtyWords();
+
+  [[nodiscard]] static int index(const glm::ivec3 &localPos);
+
+private:
+  const World &world;
+  glm::ivec3 origin{-VOXEL_WINDOW_SIZE_X / 2, WORLD_FLOOR_Y, -VOXEL_WINDOW_SIZE_Z / 2};
+  std::vector<uint32_t> words;
+  uint32_t dirtyBegin = 0;
+  uint32_t dirtyEnd = 0;
+
+  [[nodiscard]] bool contains(const glm::ivec3 &localPos) const;
+  void store(int voxelIndex, BlockId block);
+  void markDirty(uint32_t word);
+  void refill();
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_VOXEL_WINDOW_H
@@ -0,0 +1,88 @@
+#include "world.h"
+
+namespace plaxel {
+
+BlockId Chunk::getBlock(const glm::ivec3 &localPos) const { return blocks[index(localPos)]; }
+
+void Chunk::setBlock(const glm::ivec3 &localPos, BlockId block) {
+  blocks[index(localPos)] = block;
+}
+
+int Chunk::index(const glm::ivec3 &localPos) {
+  return (localPos.y * CHUNK_SIZE + localPos.z) * CHUNK_SIZE + localPos.x;
+}
+
+BlockId World::getBlock(const glm::ivec3 &pos) const {
+  const Chunk *chunk = getChunk(toChunkPos(pos));
+  if (!chunk) {
+    return AIR;
+  }
+  return chunk->getBlock(toLocalPos(pos));
+}
+
+bool World::isSolid(const glm::ivec3 &pos) const { return getBlock(pos) != AIR; }
+
+void World::setBlock(const glm::ivec3 &pos, BlockId block) {
+  const glm::ivec3 chunkPos = toChunkPos(pos);
+  auto it = chunks.find(chunkPos);
+  if (it == chunks.end()) {
+    if (block == AIR) {
+      return;
+    }
+    it = chunks.emplace(chunkPos, std::make_unique<Chunk>()).first;
+  }
+
+  const glm::ivec3 localPos = toLocalPos(pos);
+  const BlockId previous = it->second->getBlock(localPos);
+  if (previous == block) {
+    return;
+  }
+  it->second->setBlock(localPos, block);
+
+  const BlockEdit edit{pos, previous, block};
+  for (const auto &listener : editListeners) {
+    listener(edit);
+  }
+}
+
+void World::addEditListener(EditListener listener) {
+  editListeners.push_back(std::move(listener));
+}
+
+const Chunk *World::getChunk(const glm::ivec3 &chunkPos) const {
+  const auto it = chunks.find(chunkPos);
+  return it == chunks.end() ? nullptr : it->second.get();
+}
+
+const std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, IVec3Hash> &
+World::getChunks() const {
+  return chunks;
+}
+
+glm::ivec3 World::toChunkPos(const glm::ivec3 &pos) {
+  // Arithmetic shift rounds towards negative infinity, so negative coordinates map correctly
+  return {pos.x >> CHUNK_SHIFT, pos.y >> CHUNK_SHIFT, pos.z >> CHUNK_SHIFT};
+}
+
+glm::ivec3 World::toLocalPos(const glm::ivec3 &pos) {
+  return {pos.x & (CHUNK_SIZE - 1), pos.y & (CHUNK_SIZE - 1), pos.z & (CHUNK_SIZE - 1)};
+}
+
+void World::insertChunksTouching(const glm::ivec3 &pos, ChunkSet &chunkPositions) {
+  const glm::ivec3 chunkPos = toChunkPos(pos);
+  const glm::ivec3 localPos = toLocalPos(pos);
+  // Per axis, the range of chunk offsets whose one voxel apron contains the voxel
+  const glm::ivec3 low(localPos.x == 0 ? -1 : 0, localPos.y == 0 ? -1 : 0,
+                       localPos.z == 0 ? -1 : 0);
+  const glm::ivec3 high(localPos.x == CHUNK_SIZE - 1 ? 1 : 0, localPos.y == CHUNK_SIZE - 1 ? 1 : 0,
+                        localPos.z == CHUNK_SIZE - 1 ? 1 : 0);
+  for (int x = low.x; x <= high.x; ++x) {
+    for (int y = low.y; y <= high.y; ++y) {
+      for (int z = low.z; z <= high.z; ++z) {
+        chunkPositions.insert(chunkPos + glm::ivec3(x, y, z));
+      }
+    }
+  }
+}
+
+} // namespace plaxel
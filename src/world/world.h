@@ -0,0 +1,84 @@
+#ifndef PLAXEL_WORLD_H
+#define PLAXEL_WORLD_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <glm/vec3.hpp>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace plaxel {
+
+using BlockId = uint8_t;
+constexpr BlockId AIR = 0;
+
+constexpr int CHUNK_SHIFT = 4;
+constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+// Blocks at or below this height are considered attached to the bedrock and never fall
+constexpr int WORLD_FLOOR_Y = 0;
+
+struct IVec3Hash {
+  size_t operator()(const glm::ivec3 &v) const {
+    // Large primes to spread neighbouring coordinates across buckets
+    return static_cast<size_t>(v.x) * 73856093u ^ static_cast<size_t>(v.y) * 19349663u ^
+           static_cast<size_t>(v.z) * 83492791u;
+  }
+};
+
+using ChunkSet = std::unordered_set<glm::ivec3, IVec3Hash>;
+
+struct BlockEdit {
+  glm::ivec3 pos;
+  BlockId previous;
+  BlockId current;
+};
+
+class Chunk {
+public:
+  [[nodiscard]] BlockId getBlock(const glm::ivec3 &localPos) const;
+  void setBlock(const glm::ivec3 &localPos, BlockId block);
+
+  [[nodiscard]] static int index(const glm::ivec3 &localPos);
+
+private:
+  std::array<BlockId, CHUNK_VOLUME> blocks{};
+};
+
+class World {
+public:
+  using EditListener = std::function<void(const BlockEdit &)>;
+
+  [[nodiscard]] BlockId getBlock(const glm::ivec3 &pos) const;
+  [[nodiscard]] bool isSolid(const glm::ivec3 &pos) const;
+  void setBlock(const glm::ivec3 &pos, BlockId block);
+
+  /**
+   * Listeners are notified synchronously after every block change
+   */
+  void addEditListener(EditListener listener);
+
+  [[nodiscard]] const Chunk *getChunk(const glm::ivec3 &chunkPos) const;
+  [[nodiscard]] const std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, IVec3Hash> &
+  getChunks() const;
+
+  [[nodiscard]] static glm::ivec3 toChunkPos(const glm::ivec3 &pos);
+  [[nodiscard]] static glm::ivec3 toLocalPos(const glm::ivec3 &pos);
+  /**
+   * Insert the chunk of a voxel, and the neighbour chunks touching it when it lies on the border,
+   * including the diagonal ones
+   */
+  static void insertChunksTouching(const glm::ivec3 &pos, ChunkSet &chunkPositions);
+
+private:
+  std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, IVec3Hash> chunks;
+  std::vector<EditListener> editListeners;
+};
+
+} // namespace plaxel
+
+#endif // PLAXEL_WORLD_H
@@ -0,0 +1,61 @@
+#include "../../src/assets/asset_pack.h"
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+using namespace plaxel;
+
+namespace {
+std::filesystem::path writePack(const std::vector<uint8_t> &content) {
+  const auto path = std::filesystem::temp_directory_path() / "plaxel_asset_pack_test.pack";
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(content.data()),
+             static_cast<std::streamsize>(content.size()));
+  return path;
+}
+
+std::string toString(std::span<const char> content) { return {content.begin(), content.end()}; }
+} // namespace
+
+TEST(AssetPackTest, FindsEveryAssetItWasWrittenWith) {
+  const auto path = writePack(writeAssetPack({{"textures/b.ktx2", {'b', 'b', 'b'}},
+                                              {"shaders/a.spv", {'a'}},
+                                              {"empty", {}},
+                                              {"textures/c.ktx2", {'c', 'c'}}}));
+  const AssetPack pack(path);
+
+  EXPECT_EQ(pack.size(), 4u);
+  EXPECT_EQ(toString(*pack.find("shaders/a.spv")), "a");
+  EXPECT_EQ(toString(*pack.find("textures/b.ktx2")), "bbb");
+  EXPECT_EQ(toString(*pack.find("textures/c.ktx2")), "cc");
+  EXPECT_TRUE(pack.find("empty")->empty());
+  EXPECT_FALSE(pack.find("textures").has_value());
+  EXPECT_FALSE(pack.find("textures/d.ktx2").has_value());
+  EXPECT_FALSE(pack.find("").has_value());
+}
+
+TEST(AssetPackTest, ContentsAreAligned) {
+  const auto path = writePack(writeAssetPack({{"a", {1, 2, 3}}, {"b", {4}}, {"c", {5, 6}}}));
+  const AssetPack pack(path);
+
+  for (const char *name : {"a", "b", "c"}) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(pack.find(name)->data()) % ASSET_PACK_ALIGNMENT, 0u);
+  }
+}
+
+TEST(AssetPackTest, RejectsOtherVersionsAndFormats) {
+  std::vector<uint8_t> content = writeAssetPack({{"a", {1}}});
+  // The version follows the magic
+  content[8]++;
+  EXPECT_THROW(AssetPack{writePack(content)}, AssetPackError);
+
+  content[8]--;
+  content[0] = 'X';
+  EXPECT_THROW(AssetPack{writePack(content)}, AssetPackError);
+
+  EXPECT_THROW(AssetPack{writePack({1, 2, 3})}, AssetPackError);
+}
+
+TEST(AssetPackTest, RejectsDuplicateAssets) {
+  EXPECT_THROW((void)writeAssetPack({{"a", {1}}, {"a", {2}}}), AssetPackError);
+}
@@ -0,0 +1,26 @@
+#include "../../src/assets/asset_watcher.h"
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+using namespace plaxel;
+
+#ifdef __linux__
+TEST(AssetWatcherTest, ReportsWrittenFilesOnce) {
+  const auto directory = std::filesystem::temp_directory_path() / "plaxel_asset_watcher_test";
+  std::filesystem::create_directories(directory);
+  AssetWatcher watcher;
+  watcher.watch(directory);
+
+  for (int i = 0; i < 2; ++i) {
+    std::ofstream(directory / "shader.comp") << "void main() {}" << i;
+  }
+  std::ofstream(directory / "texture.tmp") << "pixels";
+  std::filesystem::rename(directory / "texture.tmp", directory / "texture.png");
+
+  const auto changes = watcher.waitForChanges(std::chrono::seconds(1));
+  EXPECT_EQ(changes, (std::vector{directory / "shader.comp", directory / "texture.tmp",
+                                  directory / "texture.png"}));
+  EXPECT_TRUE(watcher.waitForChanges(std::chrono::milliseconds(0)).empty());
+}
+#endif
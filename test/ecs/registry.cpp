@@ -0,0 +1,85 @@
+#include "../../src/ecs/components.h"
+#include "../../src/ecs/registry.h"
+#include "../../src/ecs/systems.h"
+#include <gtest/gtest.h>
+
+using namespace plaxel;
+
+TEST(RegistryTest, DestroyedHandleIsNotReused) {
+  // Arrange
+  Registry registry;
+  const Entity first = registry.create();
+  registry.destroy(first);
+
+  // Act
+  const Entity second = registry.create();
+
+  // Assert
+  EXPECT_EQ(first.index, second.index);
+  EXPECT_FALSE(registry.isAlive(first));
+  EXPECT_TRUE(registry.isAlive(second));
+  EXPECT_THROW(registry.add<Position>(first), RegistryError);
+}
+
+TEST(RegistryTest, ComponentsSurviveRemovalOfOtherEntities) {
+  // Arrange
+  Registry registry;
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i) {
+    const Entity entity = registry.create();
+    registry.add<Position>(entity, {glm::vec3(static_cast<float>(i))});
+    entities.push_back(entity);
+  }
+
+  // Act
+  registry.destroy(entities[0]);
+  registry.destroy(entities[4]);
+
+  // Assert
+  EXPECT_EQ(registry.aliveCount(), 8);
+  EXPECT_FALSE(registry.has<Position>(entities[4]));
+  for (int i : {1, 2, 3, 5, 9}) {
+    EXPECT_EQ(registry.get<Position>(entities[i]).value.x, static_cast<float>(i));
+  }
+}
+
+TEST(RegistryTest, ViewOnlyVisitsEntitiesWithAllComponents) {
+  // Arrange
+  Registry registry;
+  for (int i = 0; i < 100; ++i) {
+    const Entity entity = registry.create();
+    registry.add<Position>(entity);
+    if (i % 2 == 0) {
+      registry.add<Velocity>(entity, {glm::vec3(1.f, 0.f, 0.f)});
+    }
+  }
+  registry.align<Velocity, Position>();
+
+  // Act
+  int visited = 0;
+  registry.view<Velocity, Position>().each([&visited](const Velocity &, Position &) { visited++; });
+
+  // Assert
+  EXPECT_EQ(visited, 50);
+}
+
+TEST(RegistryTest, ParallelIntegrationMovesEveryEntity) {
+  // Arrange
+  Registry registry;
+  JobSystem jobs(4);
+  std::vector<Entity> entities;
+  for (int i = 0; i < 20000; ++i) {
+    const Entity entity = registry.create();
+    registry.add<Position>(entity);
+    registry.add<Velocity>(entity, {glm::vec3(0.f, static_cast<float>(i), 0.f)});
+    entities.push_back(entity);
+  }
+
+  // Act
+  integrateVelocities(registry, jobs, 0.5f);
+
+  // Assert
+  for (int i = 0; i < 20000; ++i) {
+    ASSERT_EQ(registry.get<Position>(entities[i]).value.y, static_cast<float>(i) * 0.5f);
+  }
+}
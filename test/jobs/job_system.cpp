@@ -0,0 +1,58 @@
+#include "../../src/jobs/job_system.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+
+using namespace plaxel;
+
+TEST(JobSystemTest, ParallelForCoversEveryIndexOnce) {
+  JobSystem jobs(3);
+  std::vector<int> visits(1000, 0);
+
+  jobs.parallelFor(visits.size(), 64, [&visits](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      ++visits[i];
+    }
+  });
+
+  EXPECT_EQ(std::accumulate(visits.begin(), visits.end(), 0), 1000);
+  EXPECT_EQ(*std::ranges::max_element(visits), 1);
+}
+
+TEST(JobSystemTest, ThrowingJobStillCompletesItsCounter) {
+  // Without workers the job runs inline, its exception still waits for the counter
+  JobSystem jobs(0);
+  JobCounter counter;
+
+  jobs.submit([] { throw std::runtime_error("job failed"); }, &counter);
+
+  EXPECT_TRUE(counter.done());
+  EXPECT_THROW(jobs.wait(counter), std::runtime_error);
+  // Only rethrown once
+  jobs.wait(counter);
+}
+
+TEST(JobSystemTest, ThrowingBatchOnAWorkerRunsTheOthersThenRethrows) {
+  JobSystem jobs(3);
+  std::atomic<int> batchesRun{0};
+
+  EXPECT_THROW(jobs.parallelFor(64, 1,
+                                [&batchesRun](size_t begin, size_t) {
+                                  batchesRun.fetch_add(1, std::memory_order_relaxed);
+                                  if (begin % 8 == 0) {
+                                    throw std::runtime_error("batch failed");
+                                  }
+                                }),
+               std::runtime_error);
+
+  EXPECT_EQ(batchesRun.load(), 64);
+  // The workers survived
+  std::atomic<int> laterBatchesRun{0};
+  jobs.parallelFor(64, 1, [&laterBatchesRun](size_t, size_t) {
+    laterBatchesRun.fetch_add(1, std::memory_order_relaxed);
+  });
+  EXPECT_EQ(laterBatchesRun.load(), 64);
+}
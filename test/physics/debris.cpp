@@ -0,0 +1,189 @@
+#include "../../src/physics/debris.h"
+#include <gtest/gtest.h>
+
+using namespace plaxel;
+
+constexpr BlockId STONE = 1;
+
+namespace {
+void buildFloor(World &world) {
+  for (int x = -4; x <= 4; ++x) {
+    for (int z = -4; z <= 4; ++z) {
+      world.setBlock({x, 0, z}, STONE);
+    }
+  }
+}
+
+void buildPillarWithArm(World &world) {
+  for (int y = 1; y <= 4; ++y) {
+    world.setBlock({0, y, 0}, STONE);
+  }
+  world.setBlock({1, 4, 0}, STONE);
+  world.setBlock({2, 4, 0}, STONE);
+}
+
+void stepUntilSettled(DebrisSystem &debris) {
+  // The first step is always needed for pending edits to spawn their bodies
+  debris.step(1.0f / 60);
+  for (int i = 0; i < 600 && !debris.getBodies().empty(); ++i) {
+    debris.step(1.0f / 60);
+  }
+}
+} // namespace
+
+TEST(DebrisTest, AnchoredStructureStaysInPlace) {
+  // Arrange
+  World world;
+  DebrisSystem debris(world);
+  buildFloor(world);
+  buildPillarWithArm(world);
+
+  // Act
+  world.setBlock({2, 4, 0}, AIR);
+  debris.step(1.0f / 60);
+
+  // Assert
+  EXPECT_TRUE(debris.getBodies().empty());
+  EXPECT_EQ(world.getBlock({1, 4, 0}), STONE);
+}
+
+TEST(DebrisTest, DetachedIslandFallsAndSleeps) {
+  // Arrange
+  World world;
+  DebrisSystem debris(world);
+  buildFloor(world);
+  buildPillarWithArm(world);
+
+  // Act
+  world.setBlock({0, 4, 0}, AIR);
+  debris.step(1.0f / 60);
+
+  // Assert
+  ASSERT_EQ(debris.getBodies().size(), 1);
+  EXPECT_EQ(debris.getBodies()[0].voxels.size(), 2);
+  EXPECT_EQ(world.getBlock({1, 4, 0}), AIR);
+
+  for (int i = 0; i < 60 && debris.awakeBodyCount() > 0; ++i) {
+    debris.step(1.0f / 60);
+  }
+  ASSERT_EQ(debris.getBodies().size(), 1);
+  EXPECT_EQ(debris.awakeBodyCount(), 0);
+}
+
+TEST(DebrisTest, SettledBodyIsWrittenBackIntoTheWorld) {
+  // Arrange
+  World world;
+  DebrisSystem debris(world);
+  buildFloor(world);
+  buildPillarWithArm(world);
+
+  // Act
+  world.setBlock({0, 4, 0}, AIR);
+  stepUntilSettled(debris);
+
+  // Assert
+  EXPECT_TRUE(debris.getBodies().empty());
+  // The arm lands next to the pillar, on the floor
+  EXPECT_EQ(world.getBlock({1, 1, 0}), STONE);
+  EXPECT_EQ(world.getBlock({2, 1, 0}), STONE);
+  EXPECT_EQ(world.getBlock({1, 4, 0}), AIR);
+}
+
+TEST(DebrisTest, BodiesStackOnEachOther) {
+  // Arrange
+  World world;
+  DebrisSystem debris(world);
+  buildFloor(world);
+  for (int y = 1; y <= 6; ++y) {
+    world.setBlock({3, y, 3}, STONE);
+  }
+
+  // Act
+  world.setBlock({3, 2, 3}, AIR);
+  world.setBlock({3, 4, 3}, AIR);
+  debris.step(1.0f / 60);
+  const size_t spawnedBodies = debris.getBodies().size();
+  stepUntilSettled(debris);
+
+  // Assert
+  EXPECT_EQ(spawnedBodies, 2);
+  EXPECT_TRUE(debris.getBodies().empty());
+  for (int y = 1; y <= 4; ++y) {
+    EXPECT_EQ(world.getBlock({3, y, 3}), STONE);
+  }
+  EXPECT_EQ(world.getBlock({3, 5, 3}), AIR);
+  EXPECT_EQ(world.getBlock({3, 6, 3}), AIR);
+}
+
+TEST(DebrisTest, RemovingASupportWakesTheBodyRestingOnIt) {
+  // Arrange
+  World world;
+  DebrisSystem debris(world);
+  buildFloor(world);
+  buildPillarWithArm(world);
+  world.setBlock({1, 1, 0}, STONE);
+  world.setBlock({2, 1, 0}, STONE);
+  world.setBlock({0, 4, 0}, AIR);
+  // The arm falls onto the two supports, then sleeps there before being settled
+  for (int i = 0; i < 600 && (debris.getBodies().empty() || debris.awakeBodyCount() > 0); ++i) {
+    debris.step(1.0f / 60);
+  }
+  ASSERT_EQ(debris.getBodies().size(), 1);
+  ASSERT_EQ(debris.awakeBodyCount(), 0);
+
+  // Act
+  world.setBlock({1, 1, 0}, AIR);
+  debris.step(1.0f / 60);
+
+  // Assert
+  EXPECT_EQ(debris.awakeBodyCount(), 1);
+}
+
+TEST(DebrisTest, SettlingBodyMovesUpRatherThanLosingVoxels) {
+  // Arrange
+  World world;
+  DebrisSystem debris(world);
+  buildFloor(world);
+  buildPillarWithArm(world);
+  world.setBlock({0, 4, 0}, AIR);
+  for (int i = 0; i < 600 && (debris.getBodies().empty() || debris.awakeBodyCount() > 0); ++i) {
+    debris.step(1.0f / 60);
+  }
+  ASSERT_EQ(debris.getBodies().size(), 1);
+  ASSERT_EQ(debris.awakeBodyCount(), 0);
+
+  // Act
+  // Filling a cell of the sleeping body doesn't wake it, it only finds out when settling
+  world.setBlock({2, 1, 0}, STONE);
+  stepUntilSettled(debris);
+
+  // Assert
+  EXPECT_TRUE(debris.getBodies().empty());
+  EXPECT_EQ(world.getBlock({1, 1, 0}), AIR);
+  EXPECT_EQ(world.getBlock({2, 1, 0}), STONE);
+  EXPECT_EQ(world.getBlock({1, 2, 0}), STONE);
+  EXPECT_EQ(world.getBlock({2, 2, 0}), STONE);
+}
+
+TEST(DebrisTest, OwnEditsCanBeToldApartFromOtherEdits) {
+  // Arrange
+  World world;
+  DebrisSystem debris(world);
+  buildFloor(world);
+  buildPillarWithArm(world);
+  std::vector<glm::ivec3> brokenBlocks;
+  world.addEditListener([&debris, &brokenBlocks](const BlockEdit &edit) {
+    if (edit.current == AIR && !debris.isApplyingOwnEdits()) {
+      brokenBlocks.push_back(edit.pos);
+    }
+  });
+
+  // Act
+  world.setBlock({0, 4, 0}, AIR);
+  debris.step(1.0f / 60);
+
+  // Assert
+  ASSERT_EQ(debris.getBodies().size(), 1);
+  ASSERT_EQ(brokenBlocks.size(), 1);
+  EXPECT_EQ(brokenBlocks[0], glm::ivec3(0, 4, 0));
+}
@@ -0,0 +1,85 @@
+#include "../../src/profiling/tracer.h"
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+using namespace plaxel;
+using namespace std::chrono_literals;
+
+namespace {
+
+size_t countOccurrences(const std::string &text, const std::string &pattern) {
+  size_t count = 0;
+  for (size_t i = text.find(pattern); i != std::string::npos; i = text.find(pattern, i + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+std::string exportTrace() {
+  std::ostringstream out;
+  Tracer::get().writeChromeTrace(out);
+  return out.str();
+}
+
+} // namespace
+
+TEST(TracerTest, ScopesOfEveryThreadAreExportedWhileCapturing) {
+  Tracer &tracer = Tracer::get();
+  {
+    PLAXEL_TRACE_SCOPE("beforeWindow");
+  }
+
+  tracer.start();
+  {
+    PLAXEL_TRACE_SCOPE("outer");
+    PLAXEL_TRACE_SCOPE("inner");
+  }
+  std::thread worker([&tracer] {
+    tracer.setThreadName("test \"worker\"");
+    PLAXEL_TRACE_SCOPE("onWorker");
+  });
+  worker.join();
+  const auto gpuStart = Tracer::Clock::now();
+  tracer.recordGpu("scene", gpuStart, gpuStart + 2ms);
+  // Submitted before the window, its range would start at a negative time
+  tracer.recordGpu("previousScene", gpuStart - 1h, gpuStart - 1h + 2ms);
+  tracer.stop();
+  {
+    PLAXEL_TRACE_SCOPE("afterWindow");
+  }
+
+  const std::string trace = exportTrace();
+  EXPECT_EQ(trace.find("beforeWindow"), std::string::npos);
+  EXPECT_EQ(trace.find("afterWindow"), std::string::npos);
+  EXPECT_EQ(trace.find("previousScene"), std::string::npos);
+  EXPECT_EQ(countOccurrences(trace, R"("name":"outer","ph":"X")"), 1u);
+  EXPECT_EQ(countOccurrences(trace, R"("name":"inner","ph":"X")"), 1u);
+  EXPECT_EQ(countOccurrences(trace, R"("name":"onWorker","ph":"X")"), 1u);
+  EXPECT_NE(trace.find(R"("name":"scene","ph":"X","pid":1,"tid":0,)"), std::string::npos);
+  EXPECT_NE(trace.find(R"("dur":2000.000})"), std::string::npos);
+  EXPECT_NE(trace.find(R"("args":{"name":"GPU"})"), std::string::npos);
+  EXPECT_NE(trace.find(R"("args":{"name":"test \"worker\""})"), std::string::npos);
+  EXPECT_EQ(trace.rfind(R"({"displayTimeUnit":"ms","traceEvents":[)", 0), 0u);
+}
+
+TEST(TracerTest, StartingDiscardsThePreviousWindow) {
+  Tracer &tracer = Tracer::get();
+  tracer.start();
+  {
+    PLAXEL_TRACE_SCOPE("firstWindow");
+  }
+  tracer.stop();
+  ASSERT_NE(exportTrace().find("firstWindow"), std::string::npos);
+
+  tracer.start();
+  {
+    PLAXEL_TRACE_SCOPE("secondWindow");
+  }
+  tracer.stop();
+
+  const std::string trace = exportTrace();
+  EXPECT_EQ(trace.find("firstWindow"), std::string::npos);
+  EXPECT_EQ(countOccurrences(trace, "secondWindow"), 1u);
+}
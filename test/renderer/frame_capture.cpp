@@ -0,0 +1,72 @@
+#include "../../src/renderer/frame_capture.h"
+#include <gtest/gtest.h>
+
+#include <iterator>
+
+using namespace plaxel;
+
+namespace {
+CapturedFrame makeFrame() {
+  CapturedFrame frame;
+  frame.width = 2;
+  frame.height = 1;
+  frame.pixels = {1, 2, 3, 255, 4, 5, 6, 255};
+  return frame;
+}
+
+std::vector<uint8_t> readFile(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+} // namespace
+
+TEST(FrameCaptureTest, PpmDropsAlpha) {
+  const std::string header = "P6\n2\n1\n255\n";
+  std::vector<uint8_t> expected(header.begin(), header.end());
+  expected.insert(expected.end(), {1, 2, 3, 4, 5, 6});
+
+  EXPECT_EQ(encodePpm(makeFrame()), expected);
+}
+
+TEST(FrameCaptureTest, WriterKeepsTheCaptureOrder) {
+  const auto directory = std::filesystem::temp_directory_path() / "plaxel_frame_capture_test";
+  std::filesystem::create_directories(directory);
+
+  CaptureWriter writer;
+  writer.writeImage(directory / "frame.ppm", makeFrame());
+  writer.openSequence(directory / "sequence.ppm");
+  for (int i = 0; i < 3; ++i) {
+    writer.appendToSequence(makeFrame());
+  }
+  writer.closeSequence();
+  // Ignored once the sequence is closed
+  writer.appendToSequence(makeFrame());
+  writer.flush();
+
+  const std::vector<uint8_t> frame = encodePpm(makeFrame());
+  EXPECT_EQ(readFile(directory / "frame.ppm"), frame);
+  std::vector<uint8_t> sequence;
+  for (int i = 0; i < 3; ++i) {
+    sequence.insert(sequence.end(), frame.begin(), frame.end());
+  }
+  EXPECT_EQ(readFile(directory / "sequence.ppm"), sequence);
+}
+
+TEST(FrameCaptureTest, QueuingBlocksPastThePendingFrameLimit) {
+  const auto directory = std::filesystem::temp_directory_path() / "plaxel_frame_capture_test";
+  std::filesystem::create_directories(directory);
+
+  constexpr size_t FRAME_COUNT = 20;
+  CaptureWriter writer(2);
+  writer.openSequence(directory / "bounded.ppm");
+  for (size_t i = 0; i < FRAME_COUNT; ++i) {
+    writer.appendToSequence(makeFrame());
+    EXPECT_LE(writer.getPendingFrameCount(), 2u);
+  }
+  writer.closeSequence();
+  writer.flush();
+
+  EXPECT_EQ(writer.getPendingFrameCount(), 0u);
+  EXPECT_EQ(readFile(directory / "bounded.ppm").size(),
+            FRAME_COUNT * encodePpm(makeFrame()).size());
+}
@@ -0,0 +1,61 @@
+#include "../../src/renderer/instance_batch.h"
+#include <gtest/gtest.h>
+
+using namespace plaxel;
+
+TEST(InstanceBatchTest, InstancesAreGroupedByMeshTypeInOrder) {
+  InstanceBatch batch;
+  const glm::mat4 identity(1.0f);
+
+  batch.add(MeshType::Cube, identity, 1);
+  batch.add(MeshType::Sprite, identity, 2);
+  batch.add(MeshType::Cube, identity, 3);
+  batch.add(MeshType::Sprite, identity, 4);
+  batch.add(MeshType::Cube, identity, 5);
+
+  ASSERT_EQ(batch.size(), 5u);
+  const auto &sprites = batch.getInstances(MeshType::Sprite);
+  ASSERT_EQ(sprites.size(), 2u);
+  EXPECT_EQ(sprites[0].sprite, 2u);
+  EXPECT_EQ(sprites[1].sprite, 4u);
+  const auto &cubes = batch.getInstances(MeshType::Cube);
+  ASSERT_EQ(cubes.size(), 3u);
+  EXPECT_EQ(cubes[0].sprite, 1u);
+  EXPECT_EQ(cubes[2].sprite, 5u);
+
+  // Each mesh type starts where the ranges of the previous ones end
+  EXPECT_EQ(batch.getFirstInstance(MeshType::Sprite), 0u);
+  EXPECT_EQ(batch.getFirstInstance(MeshType::Cube), 2u);
+
+  batch.clear();
+  EXPECT_EQ(batch.size(), 0u);
+  EXPECT_EQ(batch.getFirstInstance(MeshType::Cube), 0u);
+}
+
+TEST(InstanceBatchTest, GenerationOnlyChangesWithTheContents) {
+  InstanceBatch batch;
+  const glm::mat4 identity(1.0f);
+  const auto build = [&batch, &identity](std::initializer_list<uint32_t> sprites) {
+    batch.clear();
+    for (const uint32_t sprite : sprites) {
+      batch.add(MeshType::Sprite, identity, sprite);
+    }
+    return batch.getGeneration();
+  };
+
+  const uint64_t initial = batch.getGeneration();
+  const uint64_t twoSprites = build({1, 2});
+  EXPECT_NE(twoSprites, initial);
+  EXPECT_EQ(build({1, 2}), twoSprites);
+
+  const uint64_t changed = build({1, 3});
+  EXPECT_NE(changed, twoSprites);
+  EXPECT_EQ(build({1, 3}), changed);
+
+  const uint64_t shrunk = build({1});
+  EXPECT_NE(shrunk, changed);
+  EXPECT_EQ(build({1}), shrunk);
+  EXPECT_EQ(batch.getInstances(MeshType::Sprite).size(), 1u);
+
+  EXPECT_NE(build({}), shrunk);
+}
@@ -0,0 +1,34 @@
+#include "../../src/renderer/ktx2.h"
+
+#include <gtest/gtest.h>
+
+using namespace plaxel;
+
+TEST(Ktx2Test, ReadsBackTheLevelsItWrote) {
+  const std::vector<std::vector<uint8_t>> levels = {std::vector<uint8_t>(8 * 2 * 8, 1),
+                                                    std::vector<uint8_t>(8, 2),
+                                                    std::vector<uint8_t>(8, 3)};
+  const std::vector<uint8_t> file = writeKtx2(KTX2_FORMAT_BC1_RGB_SRGB_BLOCK, 32, 6, levels);
+
+  const Ktx2Texture texture = readKtx2(file);
+
+  EXPECT_EQ(texture.vkFormat, KTX2_FORMAT_BC1_RGB_SRGB_BLOCK);
+  EXPECT_EQ(texture.width, 32u);
+  EXPECT_EQ(texture.height, 6u);
+  ASSERT_EQ(texture.levels.size(), levels.size());
+  for (size_t level = 0; level < levels.size(); ++level) {
+    ASSERT_EQ(texture.levels[level].length, levels[level].size());
+    // Compressed blocks stay aligned inside the file
+    EXPECT_EQ(texture.levels[level].offset % 8, 0u);
+    EXPECT_TRUE(std::equal(levels[level].begin(), levels[level].end(),
+                           file.begin() + static_cast<long>(texture.levels[level].offset)));
+  }
+}
+
+TEST(Ktx2Test, RejectsFilesThatAreNotKtx2) {
+  std::vector<uint8_t> file = writeKtx2(KTX2_FORMAT_R8G8B8A8_SRGB, 1, 1, {{1, 2, 3, 4}});
+  file[0] = 0;
+
+  EXPECT_THROW((void)readKtx2(file), Ktx2Error);
+  EXPECT_THROW((void)readKtx2(std::span(file).first(20)), Ktx2Error);
+}
@@ -0,0 +1,47 @@
+#include "../../src/renderer/latency_tracker.h"
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+using namespace plaxel;
+using namespace std::chrono_literals;
+
+TEST(LatencyTrackerTest, OldestInputOfEachFrameIsMeasured) {
+  LatencyTracker tracker;
+  const auto start = LatencyTracker::Clock::now();
+
+  tracker.inputReceived(start);
+  tracker.inputReceived(start + 2ms);
+  tracker.frameSubmitted(start + 5ms);
+  tracker.framePresented(start + 6ms);
+
+  // A frame without any input adds no sample
+  tracker.frameSubmitted(start + 20ms);
+  tracker.framePresented(start + 21ms);
+
+  tracker.inputReceived(start + 30ms);
+  tracker.frameSubmitted(start + 33ms);
+  tracker.framePresented(start + 40ms);
+
+  const LatencyReport report = tracker.takeReport();
+  EXPECT_EQ(report.inputToSubmit.samples, 2u);
+  EXPECT_DOUBLE_EQ(report.inputToSubmit.p50Ms, 3.0);
+  EXPECT_DOUBLE_EQ(report.inputToSubmit.p99Ms, 5.0);
+  EXPECT_EQ(report.inputToPresent.samples, 2u);
+  EXPECT_DOUBLE_EQ(report.inputToPresent.p50Ms, 6.0);
+  EXPECT_DOUBLE_EQ(report.inputToPresent.p99Ms, 10.0);
+
+  EXPECT_EQ(tracker.takeReport().inputToSubmit.samples, 0u);
+}
+
+TEST(LatencyTrackerTest, PercentilesUseNearestRank) {
+  std::vector<double> samples(100);
+  std::iota(samples.rbegin(), samples.rend(), 1.0);
+
+  const LatencyPercentiles percentiles = computePercentiles(samples);
+
+  EXPECT_EQ(percentiles.samples, 100u);
+  EXPECT_DOUBLE_EQ(percentiles.p50Ms, 50.0);
+  EXPECT_DOUBLE_EQ(percentiles.p95Ms, 95.0);
+  EXPECT_DOUBLE_EQ(percentiles.p99Ms, 99.0);
+}
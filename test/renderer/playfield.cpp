@@ -0,0 +1,49 @@
+#include "../../src/renderer/playfield.h"
+#include <gtest/gtest.h>
+
+using namespace plaxel;
+
+const glm::vec2 TAN_HALF_FIELD_OF_VIEW{.7f, .4f};
+
+TEST(PlayfieldTest, RowsGoFrontToBackThroughTheLayers) {
+  const Playfield playfield({});
+
+  const auto rows = playfield.visibleRows({0.f, 0.f, 40.f}, TAN_HALF_FIELD_OF_VIEW);
+
+  ASSERT_FALSE(rows.empty());
+  // The camera looks towards negative z, starting at the foreground bound
+  EXPECT_EQ(rows.front().depthChunk, 1);
+  EXPECT_EQ(rows.back().depthChunk, -16);
+  EXPECT_EQ(rows.front().layer, PlayfieldLayer::Foreground);
+  EXPECT_EQ(rows.back().layer, PlayfieldLayer::Background);
+  for (size_t i = 1; i < rows.size(); ++i) {
+    EXPECT_EQ(rows[i].depthChunk, rows[i - 1].depthChunk - 1);
+    EXPECT_GE(rows[i].layer, rows[i - 1].layer);
+    EXPECT_GE(rows[i].scrollChunks.y - rows[i].scrollChunks.x,
+              rows[i - 1].scrollChunks.y - rows[i - 1].scrollChunks.x);
+  }
+}
+
+TEST(PlayfieldTest, OnlyChunksAroundTheCameraAreVisited) {
+  PlayfieldLayout layout;
+  layout.layerBounds = {-8.f, 0.f, 16.f, 32.f};
+  const Playfield playfield(layout);
+  const glm::vec3 eye(1000.f, 20.f, 8.f);
+
+  int visited = 0;
+  playfield.forEachVisibleChunk(eye, TAN_HALF_FIELD_OF_VIEW,
+                                [&](const glm::ivec3 &chunkPos, PlayfieldLayer) {
+                                  visited++;
+                                  EXPECT_GE(chunkPos.z, -2);
+                                  EXPECT_LE(chunkPos.z, 0);
+                                  // At most 40 units away, plus the margin
+                                  EXPECT_NEAR(chunkPos.x * CHUNK_SIZE, 1000, 28 + 2 * CHUNK_SIZE);
+                                });
+  EXPECT_GT(visited, 0);
+}
+
+TEST(PlayfieldTest, NothingIsVisibleFromBehindTheBackground) {
+  const Playfield playfield({});
+
+  EXPECT_TRUE(playfield.visibleRows({0.f, 0.f, -300.f}, TAN_HALF_FIELD_OF_VIEW).empty());
+}
@@ -0,0 +1,44 @@
+#include "../../src/renderer/queue_families.h"
+#include <gtest/gtest.h>
+
+using namespace plaxel;
+using enum vk::QueueFlagBits;
+
+namespace {
+vk::QueueFamilyProperties family(vk::QueueFlags flags) {
+  vk::QueueFamilyProperties properties;
+  properties.queueFlags = flags;
+  properties.queueCount = 1;
+  return properties;
+}
+} // namespace
+
+TEST(QueueFamiliesTest, DedicatedFamiliesArePreferred) {
+  const std::vector families = {family(eTransfer), family(eGraphics | eCompute | eTransfer),
+                                family(eCompute | eTransfer), family(eTransfer | eSparseBinding)};
+
+  const QueueFamilyIndices indices =
+      selectQueueFamilies(families, [](uint32_t index) { return index != 3; });
+
+  EXPECT_EQ(indices.graphicsAndComputeFamily, 1u);
+  EXPECT_EQ(indices.presentFamily, 1u);
+  EXPECT_EQ(indices.computeFamily, 2u);
+  EXPECT_EQ(indices.transferFamily, 0u);
+  EXPECT_TRUE(indices.hasAsyncCompute());
+  EXPECT_TRUE(indices.hasDedicatedTransfer());
+  EXPECT_EQ(indices.getSharingFamilies(), (std::vector<uint32_t>{1, 2, 0}));
+}
+
+TEST(QueueFamiliesTest, SingleFamilyIsShared) {
+  const std::vector families = {family(eGraphics | eCompute | eTransfer)};
+
+  const QueueFamilyIndices indices =
+      selectQueueFamilies(families, [](uint32_t) { return true; });
+
+  EXPECT_TRUE(indices.isComplete());
+  EXPECT_EQ(indices.computeFamily, 0u);
+  EXPECT_EQ(indices.transferFamily, 0u);
+  EXPECT_FALSE(indices.hasAsyncCompute());
+  EXPECT_FALSE(indices.hasDedicatedTransfer());
+  EXPECT_EQ(indices.getSharingFamilies(), std::vector<uint32_t>{0});
+}
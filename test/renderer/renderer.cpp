@@ -45,8 +45,7 @@ TEST(RendererTest, Test) {
   r.showWindow();
 
   // Act
-  // We need to draw 2 frames, to free up one of the swapChainImage so we can use it to save our
-  // screenshot
+  // The compute pass moves the quads a little every frame, the reference is the second one
   r.draw();
   r.draw();
 
@@ -0,0 +1,49 @@
+#include "../../src/renderer/resolution_scaler.h"
+#include <gtest/gtest.h>
+
+using namespace plaxel;
+
+TEST(ResolutionScalerTest, ScaleFollowsTheGpuBudget) {
+  ResolutionScalingConfig config;
+  config.gpuBudgetMs = 10.0;
+  config.minScale = 0.25f;
+  ResolutionScaler scaler(config);
+  EXPECT_FLOAT_EQ(scaler.getScale(), 1.0f);
+
+  // Frames costing their pixel count, twice the budget at full resolution
+  for (int frame = 0; frame < 100; ++frame) {
+    const float scale = scaler.getScale();
+    const float nextScale = scaler.frameMeasured(20.0 * scale * scale);
+    EXPECT_LE(nextScale, scale);
+    EXPECT_GE(nextScale, scale * 0.9f);
+  }
+  const double settledTimeMs = 20.0 * scaler.getScale() * scaler.getScale();
+  EXPECT_LE(settledTimeMs, 10.0);
+  EXPECT_GE(settledTimeMs, 7.5);
+
+  // The resolution comes back once the scene gets cheaper
+  for (int frame = 0; frame < 100; ++frame) {
+    const float scale = scaler.getScale();
+    scaler.frameMeasured(4.0 * scale * scale);
+  }
+  EXPECT_FLOAT_EQ(scaler.getScale(), 1.0f);
+}
+
+TEST(ResolutionScalerTest, ScaleStaysWithinBounds) {
+  ResolutionScalingConfig config;
+  config.gpuBudgetMs = 10.0;
+  config.minScale = 0.5f;
+  config.maxScale = 0.8f;
+  ResolutionScaler scaler(config);
+  EXPECT_FLOAT_EQ(scaler.getScale(), 0.8f);
+
+  for (int frame = 0; frame < 100; ++frame) {
+    scaler.frameMeasured(1000.0);
+  }
+  EXPECT_FLOAT_EQ(scaler.getScale(), 0.5f);
+
+  for (int frame = 0; frame < 100; ++frame) {
+    scaler.frameMeasured(0.1);
+  }
+  EXPECT_FLOAT_EQ(scaler.getScale(), 0.8f);
+}
@@ -0,0 +1,64 @@
+#include "../../src/renderer/tuning_cache.h"
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+
+using namespace plaxel;
+
+namespace {
+std::filesystem::path cachePath() {
+  return std::filesystem::temp_directory_path() / "plaxel_tuning_cache_test.txt";
+}
+} // namespace
+
+TEST(TuningCacheTest, ValuesPersistPerDeviceAndParameter) {
+  std::filesystem::remove(cachePath());
+  {
+    TuningCache cache(cachePath());
+    EXPECT_FALSE(cache.get("10de-2684-1", "particles").has_value());
+    cache.set("10de-2684-1", "particles", 128);
+    cache.set("10005-0-1", "particles", 32);
+    cache.set("10de-2684-1", "particles", 256);
+  }
+
+  const TuningCache cache(cachePath());
+  EXPECT_EQ(cache.get("10de-2684-1", "particles"), 256u);
+  EXPECT_EQ(cache.get("10005-0-1", "particles"), 32u);
+  EXPECT_FALSE(cache.get("10de-2684-2", "particles").has_value());
+  EXPECT_FALSE(cache.get("10de-2684-1", "meshing").has_value());
+}
+
+TEST(TuningCacheTest, DamagedLinesAreIgnored) {
+  std::ofstream(cachePath()) << "10de-2684-1 particles\n"
+                             << "garbage\n"
+                             << "10de-2684-1 meshing 64\n";
+
+  const TuningCache cache(cachePath());
+  EXPECT_FALSE(cache.get("10de-2684-1", "particles").has_value());
+  EXPECT_EQ(cache.get("10de-2684-1", "meshing"), 64u);
+}
+
+TEST(TuningCacheTest, MissingDirectoriesAreCreated) {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "plaxel_tuning_cache_test_dir";
+  std::filesystem::remove_all(directory);
+  const std::filesystem::path path = directory / "nested" / "tuning.txt";
+
+  TuningCache(path).set("10de-2684-1", "particles", 64);
+
+  EXPECT_EQ(TuningCache(path).get("10de-2684-1", "particles"), 64u);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(TuningCacheTest, DefaultPathIsPerUser) {
+  const std::filesystem::path path = getDefaultTuningCachePath();
+  EXPECT_TRUE(path.is_absolute());
+  EXPECT_EQ(path.filename(), "tuning.txt");
+
+#ifndef _WIN32
+  setenv("PLAXEL_TUNING_CACHE", "/tmp/plaxel_custom_tuning.txt", 1);
+  EXPECT_EQ(getDefaultTuningCachePath(), "/tmp/plaxel_custom_tuning.txt");
+  unsetenv("PLAXEL_TUNING_CACHE");
+#endif
+}
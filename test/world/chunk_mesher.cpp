@@ -0,0 +1,219 @@
+#include "../../src/world/chunk_mesher.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <span>
+
+using namespace plaxel;
+
+constexpr BlockId STONE = 1;
+constexpr size_t INDICES_PER_FACE = 6;
+
+namespace {
+uint8_t ambientOcclusionOf(const TerrainVertex &vertex) {
+  return (vertex.data >> TERRAIN_AO_SHIFT) & 0x3;
+}
+} // namespace
+
+TEST(ChunkMesherTest, FacesBetweenBlocksAreCulled) {
+  World world;
+  world.setBlock({3, 3, 3}, STONE);
+  world.setBlock({4, 3, 3}, STONE);
+  const LightEngine lighting(world);
+
+  const ChunkMesh mesh = ChunkMesher(world, lighting).mesh({0, 0, 0});
+
+  EXPECT_EQ(mesh.indices.size(), 10 * INDICES_PER_FACE);
+}
+
+TEST(ChunkMesherTest, FacesAreCulledAcrossChunkBorders) {
+  World world;
+  world.setBlock({CHUNK_SIZE - 1, 3, 3}, STONE);
+  world.setBlock({CHUNK_SIZE, 3, 3}, STONE);
+  const LightEngine lighting(world);
+  const ChunkMesher mesher(world, lighting);
+
+  EXPECT_EQ(mesher.mesh({0, 0, 0}).indices.size(), 5 * INDICES_PER_FACE);
+  EXPECT_EQ(mesher.mesh({1, 0, 0}).indices.size(), 5 * INDICES_PER_FACE);
+}
+
+TEST(ChunkMesherTest, CornersNextToAWallAreOccluded) {
+  World world;
+  world.setBlock({3, 3, 3}, STONE);
+  world.setBlock({4, 4, 3}, STONE);
+  const LightEngine lighting(world);
+
+  const ChunkMesh mesh = ChunkMesher(world, lighting).mesh({0, 0, 0});
+
+  // Top face of the lower block: the quad lying at y = 4 over x and z from 3 to 4
+  const auto isTopFaceCorner = [](const TerrainVertex &vertex) {
+    return vertex.position.y == 4.f && vertex.position.x >= 3.f && vertex.position.x <= 4.f &&
+           vertex.position.z >= 3.f && vertex.position.z <= 4.f;
+  };
+  for (size_t first = 0; first < mesh.vertices.size(); first += 4) {
+    const auto quad = std::span(mesh.vertices).subspan(first, 4);
+    if (!std::ranges::all_of(quad, isTopFaceCorner)) {
+      continue;
+    }
+    for (const auto &vertex : quad) {
+      // Only the side towards the wall is occluded, by one block
+      const uint8_t expected =
+          vertex.position.x == 4.f ? MAX_AMBIENT_OCCLUSION - 1 : MAX_AMBIENT_OCCLUSION;
+      EXPECT_EQ(ambientOcclusionOf(vertex), expected);
+    }
+    return;
+  }
+  FAIL() << "top face not found";
+}
+
+namespace {
+float topFaceArea(const ChunkMesh &mesh, float y) {
+  float area = 0;
+  for (size_t first = 0; first < mesh.vertices.size(); first += 4) {
+    const auto quad = std::span(mesh.vertices).subspan(first, 4);
+    if (std::ranges::all_of(quad, [y](const TerrainVertex &vertex) {
+          return vertex.position.y == y;
+        })) {
+      area += std::abs(quad[2].position.x - quad[0].position.x) *
+              std::abs(quad[2].position.z - quad[0].position.z);
+    }
+  }
+  return area;
+}
+} // namespace
+
+TEST(ChunkMesherTest, GreedyMeshingMergesFlatGroundIntoOneQuadPerSide) {
+  World world;
+  for (int x = 0; x < CHUNK_SIZE; ++x) {
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+      world.setBlock({x, 0, z}, STONE);
+    }
+  }
+  const LightEngine lighting(world);
+
+  const ChunkMesh mesh = ChunkMesher(world, lighting).mesh({0, 0, 0}, MeshingMode::Greedy);
+
+  EXPECT_EQ(mesh.indices.size(), 6 * INDICES_PER_FACE);
+  EXPECT_EQ(topFaceArea(mesh, 1.f), static_cast<float>(CHUNK_SIZE * CHUNK_SIZE));
+  // The texture repeats once per block
+  const uint32_t maxU = std::ranges::max(mesh.vertices, {}, [](const TerrainVertex &vertex) {
+                          return vertex.data & 0x1F;
+                        }).data &
+                        0x1F;
+  EXPECT_EQ(maxU, static_cast<uint32_t>(CHUNK_SIZE));
+}
+
+TEST(ChunkMesherTest, GreedyMeshingCoversTheSameFacesAsNaiveMeshing) {
+  World world;
+  for (int x = 0; x < CHUNK_SIZE; ++x) {
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+      world.setBlock({x, 0, z}, STONE);
+    }
+  }
+  // Occludes the corners around it, which must not be merged with the unoccluded ones
+  world.setBlock({7, 1, 7}, STONE);
+  const LightEngine lighting(world);
+  const ChunkMesher mesher(world, lighting);
+
+  const ChunkMesh naive = mesher.mesh({0, 0, 0}, MeshingMode::Naive);
+  const ChunkMesh greedy = mesher.mesh({0, 0, 0}, MeshingMode::Greedy);
+
+  EXPECT_LT(greedy.indices.size(), naive.indices.size());
+  EXPECT_EQ(topFaceArea(greedy, 1.f), topFaceArea(naive, 1.f));
+  for (size_t first = 0; first < greedy.vertices.size(); first += 4) {
+    const auto quad = std::span(greedy.vertices).subspan(first, 4);
+    const bool touchesBlock = std::ranges::any_of(quad, [](const TerrainVertex &vertex) {
+      return vertex.position.y == 1.f && vertex.position.x >= 7.f && vertex.position.x <= 8.f &&
+             vertex.position.z >= 7.f && vertex.position.z <= 8.f;
+    });
+    // Quads ending at the block are occluded there, so they cannot extend past it
+    if (touchesBlock) {
+      for (const auto &vertex : quad) {
+        EXPECT_GE(vertex.position.x, 6.f);
+        EXPECT_LE(vertex.position.x, 9.f);
+      }
+    }
+  }
+}
+
+TEST(ChunkMesherTest, CoarseCellsKeepTheirMajorityBlock) {
+  World world;
+  // Half of the first 2x2x2 cell, and less than half of the next one
+  world.setBlock({0, 0, 0}, STONE);
+  world.setBlock({1, 0, 0}, STONE);
+  world.setBlock({0, 1, 0}, STONE);
+  world.setBlock({1, 1, 0}, STONE);
+  world.setBlock({2, 0, 0}, STONE);
+  world.setBlock({3, 0, 0}, STONE);
+  world.setBlock({2, 1, 0}, STONE);
+  const LightEngine lighting(world);
+  LodSource source;
+  source.fill(world, lighting, {0, 0, 0});
+
+  PaddedChunk coarse;
+  coarse.downsample(source, 1);
+
+  EXPECT_TRUE(coarse.isSolid({1, 1, 1}));
+  EXPECT_FALSE(coarse.isSolid({2, 0, 0}));
+  EXPECT_EQ(coarse.blocks[PaddedChunk::index({0, 0, 1})], STONE);
+}
+
+TEST(ChunkMesherTest, CoarseMeshesHaveFewerTriangles) {
+  World world;
+  for (int x = 0; x < CHUNK_SIZE; ++x) {
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+      for (int y = 0; y <= (x * 7 + z * 3) % 5; ++y) {
+        world.setBlock({x, y, z}, STONE);
+      }
+    }
+  }
+  const LightEngine lighting(world);
+  const ChunkMesher mesher(world, lighting);
+
+  size_t previous = mesher.mesh({0, 0, 0}, MeshingMode::Greedy).indices.size();
+  for (const auto &lodMesh : mesher.meshLods({0, 0, 0})) {
+    EXPECT_LT(lodMesh.indices.size(), previous);
+    previous = lodMesh.indices.size();
+  }
+}
+
+TEST(ChunkMesherTest, CoarseMeshesCoverFacesCulledByFinerNeighbours) {
+  World world;
+  // The block of the second chunk vanishes from its coarse meshes, but the first chunk culls its
+  // face against it at full resolution
+  world.setBlock({CHUNK_SIZE - 1, 3, 3}, STONE);
+  world.setBlock({CHUNK_SIZE, 3, 3}, STONE);
+  const LightEngine lighting(world);
+
+  const std::vector<ChunkMesh> lods = ChunkMesher(world, lighting).meshLods({1, 0, 0});
+
+  for (const auto &lodMesh : lods) {
+    ASSERT_EQ(lodMesh.vertices.size(), 4u);
+    for (const auto &vertex : lodMesh.vertices) {
+      EXPECT_EQ(vertex.position.x, static_cast<float>(CHUNK_SIZE));
+    }
+  }
+}
+
+TEST(ChunkMesherTest, DistantChunksUseCoarserLevels) {
+  EXPECT_EQ(selectLod(100.f), 0);
+  EXPECT_EQ(selectLod(MAX_LOD_CELL_PIXELS / 2), 1);
+  EXPECT_EQ(selectLod(.01f), LOD_COUNT - 1);
+}
+
+TEST(ChunkMesherTest, VerticesCarryTheTextureOfTheirBlock) {
+  constexpr BlockId GLASS = 7;
+  World world;
+  world.setBlock({3, 3, 3}, STONE);
+  world.setBlock({5, 3, 3}, GLASS);
+  const LightEngine lighting(world);
+  BlockTextures textures{};
+  textures[STONE] = 2;
+  textures[GLASS] = 5;
+
+  const ChunkMesh mesh = ChunkMesher(world, lighting, textures).mesh({0, 0, 0});
+
+  for (const auto &vertex : mesh.vertices) {
+    const uint32_t texture = vertex.data >> TERRAIN_TEXTURE_SHIFT;
+    EXPECT_EQ(texture, vertex.position.x < 5.f ? 2u : 5u);
+  }
+}
@@ -0,0 +1,111 @@
+#include "../../src/world/lighting.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace plaxel;
+
+constexpr BlockId STONE = 1;
+constexpr BlockId LAMP = 2;
+
+namespace {
+LightEmissions lampEmissions() {
+  LightEmissions emissions{};
+  emissions[LAMP] = 14;
+  return emissions;
+}
+
+void buildFloor(World &world) {
+  for (int x = -8; x < 8; ++x) {
+    for (int z = -8; z < 8; ++z) {
+      world.setBlock({x, 0, z}, STONE);
+    }
+  }
+}
+
+void connect(World &world, LightEngine &lighting) {
+  world.addEditListener([&lighting](const BlockEdit &edit) { lighting.onEdit(edit); });
+}
+} // namespace
+
+TEST(LightingTest, SkyLightFallsIntoOpenAir) {
+  World world;
+  buildFloor(world);
+  const LightEngine lighting(world);
+
+  EXPECT_EQ(lighting.getLight({0, 1, 0}, LightChannel::Sky), MAX_LIGHT);
+  EXPECT_EQ(lighting.getLight({0, 0, 0}, LightChannel::Sky), 0);
+  EXPECT_EQ(lighting.getLight({0, 1, 0}, LightChannel::Block), 0);
+}
+
+TEST(LightingTest, RoofShadesTheVoxelsBelowIt) {
+  World world;
+  buildFloor(world);
+  LightEngine lighting(world);
+  connect(world, lighting);
+
+  for (int x = -2; x <= 2; ++x) {
+    for (int z = -2; z <= 2; ++z) {
+      world.setBlock({x, 3, z}, STONE);
+    }
+  }
+  lighting.update();
+
+  // Lit sideways from the open air around the roof
+  EXPECT_EQ(lighting.getLight({0, 2, 0}, LightChannel::Sky), MAX_LIGHT - 3);
+  EXPECT_EQ(lighting.getLight({2, 2, 0}, LightChannel::Sky), MAX_LIGHT - 1);
+
+  world.setBlock({0, 3, 0}, AIR);
+  lighting.update();
+  EXPECT_EQ(lighting.getLight({0, 2, 0}, LightChannel::Sky), MAX_LIGHT);
+}
+
+TEST(LightingTest, BlockLightFadesWithDistanceAndIsRemovedWithItsSource) {
+  World world;
+  buildFloor(world);
+  LightEngine lighting(world, lampEmissions());
+  connect(world, lighting);
+
+  world.setBlock({0, 1, 0}, LAMP);
+  lighting.update();
+  EXPECT_EQ(lighting.getLight({0, 1, 0}, LightChannel::Block), 14);
+  EXPECT_EQ(lighting.getLight({3, 1, 0}, LightChannel::Block), 11);
+  EXPECT_EQ(lighting.getLight({2, 2, 1}, LightChannel::Block), 10);
+  EXPECT_FALSE(lighting.takeDirtyChunks().empty());
+
+  world.setBlock({0, 1, 0}, AIR);
+  lighting.update();
+  EXPECT_EQ(lighting.getLight({0, 1, 0}, LightChannel::Block), 0);
+  EXPECT_EQ(lighting.getLight({3, 1, 0}, LightChannel::Block), 0);
+}
+
+TEST(LightingTest, IncrementalUpdatesMatchLightingFromScratch) {
+  World world;
+  buildFloor(world);
+  LightEngine lighting(world, lampEmissions());
+  connect(world, lighting);
+
+  std::mt19937 random(42);
+  std::uniform_int_distribution coordinate(-6, 5);
+  std::uniform_int_distribution height(1, 20);
+  std::uniform_int_distribution block(0, 5);
+  for (int i = 0; i < 400; ++i) {
+    const BlockId id = block(random) == 0 ? LAMP : block(random) < 3 ? AIR : STONE;
+    world.setBlock({coordinate(random), height(random), coordinate(random)}, id);
+    if (i % 10 == 0) {
+      lighting.update();
+    }
+  }
+  lighting.update();
+
+  const LightEngine reference(world, lampEmissions());
+  for (int x = -8; x < 8; ++x) {
+    for (int y = 0; y < 24; ++y) {
+      for (int z = -8; z < 8; ++z) {
+        for (const LightChannel channel : {LightChannel::Block, LightChannel::Sky}) {
+          ASSERT_EQ(lighting.getLight({x, y, z}, channel), reference.getLight({x, y, z}, channel))
+              << x << " " << y << " " << z;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#include "../../src/world/voxel_window.h"
+#include <gtest/gtest.h>
+
+using namespace plaxel;
+
+constexpr BlockId STONE = 1;
+constexpr BlockId DIRT = 2;
+
+TEST(VoxelWindowTest, FilledFromExistingBlocks) {
+  World world;
+  world.setBlock({3, 2, 1}, STONE);
+  world.setBlock({-5, 0, -7}, DIRT);
+
+  const VoxelWindow window(world);
+
+  EXPECT_EQ(window.getBlock({3, 2, 1}), STONE);
+  EXPECT_EQ(window.getBlock({-5, 0, -7}), DIRT);
+  EXPECT_EQ(window.getBlock({4, 2, 1}), AIR);
+}
+
+TEST(VoxelWindowTest, EditsOnlyDirtyTheirWord) {
+  World world;
+  VoxelWindow window(world);
+  world.addEditListener([&window](const BlockEdit &edit) { window.onEdit(edit); });
+  (void)window.takeDirtyWords();
+
+  world.setBlock({0, 1, 0}, STONE);
+
+  const glm::ivec3 localPos = glm::ivec3(0, 1, 0) - window.getOrigin();
+  const auto word = static_cast<uint32_t>(VoxelWindow::index(localPos) / 4);
+  EXPECT_EQ(window.takeDirtyWords(), std::make_pair(word, word + 1));
+  EXPECT_EQ(window.getBlock({0, 1, 0}), STONE);
+
+  // Nothing left to upload once taken
+  const auto [begin, end] = window.takeDirtyWords();
+  EXPECT_EQ(begin, end);
+}
+
+TEST(VoxelWindowTest, BlocksOutsideTheWindowAreIgnored) {
+  World world;
+  VoxelWindow window(world);
+  world.addEditListener([&window](const BlockEdit &edit) { window.onEdit(edit); });
+  (void)window.takeDirtyWords();
+
+  world.setBlock({0, VOXEL_WINDOW_SIZE_Y + 10, 0}, STONE);
+
+  const auto [begin, end] = window.takeDirtyWords();
+  EXPECT_EQ(begin, end);
+  EXPECT_EQ(window.getBlock({0, VOXEL_WINDOW_SIZE_Y + 10, 0}), AIR);
+
+  window.setOrigin({0, VOXEL_WINDOW_SIZE_Y, 0});
+  EXPECT_EQ(window.getBlock({0, VOXEL_WINDOW_SIZE_Y + 10, 0}), STONE);
+}
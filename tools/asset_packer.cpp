@@ -0,0 +1,46 @@
+// Gathers assets into a pack that the game maps at startup instead of using the resources built
+// into the executable. Assets are named after their path relative to the root directory.
+//
+// Usage: plaxel_asset_packer <pack> <root directory> <asset>...
+
+#include "../src/assets/asset_pack.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+using namespace plaxel;
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0] << " <pack> <root directory> <asset>...\n";
+    return 1;
+  }
+
+  const std::filesystem::path root = argv[2];
+  std::vector<AssetPackEntry> entries;
+  for (int i = 3; i < argc; ++i) {
+    std::ifstream file(argv[i], std::ios::binary);
+    if (!file) {
+      std::cerr << "failed to read " << argv[i] << "\n";
+      return 1;
+    }
+    entries.push_back({std::filesystem::relative(argv[i], root).generic_string(),
+                       {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()}});
+  }
+
+  try {
+    const std::vector<uint8_t> pack = writeAssetPack(std::move(entries));
+    std::ofstream out(argv[1], std::ios::binary);
+    out.write(reinterpret_cast<const char *>(pack.data()),
+              static_cast<std::streamsize>(pack.size()));
+    if (!out) {
+      std::cerr << "failed to write " << argv[1] << "\n";
+      return 1;
+    }
+  } catch (const AssetPackError &e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
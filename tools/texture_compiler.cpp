@@ -0,0 +1,219 @@
+// Converts a texture at build time into the KTX2 files embedded in the executable: a BC1
+// compressed one with its whole mip chain, and an uncompressed fallback with only its first level
+// for the devices that cannot sample BC1, whose mip levels are generated at runtime.
+//
+// Usage: plaxel_texture_compiler <image> <compressed.ktx2> <uncompressed.ktx2>
+
+#include "../src/renderer/ktx2.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace plaxel;
+
+namespace {
+
+struct Image {
+  uint32_t width;
+  uint32_t height;
+  // RGBA, 8 bits per channel, sRGB encoded
+  std::vector<uint8_t> pixels;
+
+  [[nodiscard]] const uint8_t *pixel(uint32_t x, uint32_t y) const {
+    return &pixels[(static_cast<size_t>(std::min(y, height - 1)) * width + std::min(x, width - 1)) *
+                   4];
+  }
+};
+
+float toLinear(uint8_t value) {
+  const float v = static_cast<float>(value) / 255.f;
+  return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+uint8_t toSrgb(float value) {
+  const float v =
+      value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1 / 2.4f) - 0.055f;
+  return static_cast<uint8_t>(std::clamp(v * 255.f + .5f, 0.f, 255.f));
+}
+
+/**
+ * Next mip level, averaging 2x2 pixels in linear space so that it does not darken
+ */
+Image downsample(const Image &image) {
+  Image next{std::max(image.width / 2, 1u), std::max(image.height / 2, 1u), {}};
+  next.pixels.resize(static_cast<size_t>(next.width) * next.height * 4);
+  for (uint32_t y = 0; y < next.height; ++y) {
+    for (uint32_t x = 0; x < next.width; ++x) {
+      for (int channel = 0; channel < 4; ++channel) {
+        float sum = 0;
+        for (const auto &[dx, dy] : {std::pair{0u, 0u}, {1u, 0u}, {0u, 1u}, {1u, 1u}}) {
+          const uint8_t value = image.pixel(x * 2 + dx, y * 2 + dy)[channel];
+          // Alpha is stored linearly
+          sum += channel == 3 ? static_cast<float>(value) / 255.f : toLinear(value);
+        }
+        const float average = sum / 4;
+        next.pixels[(static_cast<size_t>(y) * next.width + x) * 4 + channel] =
+            channel == 3 ? static_cast<uint8_t>(average * 255.f + .5f) : toSrgb(average);
+      }
+    }
+  }
+  return next;
+}
+
+uint16_t toRgb565(const std::array<int, 3> &color) {
+  return static_cast<uint16_t>((color[0] >> 3) << 11 | (color[1] >> 2) << 5 | color[2] >> 3);
+}
+
+std::array<int, 3> fromRgb565(uint16_t color) {
+  const int r = color >> 11 & 0x1F;
+  const int g = color >> 5 & 0x3F;
+  const int b = color & 0x1F;
+  return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+}
+
+/**
+ * BC1 block from 4x4 pixels, with endpoints on the slightly inset bounding box of their colors,
+ * along the diagonal that follows how the channels vary together
+ */
+void encodeBlock(const Image &image, uint32_t blockX, uint32_t blockY, std::vector<uint8_t> &out) {
+  std::array<std::array<int, 3>, 16> colors{};
+  std::array<int, 3> low{255, 255, 255};
+  std::array<int, 3> high{0, 0, 0};
+  std::array<int, 3> mean{};
+  for (uint32_t i = 0; i < 16; ++i) {
+    const uint8_t *pixel = image.pixel(blockX * 4 + i % 4, blockY * 4 + i / 4);
+    for (int channel = 0; channel < 3; ++channel) {
+      colors[i][channel] = pixel[channel];
+      low[channel] = std::min(low[channel], colors[i][channel]);
+      high[channel] = std::max(high[channel], colors[i][channel]);
+      mean[channel] += colors[i][channel];
+    }
+  }
+  for (int channel = 0; channel < 3; ++channel) {
+    mean[channel] /= 16;
+    const int inset = (high[channel] - low[channel]) / 16;
+    low[channel] += inset;
+    high[channel] -= inset;
+  }
+  // Red and blue going down while green goes up use the other diagonal of the box
+  for (const int channel : {0, 2}) {
+    int covariance = 0;
+    for (const auto &color : colors) {
+      covariance += (color[channel] - mean[channel]) * (color[1] - mean[1]);
+    }
+    if (covariance < 0) {
+      std::swap(low[channel], high[channel]);
+    }
+  }
+
+  uint16_t color0 = toRgb565(high);
+  uint16_t color1 = toRgb565(low);
+  if (color0 < color1) {
+    std::swap(color0, color1);
+  }
+  // color0 > color1 selects the 4 color mode, equal endpoints only need the first index
+  const std::array<int, 3> end0 = fromRgb565(color0);
+  const std::array<int, 3> end1 = fromRgb565(color1);
+  std::array<std::array<int, 3>, 4> palette{end0, end1};
+  for (int channel = 0; channel < 3; ++channel) {
+    palette[2][channel] = (2 * end0[channel] + end1[channel]) / 3;
+    palette[3][channel] = (end0[channel] + 2 * end1[channel]) / 3;
+  }
+
+  uint32_t indices = 0;
+  if (color0 != color1) {
+    for (uint32_t i = 0; i < 16; ++i) {
+      int best = 0;
+      int bestDistance = INT32_MAX;
+      for (int entry = 0; entry < 4; ++entry) {
+        int distance = 0;
+        for (int channel = 0; channel < 3; ++channel) {
+          const int delta = colors[i][channel] - palette[entry][channel];
+          distance += delta * delta;
+        }
+        if (distance < bestDistance) {
+          best = entry;
+          bestDistance = distance;
+        }
+      }
+      indices |= static_cast<uint32_t>(best) << (2 * i);
+    }
+  }
+
+  for (const uint32_t word : {static_cast<uint32_t>(color0 | color1 << 16), indices}) {
+    for (int i = 0; i < 4; ++i) {
+      out.push_back(static_cast<uint8_t>(word >> (8 * i)));
+    }
+  }
+}
+
+std::vector<uint8_t> encodeBc1(const Image &image) {
+  std::vector<uint8_t> blocks;
+  for (uint32_t y = 0; y < (image.height + 3) / 4; ++y) {
+    for (uint32_t x = 0; x < (image.width + 3) / 4; ++x) {
+      encodeBlock(image, x, y, blocks);
+    }
+  }
+  return blocks;
+}
+
+void writeFile(const char *path, const std::vector<uint8_t> &content) {
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(content.data()),
+             static_cast<std::streamsize>(content.size()));
+  if (!file) {
+    throw std::runtime_error(std::string("failed to write ") + path);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 4) {
+    std::cerr << "usage: " << argv[0] << " <image> <compressed.ktx2> <uncompressed.ktx2>\n";
+    return 1;
+  }
+
+  int width;
+  int height;
+  int channels;
+  stbi_uc *pixels = stbi_load(argv[1], &width, &height, &channels, STBI_rgb_alpha);
+  if (!pixels) {
+    std::cerr << "failed to load " << argv[1] << "\n";
+    return 1;
+  }
+  Image image{static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+              std::vector<uint8_t>(pixels, pixels + static_cast<size_t>(width) * height * 4)};
+  stbi_image_free(pixels);
+
+  try {
+    writeFile(argv[3], writeKtx2(KTX2_FORMAT_R8G8B8A8_SRGB, image.width, image.height,
+                                 {image.pixels}));
+
+    std::vector<std::vector<uint8_t>> levels;
+    Image level = image;
+    while (true) {
+      levels.push_back(encodeBc1(level));
+      if (level.width == 1 && level.height == 1) {
+        break;
+      }
+      level = downsample(level);
+    }
+    writeFile(argv[2],
+              writeKtx2(KTX2_FORMAT_BC1_RGB_SRGB_BLOCK, image.width, image.height, levels));
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}